@@ -11,10 +11,16 @@ layout(set = 0, binding = 0) uniform global_uniform
 	mat4 view;
 } global_ubo;
 
-layout(push_constant) uniform u_push_constants
+struct instance_data
 {
 	mat4 model;
-} push_constants;
+};
+
+// The per instance data of every drawn instance, indexed by the instance index.
+layout(std430, set = 0, binding = 1) readonly buffer instance_buffer
+{
+	instance_data instances[];
+} instance_sb;
 
 layout(location = 0) out struct dto
 {
@@ -23,7 +29,9 @@ layout(location = 0) out struct dto
 
 void main()
 {
-	gl_Position = global_ubo.projection * global_ubo.view * push_constants.model * vec4(in_position, 1.0);
+	mat4 model = instance_sb.instances[gl_InstanceIndex].model;
+
+	gl_Position = global_ubo.projection * global_ubo.view * model * vec4(in_position, 1.0);
 
 	out_dto.tex_coord = in_tex_coord;
 }
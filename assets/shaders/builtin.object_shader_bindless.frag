@@ -0,0 +1,24 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// Every loaded texture, indexed by its bindless index.
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in struct dto
+{
+	vec2 tex_coord;
+	vec4 diffuse_color;
+} in_dto;
+
+layout(location = 2) flat in uint in_diffuse_texture;
+
+layout(location = 0) out vec4 out_colour;
+
+void main()
+{
+	// Indirect draws mix instances with different textures, so the index is not uniform.
+	vec4 diffuse = texture(textures[nonuniformEXT(in_diffuse_texture)], in_dto.tex_coord);
+
+	out_colour = in_dto.diffuse_color * diffuse;
+}
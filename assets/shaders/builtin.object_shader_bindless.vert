@@ -0,0 +1,45 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_tex_coord;
+layout(location = 2) in vec3 in_normal;
+
+layout(set = 0, binding = 0) uniform global_uniform
+{
+	mat4 projection;
+	mat4 view;
+} global_ubo;
+
+// The per instance uniforms, followed by the instance uniforms and the bindless indices of the instance samplers.
+struct instance_data
+{
+	mat4 model;
+	vec4 diffuse_color;
+	uint diffuse_texture;
+};
+
+// The per instance data of every drawn instance, indexed by the instance index.
+layout(std430, set = 0, binding = 1) readonly buffer instance_buffer
+{
+	instance_data instances[];
+} instance_sb;
+
+layout(location = 0) out struct dto
+{
+	vec2 tex_coord;
+	vec4 diffuse_color;
+} out_dto;
+
+layout(location = 2) flat out uint out_diffuse_texture;
+
+void main()
+{
+	instance_data instance = instance_sb.instances[gl_InstanceIndex];
+
+	gl_Position = global_ubo.projection * global_ubo.view * instance.model * vec4(in_position, 1.0);
+
+	out_dto.tex_coord = in_tex_coord;
+	out_dto.diffuse_color = instance.diffuse_color;
+	out_diffuse_texture = instance.diffuse_texture;
+}
@@ -1,5 +1,9 @@
 glslc builtin.object_shader.frag -o builtin.object_shader.frag.spv
 glslc builtin.object_shader.vert -o builtin.object_shader.vert.spv
+glslc builtin.object_shader_bindless.frag -o builtin.object_shader_bindless.frag.spv
+glslc builtin.object_shader_bindless.vert -o builtin.object_shader_bindless.vert.spv
 
 glslc builtin.ui_shader.frag -o builtin.ui_shader.frag.spv
 glslc builtin.ui_shader.vert -o builtin.ui_shader.vert.spv
+
+glslc builtin.cull.comp -o builtin.cull.comp.spv
@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <simple-logger.hpp>
+
+#include <core/engine.hpp>
+#include <core/event.hpp>
+#include <core/profiler.hpp>
+#include <math/mat4x4.hpp>
+#include <renderer/vulkan_backend.hpp>
+
+/**
+ * @brief The results of benchmarking a single scene.
+ */
+struct SceneResult
+{
+	uint32_t instance_count;
+
+	double setup_ms;
+
+	double min_ms;
+	double median_ms;
+	double p99_ms;
+	double mean_ms;
+
+	// Mean GPU times, 0 if the device does not support timestamps.
+	double gpu_frame_ms;
+	double gpu_world_pass_ms;
+	double gpu_ui_pass_ms;
+
+	uint32_t draw_calls;
+	uint32_t static_draw_calls;
+	uint32_t pipeline_binds;
+	uint32_t descriptor_set_binds;
+	uint32_t buffer_binds;
+	uint32_t culled_meshes;
+	uint32_t frame_count;
+
+	// Device memory allocator state at the end of the scene.
+	uint32_t memory_block_count;
+	uint32_t memory_allocation_count;
+	uint64_t memory_reserved_bytes;
+	uint64_t memory_used_bytes;
+	float memory_fragmentation;
+};
+
+struct BenchState
+{
+	std::vector<uint32_t> scene_sizes = { 1, 100, 1000, 10000, 100000 };
+
+	uint32_t warmup_frames = 10;
+	uint32_t measured_frames = 200;
+
+	const char* output_path = nullptr;
+	const char* trace_path = nullptr;
+
+	// Whether the scene instances are static models.
+	bool is_static = false;
+
+	// Prototype models every scene instance gets cloned from.
+	std::vector<lise::Model*> prototypes;
+
+	double load_ms;
+
+	// Current scene.
+	size_t scene_index = 0;
+	std::vector<lise::Model*> instances;
+	double setup_ms;
+	uint32_t frames_in_scene;
+	std::vector<double> frame_times;
+	double gpu_frame_ms_sum;
+	double gpu_world_pass_ms_sum;
+	double gpu_ui_pass_ms_sum;
+	uint32_t draw_calls;
+	uint32_t static_draw_calls;
+	uint32_t pipeline_binds;
+	uint32_t descriptor_set_binds;
+	uint32_t buffer_binds;
+	uint32_t culled_meshes;
+
+	std::vector<SceneResult> results;
+
+	bool is_done = false;
+};
+
+static BenchState bench;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void build_scene(uint32_t instance_count)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	// Lay the instances out in a square grid on the xz-plane, alternating between the prototypes.
+	uint32_t side = (uint32_t) std::ceil(std::sqrt((double) instance_count));
+	const float spacing = 4.0f;
+
+	bench.instances.reserve(instance_count);
+
+	for (uint32_t i = 0; i < instance_count; i++)
+	{
+		lise::Model* instance = lise::vulkan_clone_model(bench.prototypes[i % bench.prototypes.size()]);
+
+		float x = ((float) (i % side) - side * 0.5f) * spacing;
+		float z = -((float) (i / side)) * spacing - 10.0f;
+
+		instance->is_visible = true;
+		instance->transform.set_position(x, 0.0f, z);
+
+		if (bench.is_static)
+		{
+			lise::vulkan_set_model_static(instance, true);
+		}
+
+		bench.instances.push_back(instance);
+	}
+
+	bench.setup_ms = elapsed_ms(start);
+	bench.frames_in_scene = 0;
+	bench.frame_times.clear();
+	bench.frame_times.reserve(bench.measured_frames);
+	bench.gpu_frame_ms_sum = 0.0;
+	bench.gpu_world_pass_ms_sum = 0.0;
+	bench.gpu_ui_pass_ms_sum = 0.0;
+}
+
+static void destroy_scene()
+{
+	for (lise::Model* instance : bench.instances)
+	{
+		lise::vulkan_destroy_model(instance);
+	}
+
+	bench.instances.clear();
+}
+
+static SceneResult finish_scene()
+{
+	SceneResult result = {};
+	result.instance_count = bench.instances.size();
+	result.setup_ms = bench.setup_ms;
+	result.draw_calls = bench.draw_calls;
+	result.static_draw_calls = bench.static_draw_calls;
+	result.pipeline_binds = bench.pipeline_binds;
+	result.descriptor_set_binds = bench.descriptor_set_binds;
+	result.buffer_binds = bench.buffer_binds;
+	result.culled_meshes = bench.culled_meshes;
+	result.frame_count = bench.frame_times.size();
+
+	lise::MemoryAllocatorStats memory_stats = lise::vulkan_get_memory_stats();
+
+	result.memory_block_count = memory_stats.block_count;
+	result.memory_allocation_count = memory_stats.allocation_count;
+	result.memory_reserved_bytes = memory_stats.reserved_bytes;
+	result.memory_used_bytes = memory_stats.used_bytes;
+	result.memory_fragmentation = memory_stats.fragmentation;
+
+	std::vector<double> sorted = bench.frame_times;
+	std::sort(sorted.begin(), sorted.end());
+
+	if (!sorted.empty())
+	{
+		size_t p99_index = (size_t) std::ceil(0.99 * sorted.size()) - 1;
+
+		result.min_ms = sorted.front();
+		result.median_ms = sorted[sorted.size() / 2];
+		result.p99_ms = sorted[std::min(p99_index, sorted.size() - 1)];
+
+		double sum = 0.0;
+		for (double t : sorted)
+		{
+			sum += t;
+		}
+
+		result.mean_ms = sum / sorted.size();
+
+		result.gpu_frame_ms = bench.gpu_frame_ms_sum / sorted.size();
+		result.gpu_world_pass_ms = bench.gpu_world_pass_ms_sum / sorted.size();
+		result.gpu_ui_pass_ms = bench.gpu_ui_pass_ms_sum / sorted.size();
+	}
+
+	return result;
+}
+
+bool bench_initialize()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	const char* paths[] = {
+		"assets/models/obj/car.obj",
+		"assets/models/obj/test_cube.obj"
+	};
+
+	for (const char* path : paths)
+	{
+		std::optional<lise::Obj> obj = lise::Obj::load(path);
+
+		if (!obj)
+		{
+			sl::log_fatal("Failed to load benchmark model `{}`.", path);
+			return false;
+		}
+
+		lise::Model* prototype = lise::vulkan_create_model(*obj);
+
+		if (!prototype)
+		{
+			sl::log_fatal("Failed to create benchmark model `{}`.", path);
+			return false;
+		}
+
+		// Prototypes only exist to be cloned.
+		prototype->is_visible = false;
+
+		bench.prototypes.push_back(prototype);
+	}
+
+	bench.load_ms = elapsed_ms(start);
+
+	// Look at the grid from above and behind.
+	lise::mat4x4 view = lise::mat4x4::translation(lise::vector3f { 0.0f, 20.0f, 30.0f });
+	lise::vulkan_set_view_matrix_temp(view.inversed());
+
+	build_scene(bench.scene_sizes[0]);
+
+	return true;
+}
+
+bool bench_update(float delta_time)
+{
+	if (bench.is_done)
+	{
+		return true;
+	}
+
+	// The delta time is the duration of the previous frame, so the first frame of a scene also contains the scene
+	// setup. The warmup frames take care of skipping it.
+	if (bench.frames_in_scene >= bench.warmup_frames)
+	{
+		lise::FrameStats stats = lise::vulkan_get_frame_stats();
+
+		bench.frame_times.push_back(delta_time * 1000.0);
+		bench.draw_calls = stats.draw_calls;
+		bench.static_draw_calls = stats.static_draw_calls;
+		bench.pipeline_binds = stats.pipeline_binds;
+		bench.descriptor_set_binds = stats.descriptor_set_binds;
+		bench.buffer_binds = stats.buffer_binds;
+		bench.culled_meshes = stats.culled_meshes;
+
+		bench.gpu_frame_ms_sum += stats.gpu_frame_ms;
+		bench.gpu_world_pass_ms_sum += stats.gpu_world_pass_ms;
+		bench.gpu_ui_pass_ms_sum += stats.gpu_ui_pass_ms;
+	}
+
+	bench.frames_in_scene++;
+
+	if (bench.frame_times.size() < bench.measured_frames)
+	{
+		return true;
+	}
+
+	bench.results.push_back(finish_scene());
+
+	destroy_scene();
+
+	bench.scene_index++;
+
+	if (bench.scene_index < bench.scene_sizes.size())
+	{
+		build_scene(bench.scene_sizes[bench.scene_index]);
+	}
+	else
+	{
+		bench.is_done = true;
+
+		lise::event_fire(lise::EventCodes::ON_WINDOW_CLOSE, lise::event_context {});
+	}
+
+	return true;
+}
+
+bool bench_render(float delta_time)
+{
+	return true;
+}
+
+void bench_on_resize(uint32_t width, uint32_t height)
+{
+}
+
+static void write_results(FILE* out)
+{
+	std::fprintf(out, "{\n");
+	std::fprintf(out, "\t\"load_ms\": %.4f,\n", bench.load_ms);
+	std::fprintf(out, "\t\"warmup_frames\": %u,\n", bench.warmup_frames);
+	std::fprintf(out, "\t\"measured_frames\": %u,\n", bench.measured_frames);
+	std::fprintf(out, "\t\"scenes\": [\n");
+
+	for (size_t i = 0; i < bench.results.size(); i++)
+	{
+		const SceneResult& r = bench.results[i];
+
+		std::fprintf(
+			out,
+			"\t\t{ \"instances\": %u, \"setup_ms\": %.4f, \"frames\": %u, \"draw_calls\": %u, "
+			"\"static_draw_calls\": %u, \"pipeline_binds\": %u, \"descriptor_set_binds\": %u, \"buffer_binds\": %u, \"culled_meshes\": %u, "
+			"\"min_ms\": %.4f, \"median_ms\": %.4f, \"p99_ms\": %.4f, \"mean_ms\": %.4f, "
+			"\"gpu_frame_ms\": %.4f, \"gpu_world_pass_ms\": %.4f, \"gpu_ui_pass_ms\": %.4f, "
+			"\"memory_blocks\": %u, \"memory_allocations\": %u, \"memory_reserved_bytes\": %llu, "
+			"\"memory_used_bytes\": %llu, \"memory_fragmentation\": %.4f }%s\n",
+			r.instance_count,
+			r.setup_ms,
+			r.frame_count,
+			r.draw_calls,
+			r.static_draw_calls,
+			r.pipeline_binds,
+			r.descriptor_set_binds,
+			r.buffer_binds,
+			r.culled_meshes,
+			r.min_ms,
+			r.median_ms,
+			r.p99_ms,
+			r.mean_ms,
+			r.gpu_frame_ms,
+			r.gpu_world_pass_ms,
+			r.gpu_ui_pass_ms,
+			r.memory_block_count,
+			r.memory_allocation_count,
+			(unsigned long long) r.memory_reserved_bytes,
+			(unsigned long long) r.memory_used_bytes,
+			r.memory_fragmentation,
+			i + 1 < bench.results.size() ? "," : ""
+		);
+	}
+
+	std::fprintf(out, "\t]\n");
+	std::fprintf(out, "}\n");
+}
+
+static std::vector<uint32_t> parse_scene_sizes(const char* list)
+{
+	std::vector<uint32_t> sizes;
+
+	const char* c = list;
+	while (*c)
+	{
+		char* end;
+		uint32_t size = std::strtoul(c, &end, 10);
+
+		if (end == c)
+		{
+			break;
+		}
+
+		if (size > 0)
+		{
+			sizes.push_back(size);
+		}
+
+		c = *end == ',' ? end + 1 : end;
+	}
+
+	return sizes;
+}
+
+static void print_usage()
+{
+	std::printf(
+		"Usage: lise_bench [--frames N] [--warmup N] [--scenes 1,100,1000] [--output results.json] [--trace trace.json] "
+		"[--static]\n"
+	);
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		bool has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--frames") == 0 && has_value)
+		{
+			bench.measured_frames = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--warmup") == 0 && has_value)
+		{
+			bench.warmup_frames = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--scenes") == 0 && has_value)
+		{
+			bench.scene_sizes = parse_scene_sizes(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+		{
+			bench.output_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && has_value)
+		{
+			bench.trace_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--static") == 0)
+		{
+			bench.is_static = true;
+		}
+		else
+		{
+			print_usage();
+			return -1;
+		}
+	}
+
+	if (bench.scene_sizes.empty() || bench.measured_frames == 0)
+	{
+		print_usage();
+		return -1;
+	}
+
+#ifndef L_ENABLE_PROFILER
+	if (bench.trace_path)
+	{
+		sl::log_warn("The engine was built without LISE_ENABLE_PROFILER, the trace will be empty.");
+	}
+#endif
+
+	auto engine_create_info = lise::EngineCreateInfo {};
+	engine_create_info.window_width = 1280;
+	engine_create_info.window_height = 720;
+	engine_create_info.window_name = "LiSE Benchmark";
+	engine_create_info.headless = true;
+	engine_create_info.entry_points.update = bench_update;
+	engine_create_info.entry_points.render = bench_render;
+	engine_create_info.entry_points.initialize = bench_initialize;
+	engine_create_info.entry_points.on_window_resize = bench_on_resize;
+
+	if (!lise::engine_create(engine_create_info))
+	{
+		sl::log_fatal("Could not create engine.");
+		return -1;
+	}
+
+	if (!lise::engine_run())
+	{
+		sl::log_fatal("Application did not shut down engine.");
+		return -1;
+	}
+
+	if (!bench.is_done)
+	{
+		sl::log_fatal("The engine stopped before every scene was measured.");
+		return -1;
+	}
+
+	FILE* out = stdout;
+
+	if (bench.output_path)
+	{
+		out = std::fopen(bench.output_path, "w");
+
+		if (!out)
+		{
+			sl::log_fatal("Failed to open output file `{}`.", bench.output_path);
+			return -1;
+		}
+	}
+
+	write_results(out);
+
+	if (bench.trace_path && !lise::profiler_write_chrome_trace(bench.trace_path))
+	{
+		return -1;
+	}
+
+	if (out != stdout)
+	{
+		std::fclose(out);
+	}
+
+	return 0;
+}
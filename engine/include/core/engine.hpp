@@ -75,6 +75,26 @@ struct EngineCreateInfo
 	 * Do not deallocate this allocation ever, as it is used during the entire lifetime of the engine.
 	 */
 	const char* window_name;
+
+	/**
+	 * @brief Runs the engine without a window. The platform layer is never initialized, and the render passes render
+	 * into offscreen images instead of a swapchain.
+	 * 
+	 * The \ref window_width and \ref window_height members are used as the size of the offscreen images.
+	 */
+	bool headless;
+
+	/**
+	 * @brief The amount of frames to render before the engine shuts itself down when running headless. A value of 0
+	 * means that there is no frame limit.
+	 */
+	uint32_t headless_frame_count;
+
+	/**
+	 * @brief The amount of seconds to run before the engine shuts itself down when running headless. A value of 0
+	 * means that there is no time limit.
+	 */
+	double headless_duration;
 	
 	/**
 	 * @brief A \ref lise_game_engine_entry_points object containing all the "entry_points" or callbacks of the
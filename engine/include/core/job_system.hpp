@@ -0,0 +1,60 @@
+/**
+ * @file job_system.hpp
+ * @brief This header file contains the job system, a pool of worker threads that runs jobs in parallel.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "definitions.hpp"
+
+/**
+ * @brief The maximum amount of threads that run jobs, including the thread that starts them.
+ */
+#define LJOB_SYSTEM_MAX_THREADS 16
+
+namespace lise
+{
+
+/**
+ * @brief Starts the worker threads of the job system.
+ *
+ * @param worker_count The amount of worker threads. A value of 0 creates one per hardware thread, except for the
+ * calling thread.
+ *
+ * @return true if the initialization was successfull.
+ * @return false if there was an error during initialization.
+ */
+bool job_system_init(uint32_t worker_count = 0);
+
+/**
+ * @brief Waits for the worker threads to finish their current jobs, and stops them.
+ */
+void job_system_shutdown();
+
+/**
+ * @brief Gets the amount of threads that run jobs, which is the amount of worker threads plus the calling thread.
+ */
+uint32_t job_system_get_thread_count();
+
+/**
+ * @brief Runs a job for every index in [0, job_count), spread over the worker threads and the calling thread. Returns
+ * once every job has finished. Jobs of a single call can run in any order and on any thread, but every job runs on
+ * a single thread only.
+ *
+ * Runs all jobs on the calling thread if the job system has not been initialized.
+ */
+void job_system_run(uint32_t job_count, const std::function<void(uint32_t job_index)>& job);
+
+/**
+ * @brief Queues a long running job, such as decoding a file, and returns without waiting for it. Background jobs only
+ * run on the worker threads, once no jobs started by \ref job_system_run are waiting, so they never hold up the
+ * calling thread of \ref job_system_run.
+ *
+ * Background jobs that have not started when the job system shuts down are dropped. Runs the job on the calling thread
+ * if there are no worker threads.
+ */
+void job_system_submit(std::function<void()> job);
+
+}
@@ -0,0 +1,110 @@
+/**
+ * @file profiler.hpp
+ * @brief This header file contains the scoped CPU profiler and its trace export.
+ *
+ * Zones are recorded into a ring buffer per thread, so recording never takes a lock. The profiler is compiled out
+ * unless `L_ENABLE_PROFILER` is defined (see the `LISE_ENABLE_PROFILER` CMake option); the \ref LPROFILE_SCOPE and
+ * \ref LPROFILE_FUNCTION macros then expand to nothing, and the functions that record zones or name threads do
+ * nothing.
+ */
+#pragma once
+
+#include <string>
+
+#include "definitions.hpp"
+
+/**
+ * @brief The amount of zones every thread keeps before the oldest zones get overwritten.
+ */
+#define LPROFILER_RING_CAPACITY 65536
+
+#define LPROFILE_CONCAT_INNER(a, b) a##b
+#define LPROFILE_CONCAT(a, b) LPROFILE_CONCAT_INNER(a, b)
+
+#ifdef L_ENABLE_PROFILER
+	/**
+	 * @brief Records a zone spanning from this line until the end of the enclosing scope. The name has to be a string
+	 * literal or otherwise outlive the profiler.
+	 */
+	#define LPROFILE_SCOPE(name) ::lise::ProfileScope LPROFILE_CONCAT(lprofile_scope_, __LINE__)(name)
+
+	/**
+	 * @brief Records a zone spanning the enclosing function.
+	 */
+	#define LPROFILE_FUNCTION() LPROFILE_SCOPE(__func__)
+#else
+	#define LPROFILE_SCOPE(name)
+	#define LPROFILE_FUNCTION()
+#endif
+
+namespace lise
+{
+
+/**
+ * @brief Gets the current time of the profiler clock.
+ *
+ * @return uint64_t The time in nanoseconds. The time is arbitrary and only meaningful when compared to other times
+ * of the same clock.
+ */
+LAPI uint64_t profiler_get_time_ns();
+
+/**
+ * @brief Records a finished zone into the ring buffer of the calling thread.
+ *
+ * @param name The name of the zone. The string is not copied.
+ * @param start_ns The start time of the zone, as returned by \ref profiler_get_time_ns.
+ * @param end_ns The end time of the zone, as returned by \ref profiler_get_time_ns.
+ */
+LAPI void profiler_record_zone(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+/**
+ * @brief Records a finished zone on the virtual GPU track. Only the render thread may call this function.
+ *
+ * @param name The name of the zone. The string is not copied.
+ * @param start_ns The start time of the zone, translated to the profiler clock.
+ * @param end_ns The end time of the zone, translated to the profiler clock.
+ */
+LAPI void profiler_record_gpu_zone(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+/**
+ * @brief Sets the name of the calling thread as displayed in the exported trace.
+ */
+LAPI void profiler_set_thread_name(const std::string& name);
+
+/**
+ * @brief Discards all recorded zones of all threads.
+ */
+LAPI void profiler_reset();
+
+/**
+ * @brief Writes all recorded zones to a file in the Chrome trace event format. The file can be opened in
+ * `chrome://tracing` and in Perfetto.
+ *
+ * @param path The path of the trace file. Can be relative or absolute.
+ * @return true if the trace was written successfully.
+ * @return false if the file could not be written.
+ */
+LAPI bool profiler_write_chrome_trace(const std::string& path);
+
+/**
+ * @brief Records a zone from its construction until its destruction. Use \ref LPROFILE_SCOPE instead of using this
+ * structure directly, so the zone can be compiled out.
+ */
+struct ProfileScope
+{
+	const char* name;
+	uint64_t start_ns;
+
+	explicit ProfileScope(const char* name) : name(name), start_ns(profiler_get_time_ns()) {}
+
+	ProfileScope(const ProfileScope&) = delete; // Prevent copies.
+
+	~ProfileScope()
+	{
+		profiler_record_zone(name, start_ns, profiler_get_time_ns());
+	}
+
+	ProfileScope& operator = (const ProfileScope&) = delete; // Prevent copies.
+};
+
+}
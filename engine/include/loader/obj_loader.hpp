@@ -146,7 +146,7 @@ struct Obj
 	 * @param path The path to the obj file. Can be relative or absolute.
 	 * @return The loaded obj.
 	 */
-	static std::optional<Obj> load(const std::string& path);
+	LAPI static std::optional<Obj> load(const std::string& path);
 	
 	/**
 	 * @brief An array of meshes.
@@ -94,6 +94,12 @@ struct ShaderConfig
 	 * The allocation is owned by the \ref lise_shader_config object.
 	 */
 	std::vector<ShaderConfigUniform> uniforms;
+
+	/**
+	 * @brief Whether the shader reads its instance uniforms and texture indices from the per instance data, and samples
+	 * the bindless texture table, instead of using a descriptor set per instance. Set by a `bindless` line.
+	 */
+	bool is_bindless;
 };
 
 /**
@@ -0,0 +1,57 @@
+/**
+ * @file texture_container_loader.hpp
+ * @brief This header file contains definitions of structures and functions relating to loading textures stored in
+ * KTX2 and DDS containers, which hold pre-compressed pixel data and all of its mip levels.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "definitions.hpp"
+#include "math/vector2.hpp"
+#include "renderer/device.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief The pixel data of a texture container.
+ */
+struct TextureContainer
+{
+	/**
+	 * @brief The format of the pixel data. Always one of the formats \ref texture_format_is_known accepts.
+	 */
+	vk::Format format;
+
+	/**
+	 * @brief The size of the largest mip level in pixels.
+	 */
+	vector2ui size;
+
+	uint32_t mip_levels;
+
+	/**
+	 * @brief The tightly packed mip levels, starting with the largest.
+	 */
+	std::vector<uint8_t> data;
+};
+
+/**
+ * @brief Checks whether a path has the extension of a texture container: `.ktx2` or `.dds`.
+ */
+bool texture_container_is_container_path(const std::string& path);
+
+/**
+ * @brief Attempts to load a KTX2 or DDS file. Only single, two dimensional images are supported. KTX2 files can not
+ * be supercompressed.
+ *
+ * @param path The path to the file. Can be relative or absolute.
+ * @param out_container [out] A reference to where to load the pixel data to.
+ * @return true if the file was successfully loaded and parsed.
+ * @return false if there was an error loading or parsing the file, or if its format is not supported.
+ */
+bool texture_container_load(const std::string& path, TextureContainer& out_container);
+
+}
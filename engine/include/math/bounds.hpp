@@ -0,0 +1,51 @@
+/**
+ * @file bounds.hpp
+ * @brief This header file contains the bounding volumes used for visibility tests.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "definitions.hpp"
+#include "math/mat4x4.hpp"
+#include "math/vector3.hpp"
+#include "math/vertex.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief An axis aligned bounding box.
+ */
+struct AABB
+{
+	vector3f min;
+	vector3f max;
+
+	/**
+	 * @brief Computes the smallest box containing the positions of the vertices. An empty array results in a box
+	 * around the origin with no volume.
+	 */
+	LAPI static AABB from_vertices(const vertex* vertices, size_t count);
+};
+
+struct BoundingSphere
+{
+	vector3f center;
+	float radius;
+
+	/**
+	 * @brief Computes a sphere around the center of an AABB which contains the positions of the vertices.
+	 *
+	 * @param bounds The bounding box of the same vertices.
+	 */
+	LAPI static BoundingSphere from_vertices(const vertex* vertices, size_t count, const AABB& bounds);
+
+	/**
+	 * @brief Transforms the sphere by a model matrix. The radius is scaled by the largest scale of the matrix, so the
+	 * resulting sphere contains the transformed vertices.
+	 */
+	LAPI BoundingSphere transformed(const mat4x4& model) const;
+};
+
+}
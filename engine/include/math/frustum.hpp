@@ -0,0 +1,61 @@
+/**
+ * @file frustum.hpp
+ * @brief This header file contains the view frustum, and the visibility tests of bounding volumes against it.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "definitions.hpp"
+#include "math/bounds.hpp"
+#include "math/mat4x4.hpp"
+#include "math/vector4.hpp"
+
+namespace lise
+{
+
+struct Frustum
+{
+	/**
+	 * @brief The left, right, bottom, top, near and far planes. The normals (xyz) are normalized and point inwards, a
+	 * point p lies inside a plane if dot(normal, p) + w >= 0.
+	 */
+	vector4f planes[6];
+
+	/**
+	 * @brief Extracts the planes of the frustum from a view projection matrix. The resulting planes are in the space
+	 * the matrix transforms from, world space for a view projection matrix.
+	 *
+	 * @param view_projection The matrix that transforms into clip space, `view * projection` in the multiplication
+	 * order of \ref mat4x4 (projection * view in GLSL).
+	 */
+	LAPI static Frustum from_matrix(const mat4x4& view_projection);
+
+	LAPI bool intersects(const BoundingSphere& sphere) const;
+
+	LAPI bool intersects(const AABB& box) const;
+};
+
+/**
+ * @brief Tests a batch of bounding spheres against a frustum. The spheres are passed as a structure of arrays, so
+ * multiple spheres are tested at once using SSE, or AVX when the engine is compiled with it.
+ *
+ * @param frustum The frustum to test against.
+ * @param x, y, z, radius The centers and radii of the spheres. Each array holds count elements.
+ * @param count The amount of spheres.
+ * @param out_visible An array of count elements, set to 1 for the spheres that intersect the frustum and 0 for the
+ * spheres that are fully outside.
+ *
+ * @return uint32_t The amount of spheres that intersect the frustum.
+ */
+LAPI uint32_t frustum_cull_spheres(
+	const Frustum& frustum,
+	const float* x,
+	const float* y,
+	const float* z,
+	const float* radius,
+	uint32_t count,
+	uint8_t* out_visible
+);
+
+}
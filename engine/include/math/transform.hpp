@@ -11,26 +11,26 @@ namespace lise
 class Transform
 {
 public:
-	Transform();
+	LAPI Transform();
 
-	void set_parent(Transform* new_parent);
+	LAPI void set_parent(Transform* new_parent);
 	
-	void add_child(Transform* new_child);
+	LAPI void add_child(Transform* new_child);
 
-	void set_scale(vector3f new_scale);
-	void set_scale(float new_x, float new_y, float new_z);
+	LAPI void set_scale(vector3f new_scale);
+	LAPI void set_scale(float new_x, float new_y, float new_z);
 
-	void set_rotation(vector3f new_rot);
-	void set_rotation(float new_x, float new_y, float new_z);
+	LAPI void set_rotation(vector3f new_rot);
+	LAPI void set_rotation(float new_x, float new_y, float new_z);
 
-	void set_position(vector3f new_pos);
-	void set_position(float new_x, float new_y, float new_z);
+	LAPI void set_position(vector3f new_pos);
+	LAPI void set_position(float new_x, float new_y, float new_z);
 
-	vector3f get_scale() const;
-	vector3f get_rotation() const;
-	vector3f get_position() const;
+	LAPI vector3f get_scale() const;
+	LAPI vector3f get_rotation() const;
+	LAPI vector3f get_position() const;
 
-	mat4x4 get_transformation_matrix() const;
+	LAPI mat4x4 get_transformation_matrix() const;
 
 private:
 	Transform* parent;
@@ -22,6 +22,8 @@ void platform_console_write_error(const char* message, uint8_t color);
 
 double platform_get_absolute_time();
 
+uint64_t platform_get_absolute_time_ns();
+
 void platform_sleep(uint64_t ms);
 
 std::vector<const char*> platform_get_required_instance_extensions();
@@ -0,0 +1,81 @@
+/**
+ * @file bindless_texture_table.hpp
+ * @brief This header file contains the bindless texture table, a single large descriptor array that every texture is
+ * registered into once, so shaders can select their textures using an index instead of a descriptor set per material.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "definitions.hpp"
+#include "renderer/device.hpp"
+
+/**
+ * @brief The amount of textures the table can hold. Clamped to the descriptor limits of the device.
+ */
+#define LBINDLESS_TEXTURE_TABLE_CAPACITY 4096
+
+namespace lise
+{
+
+/**
+ * @brief A descriptor set containing a partially bound array of combined image samplers. Textures get an index into the
+ * array when they are registered, which shaders read from their per instance data.
+ *
+ * The descriptors are updated after bind, so textures can be registered while command buffers using the set are being
+ * recorded or executed. Unused elements of the array are never read, so they do not have to be valid.
+ */
+struct BindlessTextureTable
+{
+	vk::DescriptorSetLayout descriptor_set_layout;
+	vk::DescriptorPool descriptor_pool;
+	vk::DescriptorSet descriptor_set;
+
+	/**
+	 * @brief The amount of elements in the array.
+	 */
+	uint32_t capacity;
+
+	/**
+	 * @brief The amount of elements that have been handed out at least once.
+	 */
+	uint32_t used_count;
+
+	/**
+	 * @brief Released elements, which are handed out again before any unused ones.
+	 */
+	std::vector<uint32_t> free_indices;
+
+	const Device* device;
+
+	BindlessTextureTable() = default;
+
+	BindlessTextureTable(const BindlessTextureTable&) = delete; // Prevent copies.
+
+	~BindlessTextureTable();
+
+	BindlessTextureTable& operator = (const BindlessTextureTable&) = delete; // Prevent copies.
+
+	/**
+	 * @brief Checks whether the device has the descriptor indexing features the table needs enabled.
+	 */
+	static bool is_supported(const Device* device);
+
+	static std::unique_ptr<BindlessTextureTable> create(const Device* device);
+
+	/**
+	 * @brief Writes a texture into a free element of the array.
+	 *
+	 * @return uint32_t The index of the element, or UINT32_MAX if the table is full.
+	 */
+	uint32_t register_texture(vk::ImageView image_view, vk::Sampler sampler);
+
+	/**
+	 * @brief Returns an element to the table. The element must not be read by any command buffer that is still being
+	 * executed, as it can be overwritten by the next registration.
+	 */
+	void release(uint32_t index);
+};
+
+}
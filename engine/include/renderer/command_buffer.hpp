@@ -51,7 +51,18 @@ struct CommandBuffer
 
 	void reset();
 
-	bool begin(bool is_single_use, bool is_render_pass_continue, bool is_simultaneous_use);
+	/**
+	 * @brief Begins recording.
+	 *
+	 * @param inheritance_info The render pass state inherited by a secondary command buffer. Required for secondary
+	 * command buffers, ignored by primary ones.
+	 */
+	bool begin(
+		bool is_single_use,
+		bool is_render_pass_continue,
+		bool is_simultaneous_use,
+		const vk::CommandBufferInheritanceInfo* inheritance_info = nullptr
+	);
 
 	bool end();
 
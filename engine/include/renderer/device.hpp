@@ -6,6 +6,13 @@
 #include <vulkan/vulkan.hpp>
 
 #include "definitions.hpp"
+#include "renderer/memory_allocator.hpp"
+#include "renderer/sampler_cache.hpp"
+
+/**
+ * @brief The file the pipeline cache is loaded from at startup, and written to at shutdown.
+ */
+#define LDEVICE_PIPELINE_CACHE_PATH "pipeline_cache.bin"
 
 namespace lise
 {
@@ -21,7 +28,8 @@ struct DeviceSwapChainSupportInfo
 
 /**
  * @brief A structure containing queue family indices. An index of UINT32_MAX (2^32 - 1) represents
- * an unavailable queue family.
+ * an unavailable queue family. The transfer queue family is a transfer-only family if the device has one, and the
+ * graphics queue family otherwise.
  */
 struct DeviceQueueIndices
 {
@@ -39,6 +47,24 @@ struct Device
 	vk::PhysicalDeviceFeatures physical_device_features;
 	vk::PhysicalDeviceMemoryProperties physical_device_memory_properties;
 
+	/**
+	 * @brief The optional features that are enabled on the logical device, the ones that are supported out of
+	 * multiDrawIndirect, drawIndirectFirstInstance, textureCompressionBC and textureCompressionETC2.
+	 */
+	vk::PhysicalDeviceFeatures enabled_features;
+
+	/**
+	 * @brief Whether the drawIndirectCount feature of Vulkan 1.2 is enabled, which vkCmdDrawIndexedIndirectCount
+	 * requires.
+	 */
+	bool is_draw_indirect_count_enabled;
+
+	/**
+	 * @brief Whether the descriptor indexing features of Vulkan 1.2 that bindless textures need are enabled: runtime
+	 * sized, partially bound and update after bind arrays of sampled images, indexed non uniformly.
+	 */
+	bool is_descriptor_indexing_enabled;
+
 	DeviceQueueIndices queue_indices;
 
 	vk::Device logical_device;
@@ -49,6 +75,27 @@ struct Device
 
 	vk::CommandPool graphics_command_pool;
 
+	/**
+	 * @brief A command pool for the transfer queue family. Only used by the upload system.
+	 */
+	vk::CommandPool transfer_command_pool;
+
+	/**
+	 * @brief The allocator all buffer and image memory of the device is taken from.
+	 */
+	std::unique_ptr<MemoryAllocator> allocator;
+
+	/**
+	 * @brief The cache all samplers of the device are taken from.
+	 */
+	std::unique_ptr<SamplerCache> sampler_cache;
+
+	/**
+	 * @brief The pipeline cache all pipelines are created with. Seeded from \ref LDEVICE_PIPELINE_CACHE_PATH if the
+	 * file was written by the same device and driver, so the driver does not have to compile the pipelines again.
+	 */
+	vk::PipelineCache pipeline_cache;
+
 	Device() = default;
 
 	Device(Device&) = delete; // Prevent copies.
@@ -57,6 +104,12 @@ struct Device
 
 	Device& operator = (Device&) = delete;
 
+	/**
+	 * @brief Creates the device.
+	 * 
+	 * @param surface The surface the device has to be able to present to. A null surface creates a headless device
+	 * that is only able to render offscreen.
+	 */
 	static std::unique_ptr<Device> create(
 		vk::Instance instance,
 		std::span<std::string> physical_device_extensions,
@@ -69,6 +122,18 @@ struct Device
 	 * 
 	 * @param surface The surface to be used with the swapchain.
 	 */
+	/**
+	 * @brief Whether transfers run on a queue family other than the graphics queue family. Resources written by the
+	 * transfer queue then have to be handed over to the graphics queue family.
+	 */
+	bool has_dedicated_transfer_queue() const;
+
+	/**
+	 * @brief Writes the pipeline cache to \ref LDEVICE_PIPELINE_CACHE_PATH. The file is written next to the previous
+	 * one and replaces it once complete, so a crash while writing never leaves a damaged cache behind.
+	 */
+	bool save_pipeline_cache() const;
+
 	static DeviceSwapChainSupportInfo query_swapchain_support(vk::PhysicalDevice physical_device, vk::SurfaceKHR surface);
 
 private:
@@ -0,0 +1,196 @@
+/**
+ * @file geometry_arena.hpp
+ * @brief This header file contains the geometry arena, which stores the vertices and indices of all meshes in a
+ * single vertex buffer and a single index buffer.
+ */
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "definitions.hpp"
+#include "math/vertex.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/device.hpp"
+#include "renderer/system/upload_system.hpp"
+#include "renderer/vulkan_buffer.hpp"
+
+/**
+ * @brief The default amount of vertices the geometry arena can hold.
+ */
+#define LGEOMETRY_ARENA_DEFAULT_VERTEX_CAPACITY (1024 * 1024)
+
+/**
+ * @brief The default amount of indices the geometry arena can hold.
+ */
+#define LGEOMETRY_ARENA_DEFAULT_INDEX_CAPACITY (4 * 1024 * 1024)
+
+/**
+ * @brief The arena gets compacted once the free space between allocations exceeds this fraction of the capacity of
+ * either buffer.
+ */
+#define LGEOMETRY_ARENA_COMPACTION_THRESHOLD 0.25f
+
+namespace lise
+{
+
+/**
+ * @brief The location of the geometry of a single mesh within the geometry arena. The offsets are in elements, and are
+ * passed on to the draw calls as the vertex offset and first index.
+ */
+struct GeometryRange
+{
+	uint32_t vertex_offset;
+	uint32_t vertex_count;
+
+	uint32_t first_index;
+	uint32_t index_count;
+};
+
+/**
+ * @brief A range of free elements in one of the buffers of the geometry arena.
+ */
+struct GeometryArenaBlock
+{
+	uint32_t offset;
+	uint32_t size;
+};
+
+/**
+ * @brief The free elements of one of the buffers of the geometry arena, as a list of blocks sorted by offset.
+ * Neighbouring free blocks are always merged.
+ */
+struct GeometryArenaFreeList
+{
+	std::vector<GeometryArenaBlock> blocks;
+
+	uint32_t capacity;
+
+	/**
+	 * @brief Resets the free list to a single block, which starts after the given amount of used elements.
+	 */
+	void reset(uint32_t capacity, uint32_t used);
+
+	/**
+	 * @brief Takes a range of elements from the first block that is large enough.
+	 *
+	 * @return std::optional<uint32_t> The offset of the range, or nothing if no block is large enough.
+	 */
+	std::optional<uint32_t> allocate(uint32_t size);
+
+	/**
+	 * @brief Returns a range of elements to the free list, merging it with the neighbouring free blocks.
+	 */
+	void free(uint32_t offset, uint32_t size);
+
+	/**
+	 * @brief The amount of free elements that lie between allocations, rather than after the last one.
+	 */
+	uint32_t get_hole_size() const;
+};
+
+/**
+ * @brief A device local vertex buffer and index buffer shared by all meshes. As every mesh uses the same buffers, they
+ * are bound once per frame, and meshes can be drawn using a single indirect draw.
+ *
+ * Freed ranges are reused by later allocations. Once too much space is lost between allocations, \ref update moves all
+ * allocations to the start of a new pair of buffers, and updates the ranges of their owners.
+ */
+struct GeometryArena
+{
+	std::unique_ptr<VulkanBuffer> vertex_buffer;
+	std::unique_ptr<VulkanBuffer> index_buffer;
+
+	GeometryArenaFreeList free_vertices;
+	GeometryArenaFreeList free_indices;
+
+	/**
+	 * @brief The ranges of all allocations. Compaction writes the new locations into them.
+	 */
+	std::vector<GeometryRange*> allocations;
+
+	/**
+	 * @brief Buffers replaced by a compaction, which frames in flight might still be reading from.
+	 */
+	struct RetiredBuffers
+	{
+		std::unique_ptr<VulkanBuffer> vertex_buffer;
+		std::unique_ptr<VulkanBuffer> index_buffer;
+		uint64_t frame_number;
+	};
+
+	std::vector<RetiredBuffers> retired_buffers;
+
+	/**
+	 * @brief Set when an allocation fails, as there might be enough free space in separate blocks.
+	 */
+	bool is_compaction_requested;
+
+	/**
+	 * @brief Set when compacting failed, so fragmentation alone does not retry it every frame. Cleared once a range
+	 * is freed or an allocation fails.
+	 */
+	bool is_compaction_deferred;
+
+	const Device* device;
+
+	GeometryArena() = default;
+
+	GeometryArena(const GeometryArena&) = delete; // Prevent copies.
+
+	GeometryArena& operator = (const GeometryArena&) = delete; // Prevent copies.
+
+	static std::unique_ptr<GeometryArena> create(const Device* device, uint32_t vertex_capacity, uint32_t index_capacity);
+
+	/**
+	 * @brief Allocates room for the geometry of a mesh, and uploads the vertices and indices into it.
+	 *
+	 * @param out_range Receives the location of the geometry. The arena keeps a pointer to it until the range is
+	 * freed, so it has to stay at the same address.
+	 *
+	 * @return true if the allocation succeeded.
+	 * @return false if the arena is full.
+	 */
+	bool allocate(
+		GeometryRange* out_range,
+		const vertex* vertices,
+		uint32_t vertex_count,
+		const uint32_t* indices,
+		uint32_t index_count
+	);
+
+	/**
+	 * @brief Frees the geometry of a mesh. The geometry must not be used by any frame in flight anymore.
+	 */
+	void free(GeometryRange* range);
+
+	/**
+	 * @brief Destroys the buffers retired by earlier compactions that are no longer in use, and compacts the arena if
+	 * it is too fragmented. Has to be called after \ref upload_system_acquire, outside of a render pass, and before
+	 * anything reads from the arena.
+	 *
+	 * @param frame_number The number of the current frame.
+	 * @param frames_in_flight The amount of frames that can be in flight at the same time.
+	 *
+	 * @return true if the arena got compacted, which moves the allocations into new buffers.
+	 */
+	bool update(CommandBuffer* command_buffer, uint64_t frame_number, uint32_t frames_in_flight);
+
+	/**
+	 * @brief Binds the vertex buffer and index buffer.
+	 */
+	void bind(CommandBuffer* command_buffer) const;
+
+private:
+	bool compact(CommandBuffer* command_buffer, uint64_t frame_number);
+
+	bool create_buffers(
+		uint32_t vertex_capacity,
+		uint32_t index_capacity,
+		std::unique_ptr<VulkanBuffer>& out_vertex_buffer,
+		std::unique_ptr<VulkanBuffer>& out_index_buffer
+	) const;
+};
+
+}
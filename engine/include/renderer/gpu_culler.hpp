@@ -0,0 +1,169 @@
+/**
+ * @file gpu_culler.hpp
+ * @brief This header file contains the GPU culler, which culls objects against the view frustum in a compute shader
+ * and writes the indirect draw commands of the visible ones.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "definitions.hpp"
+#include "math/frustum.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/device.hpp"
+#include "renderer/pipeline.hpp"
+#include "renderer/resource/shader_stage.hpp"
+#include "renderer/uniform_allocator.hpp"
+#include "renderer/vulkan_buffer.hpp"
+
+/**
+ * @brief The maximum amount of objects that can be culled within a single frame.
+ */
+#define LGPU_CULLER_MAX_OBJECTS (64 * 1024)
+
+/**
+ * @brief The maximum amount of indirect draws within a single frame.
+ */
+#define LGPU_CULLER_MAX_DRAWS 4096
+
+namespace lise
+{
+
+/**
+ * @brief An object to cull, as read by the cull compute shader. Written into the uniform allocator every frame.
+ */
+struct GpuCullObject
+{
+	/**
+	 * @brief The world space bounding sphere, the radius is stored in w.
+	 */
+	vector4f sphere;
+
+	// The draw command of the object.
+	uint32_t index_count;
+	uint32_t first_index;
+	int32_t vertex_offset;
+	uint32_t first_instance;
+
+	/**
+	 * @brief The index of the first draw command of the indirect draw the object is part of. Visible objects are
+	 * appended after it when draw counts are used.
+	 */
+	uint32_t command_base;
+
+	/**
+	 * @brief The index of the draw command of the object when draw counts are not used. Culled objects then get a
+	 * draw command with an instance count of 0.
+	 */
+	uint32_t command_index;
+
+	/**
+	 * @brief The index of the indirect draw the object is part of, which is the index of its draw count.
+	 */
+	uint32_t draw_index;
+
+	uint32_t padding;
+};
+
+static_assert(sizeof(GpuCullObject) == 48, "GpuCullObject has to match the std430 layout of the cull shader.");
+
+/**
+ * @brief Culls objects against the view frustum on the GPU.
+ *
+ * The objects of every indirect draw are stored in a contiguous range of draw commands. If the device supports draw
+ * counts, visible objects are compacted to the start of the range and their amount is written to the draw count of
+ * the draw. Otherwise every object keeps its own draw command, and culled objects are drawn with zero instances.
+ */
+struct GpuCuller
+{
+	std::unique_ptr<ShaderStage> shader_stage;
+
+	vk::DescriptorSetLayout descriptor_set_layout;
+	vk::DescriptorPool descriptor_pool;
+
+	/**
+	 * @brief A descriptor set for every frame in flight, pointing at the objects and the buffers of the frame.
+	 */
+	std::vector<vk::DescriptorSet> descriptor_sets;
+
+	std::unique_ptr<Pipeline> pipeline;
+
+	/**
+	 * @brief The draw commands and draw counts of every frame in flight. Written by the compute shader, read by the
+	 * indirect draws.
+	 */
+	std::vector<std::unique_ptr<VulkanBuffer>> command_buffers;
+	std::vector<std::unique_ptr<VulkanBuffer>> count_buffers;
+
+	/**
+	 * @brief Whether the visible objects are compacted and drawn using vkCmdDrawIndexedIndirectCount.
+	 */
+	bool uses_draw_count;
+
+	/**
+	 * @brief The maximum amount of draw commands of a single indirect draw, which is limited by maxDrawIndirectCount.
+	 */
+	uint32_t max_draw_command_count;
+
+	const Device* device;
+
+	GpuCuller() = default;
+
+	GpuCuller(const GpuCuller&) = delete; // Prevent copies.
+
+	~GpuCuller();
+
+	GpuCuller& operator = (const GpuCuller&) = delete; // Prevent copies.
+
+	/**
+	 * @brief Whether the device supports the features the GPU culler requires, which are multiDrawIndirect and
+	 * drawIndirectFirstInstance.
+	 */
+	static bool is_supported(const Device* device);
+
+	/**
+	 * @brief Creates the GPU culler.
+	 *
+	 * @param uniform_allocator The allocator the objects are written into.
+	 * @param frame_count The amount of frames in flight.
+	 */
+	static std::unique_ptr<GpuCuller> create(
+		const Device* device,
+		const FrameUniformAllocator* uniform_allocator,
+		uint32_t frame_count
+	);
+
+	/**
+	 * @brief Records the dispatch that culls the objects of the frame. Has to be recorded outside of a render pass.
+	 *
+	 * @param first_object The index of the first object in the uniform allocator, in objects.
+	 * @param object_count The amount of objects.
+	 * @param draw_count The amount of indirect draws the objects are part of.
+	 */
+	void cull(
+		CommandBuffer* command_buffer,
+		uint32_t frame,
+		const Frustum& frustum,
+		uint32_t first_object,
+		uint32_t object_count,
+		uint32_t draw_count
+	);
+
+	/**
+	 * @brief Records an indirect draw of the visible objects of a draw.
+	 *
+	 * @param draw_index The index of the draw.
+	 * @param command_base The index of the first draw command of the draw.
+	 * @param object_count The amount of objects in the draw.
+	 */
+	void draw(
+		CommandBuffer* command_buffer,
+		uint32_t frame,
+		uint32_t draw_index,
+		uint32_t command_base,
+		uint32_t object_count
+	);
+};
+
+}
@@ -0,0 +1,162 @@
+/**
+ * @file gpu_timer.hpp
+ * @brief This header file contains the GPU timer, which measures the GPU time of scopes within a frame using
+ * timestamp queries.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "definitions.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/device.hpp"
+
+/**
+ * @brief The maximum amount of scopes that can be measured within a single frame.
+ */
+#define LGPU_TIMER_MAX_SCOPES 32
+
+namespace lise
+{
+
+/**
+ * @brief The measured GPU time of a single scope.
+ */
+struct GpuTimerScope
+{
+	/**
+	 * @brief The name of the scope, as passed to \ref GpuTimer::begin_scope.
+	 */
+	const char* name;
+
+	/**
+	 * @brief The start of the scope in nanoseconds, relative to the start of the first scope of the frame.
+	 */
+	uint64_t start_ns;
+
+	/**
+	 * @brief The end of the scope in nanoseconds, relative to the start of the first scope of the frame.
+	 */
+	uint64_t end_ns;
+
+	/**
+	 * @brief The nesting depth of the scope. Top level scopes have a depth of 0.
+	 */
+	uint32_t depth;
+
+	double get_duration_ms() const { return (end_ns - start_ns) / 1000000.0; }
+};
+
+/**
+ * @brief Measures GPU times using a timestamp query pool with a range of queries for every frame in flight.
+ *
+ * The results of a frame are read back once the frame comes around again, at which point its fence has already been
+ * waited on. Reading the results therefore never stalls.
+ */
+struct GpuTimer
+{
+	const Device* device;
+
+	vk::QueryPool query_pool;
+
+	/**
+	 * @brief Whether the graphics queue supports timestamps. An unsupported timer silently ignores all scopes.
+	 */
+	bool is_supported;
+
+	/**
+	 * @brief The amount of nanoseconds it takes for a timestamp to be incremented by 1.
+	 */
+	double timestamp_period;
+
+	/**
+	 * @brief The mask of the valid bits of a timestamp.
+	 */
+	uint64_t timestamp_mask;
+
+	/**
+	 * @brief The scopes recorded for a single frame in flight.
+	 */
+	struct FrameQueries
+	{
+		std::vector<const char*> names;
+		std::vector<uint32_t> depths;
+
+		/**
+		 * @brief The CPU time the frame got submitted at, as returned by \ref profiler_get_time_ns.
+		 */
+		uint64_t submit_time_ns;
+
+		bool is_submitted;
+	};
+
+	std::vector<FrameQueries> frames;
+
+	uint32_t current_frame;
+
+	/**
+	 * @brief The stack of scopes that have been begun but not yet ended in the current frame.
+	 */
+	std::vector<uint32_t> open_scopes;
+
+	/**
+	 * @brief The scopes of the most recent frame of which the results have been read back.
+	 */
+	std::vector<GpuTimerScope> results;
+
+	GpuTimer() = default;
+
+	GpuTimer(const GpuTimer&) = delete; // Prevent copies.
+
+	~GpuTimer();
+
+	GpuTimer& operator = (const GpuTimer&) = delete; // Prevent copies.
+
+	/**
+	 * @brief Creates a GPU timer.
+	 *
+	 * @param device The device to create the query pool on.
+	 * @param frame_count The amount of frames in flight.
+	 */
+	static std::unique_ptr<GpuTimer> create(const Device* device, uint32_t frame_count);
+
+	/**
+	 * @brief Reads back the results of the previous use of the given frame and resets its queries. Has to be called
+	 * outside of a render pass, after the fence of the frame has been waited on.
+	 */
+	void begin_frame(CommandBuffer* command_buffer, uint32_t frame);
+
+	/**
+	 * @brief Ends all scopes that are still open. Has to be called right before the command buffer gets submitted.
+	 */
+	void end_frame(CommandBuffer* command_buffer);
+
+	/**
+	 * @brief Writes the start timestamp of a scope. Scopes can be nested, and have to be ended in reverse order.
+	 *
+	 * @param name The name of the scope. The string is not copied and has to outlive the timer.
+	 */
+	void begin_scope(CommandBuffer* command_buffer, const char* name);
+
+	/**
+	 * @brief Writes the end timestamp of the most recently begun scope.
+	 */
+	void end_scope(CommandBuffer* command_buffer);
+
+	/**
+	 * @brief Gets the sum of the durations of all top level scopes with the given name of the most recent results.
+	 */
+	double get_scope_ms(const char* name) const;
+
+	/**
+	 * @brief Gets the time between the start of the first and the end of the last top level scope of the most recent
+	 * results.
+	 */
+	double get_frame_ms() const;
+
+private:
+	void read_results(uint32_t frame);
+};
+
+}
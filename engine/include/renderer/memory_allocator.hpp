@@ -0,0 +1,209 @@
+/**
+ * @file memory_allocator.hpp
+ * @brief This header file contains the device memory allocator, which sub-allocates buffers and images from large
+ * blocks of device memory.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "definitions.hpp"
+
+/**
+ * @brief The size of a single block of device memory. Has to be a power of two.
+ */
+#define LMEMORY_ALLOCATOR_BLOCK_SIZE (64ull * 1024 * 1024)
+
+/**
+ * @brief The smallest size a block gets split into. Has to be a power of two, and at least as large as the largest
+ * possible `nonCoherentAtomSize` (256).
+ */
+#define LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE 256ull
+
+namespace lise
+{
+
+struct Device;
+struct MemoryBlock;
+
+/**
+ * @brief A range of device memory handed out by the \ref MemoryAllocator.
+ */
+struct MemoryAllocation
+{
+	vk::DeviceMemory memory;
+
+	/**
+	 * @brief The offset of the allocation within the device memory. Resources have to be bound at this offset.
+	 */
+	uint64_t offset;
+
+	/**
+	 * @brief The requested size of the allocation.
+	 */
+	uint64_t size;
+
+	/**
+	 * @brief The size of the entire device memory object the allocation lives in.
+	 */
+	uint64_t memory_size;
+
+	/**
+	 * @brief A pointer to the start of the allocation if the memory is host visible, nullptr otherwise. Host visible
+	 * memory is mapped once, for as long as it exists.
+	 */
+	void* mapped_data;
+
+	uint32_t memory_type_index;
+
+	/**
+	 * @brief The property flags of the memory type. These can contain more flags than were requested.
+	 */
+	vk::MemoryPropertyFlags property_flags;
+
+	/**
+	 * @brief The block the allocation was taken from, or nullptr for a dedicated allocation.
+	 */
+	MemoryBlock* block;
+
+	/**
+	 * @brief The buddy order of the allocation within its block.
+	 */
+	uint32_t order;
+};
+
+/**
+ * @brief Statistics about the memory allocator.
+ */
+struct MemoryAllocatorStats
+{
+	uint32_t block_count;
+	uint32_t dedicated_allocation_count;
+	uint32_t allocation_count;
+
+	/**
+	 * @brief The amount of device memory allocated from the driver, in bytes.
+	 */
+	uint64_t reserved_bytes;
+
+	/**
+	 * @brief The amount of bytes requested by live allocations.
+	 */
+	uint64_t used_bytes;
+
+	/**
+	 * @brief The amount of bytes taken up by live allocations after rounding up to their buddy size.
+	 */
+	uint64_t allocated_bytes;
+
+	/**
+	 * @brief The amount of free bytes within the blocks.
+	 */
+	uint64_t free_bytes;
+
+	/**
+	 * @brief The largest range that can be allocated without allocating a new block.
+	 */
+	uint64_t largest_free_range;
+
+	/**
+	 * @brief The external fragmentation of the free memory within the blocks, ranging from 0 (all free memory is a
+	 * single range) to 1.
+	 */
+	float fragmentation;
+};
+
+/**
+ * @brief A block of device memory that gets split using a buddy allocator.
+ */
+struct MemoryBlock
+{
+	vk::DeviceMemory memory;
+
+	uint32_t memory_type_index;
+
+	/**
+	 * @brief Whether the block holds linear resources (buffers, linear images) or optimal images. The two are kept in
+	 * separate blocks so the buffer-image granularity never has to be taken into account.
+	 */
+	bool is_linear;
+
+	void* mapped_data;
+
+	/**
+	 * @brief The offsets of the free ranges of every buddy order. Order 0 ranges are
+	 * \ref LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE bytes.
+	 */
+	std::vector<std::set<uint64_t>> free_lists;
+
+	uint32_t allocation_count;
+	uint64_t used_bytes;
+	uint64_t allocated_bytes;
+};
+
+/**
+ * @brief Sub-allocates device memory from large blocks per memory type. Allocations larger than half a block get
+ * their own device memory. All functions are thread safe.
+ */
+struct MemoryAllocator
+{
+	const Device* device;
+
+	std::vector<std::unique_ptr<MemoryBlock>> blocks;
+
+	uint32_t dedicated_allocation_count;
+	uint64_t dedicated_bytes;
+
+	mutable std::mutex mutex;
+
+	MemoryAllocator() = default;
+
+	MemoryAllocator(const MemoryAllocator&) = delete; // Prevent copies.
+
+	~MemoryAllocator();
+
+	MemoryAllocator& operator = (const MemoryAllocator&) = delete; // Prevent copies.
+
+	static std::unique_ptr<MemoryAllocator> create(const Device* device);
+
+	/**
+	 * @brief Allocates device memory.
+	 *
+	 * @param requirements The memory requirements of the resource.
+	 * @param property_flags The memory properties the memory type has to have.
+	 * @param is_linear Whether the memory is used for a buffer or linear image, rather than an optimal image.
+	 * @return std::optional<MemoryAllocation> The allocation, or an empty optional if no memory could be allocated.
+	 */
+	std::optional<MemoryAllocation> allocate(
+		const vk::MemoryRequirements& requirements,
+		vk::MemoryPropertyFlags property_flags,
+		bool is_linear
+	);
+
+	/**
+	 * @brief Returns an allocation to the allocator. The resource bound to it has to be destroyed or unbound.
+	 */
+	void free(const MemoryAllocation& allocation);
+
+	MemoryAllocatorStats get_stats() const;
+
+	/**
+	 * @brief Finds the index of a memory type that is allowed by the type bits and has the given properties.
+	 *
+	 * @return int32_t The index of the memory type, or -1 if there is none.
+	 */
+	int32_t find_memory_type(uint32_t type_bits, vk::MemoryPropertyFlags property_flags) const;
+
+private:
+	MemoryBlock* create_block(uint32_t memory_type_index, bool is_linear);
+
+	std::optional<MemoryAllocation> allocate_dedicated(uint64_t size, uint32_t memory_type_index);
+};
+
+}
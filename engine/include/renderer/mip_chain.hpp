@@ -0,0 +1,45 @@
+/**
+ * @file mip_chain.hpp
+ * @brief This header file contains functions for building the mip chains of textures on the CPU.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "definitions.hpp"
+#include "math/vector2.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief Gets the amount of levels in a complete mip chain, down to and including the 1x1 level.
+ */
+uint32_t mip_chain_get_level_count(vector2ui size);
+
+/**
+ * @brief Gets the size of a mip level. Every level is half the size of the previous one, rounded down, but never
+ * smaller than a single pixel.
+ */
+vector2ui mip_chain_get_level_size(vector2ui size, uint32_t level);
+
+/**
+ * @brief Gets the amount of bytes a mip chain of four channel, eight bit pixels takes up, with the levels tightly
+ * packed one after another.
+ */
+uint64_t mip_chain_get_byte_size(vector2ui size, uint32_t level_count);
+
+/**
+ * @brief Builds a mip chain of four channel, eight bit pixels. Every level is a 2x2 box filtered copy of the previous
+ * level, computed four pixels at a time using SSE2. Levels with an odd size drop their last row or column, levels that
+ * are a single pixel wide or high average it with itself.
+ *
+ * @param pixels The pixels of the first level.
+ * @param size The size of the first level.
+ * @param level_count The amount of levels to build, including the first.
+ * @param out_chain [out] A buffer of \ref mip_chain_get_byte_size bytes the levels are written to. The first level is
+ * copied into it as well.
+ */
+void mip_chain_generate(const uint8_t* pixels, vector2ui size, uint32_t level_count, uint8_t* out_chain);
+
+}
@@ -37,6 +37,16 @@ struct Pipeline
 		bool depth_test_enabled
 	);
 
+	/**
+	 * @brief Creates a compute pipeline.
+	 */
+	static std::unique_ptr<Pipeline> create_compute(
+		const Device* device,
+		const std::vector<vk::DescriptorSetLayout>& descriptor_set_layouts,
+		const vk::PipelineShaderStageCreateInfo& shader_stage,
+		const std::vector<vk::PushConstantRange>& push_constant_ranges
+	);
+
 	void bind(const CommandBuffer* command_buffer, vk::PipelineBindPoint bind_point);
 };
 
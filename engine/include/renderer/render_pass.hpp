@@ -67,7 +67,16 @@ struct RenderPass
 		bool has_next_pass
 	);
 
-	void begin(CommandBuffer* cb, vk::Framebuffer frame_buffer);
+	/**
+	 * @brief Begins the render pass.
+	 *
+	 * @param contents Whether the commands of the first subpass are recorded inline, or by secondary command buffers.
+	 */
+	void begin(
+		CommandBuffer* cb,
+		vk::Framebuffer frame_buffer,
+		vk::SubpassContents contents = vk::SubpassContents::eInline
+	);
 
 	void end(CommandBuffer* cb);
 };
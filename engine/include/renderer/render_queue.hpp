@@ -0,0 +1,277 @@
+/**
+ * @file render_queue.hpp
+ * @brief This header file contains the render queue, which collects the meshes drawn during a frame, culls the ones
+ * outside of the view frustum, sorts the rest by render state, and draws copies of the same mesh using a single
+ * instanced draw call, or draws them indirectly after culling them on the GPU. The draw calls can be recorded by many
+ * threads at once.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+#include "math/frustum.hpp"
+#include "math/mat4x4.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/gpu_culler.hpp"
+#include "renderer/resource/mesh.hpp"
+#include "renderer/uniform_allocator.hpp"
+
+/**
+ * @brief The least amount of batches recorded by a single recording job. Fewer batches are not worth the overhead of
+ * a secondary command buffer.
+ */
+#define LRENDER_QUEUE_MIN_BATCHES_PER_JOB 32
+
+namespace lise
+{
+
+/**
+ * @brief The layers of the render queue. Layers are drawn in order. Opaque items are drawn front to back and grouped
+ * by render state, transparent items are drawn back to front.
+ */
+enum class RenderLayer
+{
+	OPAQUE,
+	TRANSPARENT
+};
+
+/**
+ * @brief A single mesh submitted to the render queue.
+ */
+struct RenderQueueItem
+{
+	Mesh* mesh;
+
+	mat4x4 model;
+
+	RenderLayer layer;
+};
+
+/**
+ * @brief The sort key of an item, and the index of the item in the queue.
+ */
+struct RenderQueueSortEntry
+{
+	/**
+	 * @brief For opaque items, from the most to the least significant bits: layer (4), shader (12), shader instance
+	 * (16), mesh (16) and depth (16). Transparent items have their inverted depth right after the layer instead.
+	 */
+	uint64_t key;
+
+	uint32_t index;
+};
+
+/**
+ * @brief A range of sorted items that is drawn using a single draw call, or a draw call per item for shaders that are
+ * not instanced.
+ */
+struct RenderQueueBatch
+{
+	/**
+	 * @brief The mesh of the first item. All items share its shader, and its shader instance unless the shader is
+	 * bindless.
+	 */
+	Mesh* mesh;
+
+	/**
+	 * @brief The range of the items in the sorted entries.
+	 */
+	uint32_t first_entry;
+	uint32_t entry_count;
+
+	/**
+	 * @brief The index of the per instance data of the first item, for instanced shaders.
+	 */
+	uint32_t first_instance;
+
+	/**
+	 * @brief Whether the items have been culled on the GPU, and are drawn using an indirect draw. The items can have
+	 * different meshes then.
+	 */
+	bool is_indirect;
+
+	/**
+	 * @brief The index of the indirect draw, and of its first draw command.
+	 */
+	uint32_t draw_index;
+	uint32_t command_base;
+
+	/**
+	 * @brief The dynamic offset of the ubo of the shader instance in the uniform allocator.
+	 */
+	uint32_t ubo_offset;
+
+	/**
+	 * @brief Set when the ubo could not be written this frame. The batch is not drawn, as its offset would point into
+	 * the region of another frame.
+	 */
+	bool is_skipped;
+};
+
+/**
+ * @brief The amount of commands recorded by a flush of the render queue.
+ */
+struct RenderQueueStats
+{
+	uint32_t draw_calls;
+	uint32_t pipeline_binds;
+	uint32_t descriptor_set_binds;
+	uint32_t buffer_binds;
+
+	/**
+	 * @brief The amount of submitted items that were outside of the view frustum. Items culled on the GPU are not
+	 * counted.
+	 */
+	uint32_t culled_items;
+
+	/**
+	 * @brief Adds the counts of other statistics, such as the ones of another recording job.
+	 */
+	void add(const RenderQueueStats& other)
+	{
+		draw_calls += other.draw_calls;
+		pipeline_binds += other.pipeline_binds;
+		descriptor_set_binds += other.descriptor_set_binds;
+		buffer_binds += other.buffer_binds;
+		culled_items += other.culled_items;
+	}
+};
+
+struct RenderQueue
+{
+	std::vector<RenderQueueItem> items;
+
+	/**
+	 * @brief The world space bounding spheres of the items, stored as a structure of arrays so they can be culled
+	 * using SIMD instructions, and the results of the culling.
+	 */
+	std::vector<float> bounds_x;
+	std::vector<float> bounds_y;
+	std::vector<float> bounds_z;
+	std::vector<float> bounds_radius;
+	std::vector<uint8_t> visible;
+
+	/**
+	 * @brief The sort keys of the items, and scratch memory for sorting them. Kept around to prevent allocating every
+	 * frame.
+	 */
+	std::vector<RenderQueueSortEntry> sort_entries;
+	std::vector<RenderQueueSortEntry> sort_scratch;
+
+	/**
+	 * @brief Dense indices of the shaders, shader instances and meshes of the sorted items, in the order they were first
+	 * encountered. They are packed into the sort keys instead of the ids, which grow without bounds. Rebuilt by every
+	 * \ref prepare.
+	 */
+	std::unordered_map<const Shader*, uint32_t> shader_indices;
+	std::unordered_map<const Shader::Instance*, uint32_t> instance_indices;
+	std::unordered_map<const Mesh*, uint32_t> mesh_indices;
+
+	/**
+	 * @brief Set once a dense index did not fit in its field of the sort key, so the warning is only logged once.
+	 */
+	bool has_warned_key_overflow = false;
+
+	/**
+	 * @brief The batches built by \ref prepare.
+	 */
+	std::vector<RenderQueueBatch> batches;
+
+	/**
+	 * @brief The GPU culler used by the current frame, nullptr if the items are culled on the CPU.
+	 */
+	GpuCuller* gpu_culler;
+
+	/**
+	 * @brief Whether the queue is recorded once and submitted for many frames. Static queues are not culled, as the
+	 * camera moves between frames, and their per instance data and ubos are allocated from the static part of the
+	 * uniform allocator.
+	 */
+	bool is_static = false;
+
+	/**
+	 * @brief The statistics of the current frame.
+	 */
+	RenderQueueStats stats;
+
+	/**
+	 * @brief The view matrix of the camera, used to compute the depth of the items.
+	 */
+	mat4x4 view;
+
+	/**
+	 * @brief The view frustum of the camera. Items outside of it are not drawn.
+	 */
+	Frustum frustum;
+
+	/**
+	 * @brief The view space depth that maps to the largest depth in the sort keys. Items further away share the
+	 * largest depth.
+	 */
+	float depth_range;
+
+	/**
+	 * @brief Sets the camera the items are culled against and sorted by during the next \ref flush.
+	 */
+	void set_camera(const mat4x4& projection, const mat4x4& view, float depth_range);
+
+	/**
+	 * @brief Queues a mesh to be drawn during the next \ref flush.
+	 */
+	void submit(Mesh* mesh, const mat4x4& model, RenderLayer layer = RenderLayer::OPAQUE);
+
+	/**
+	 * @brief Culls the submitted meshes against the view frustum, sorts the visible ones by their sort keys, and writes
+	 * their per instance data and instance uniforms. Has to be recorded outside of a render pass, before \ref flush or
+	 * \ref record.
+	 *
+	 * Consecutive items sharing a mesh with an instanced shader are batched into a single draw call. Their model
+	 * matrices are written to the per instance data in the uniform allocator. Meshes with other shaders get a draw
+	 * call per item.
+	 *
+	 * @param gpu_culler If not nullptr, items with instanced shaders are culled by a compute dispatch recorded into the
+	 * command buffer, and items sharing a shader instance are batched into a single indirect draw. Items with bindless
+	 * shaders only have to share the shader.
+	 */
+	void prepare(
+		CommandBuffer* command_buffer,
+		FrameUniformAllocator* allocator,
+		GpuCuller* gpu_culler,
+		uint32_t current_image
+	);
+
+	/**
+	 * @brief Records the draw calls of the prepared batches, and empties the queue. Binds are only recorded when the
+	 * state differs from the previous draw.
+	 */
+	RenderQueueStats flush(CommandBuffer* command_buffer, uint32_t current_image);
+
+	/**
+	 * @brief Gets the amount of jobs the prepared batches are worth recording with, so every job records at least
+	 * \ref LRENDER_QUEUE_MIN_BATCHES_PER_JOB batches.
+	 */
+	uint32_t get_job_count(uint32_t max_job_count) const;
+
+	/**
+	 * @brief Records the draw calls of a range of the prepared batches, without modifying the queue. Different ranges
+	 * can be recorded into different command buffers by different threads at the same time. The command buffer starts
+	 * without any bound state, so the first batch of every range binds all of its state.
+	 *
+	 * @return RenderQueueStats The amount of commands recorded. The culled items are not included.
+	 */
+	RenderQueueStats record(
+		CommandBuffer* command_buffer,
+		uint32_t first_batch,
+		uint32_t batch_count,
+		uint32_t current_image
+	) const;
+
+	/**
+	 * @brief Empties the queue after its batches have been recorded.
+	 */
+	void clear();
+};
+
+}
@@ -5,7 +5,33 @@
 namespace lise
 {
 
-bool renderer_initialize(const char* consumer_name);
+/**
+ * @brief This structure contains configurations for initializing the renderer.
+ */
+struct RendererConfig
+{
+	/**
+	 * @brief The name of the consumer application, passed on to the Vulkan instance.
+	 */
+	const char* application_name;
+
+	/**
+	 * @brief Renders into offscreen images instead of a window surface.
+	 */
+	bool headless;
+
+	/**
+	 * @brief The width of the offscreen images. Only used when running headless.
+	 */
+	uint32_t width;
+
+	/**
+	 * @brief The height of the offscreen images. Only used when running headless.
+	 */
+	uint32_t height;
+};
+
+bool renderer_initialize(const RendererConfig& config);
 
 void renderer_shutdown();
 
@@ -5,10 +5,13 @@
 #include <vector>
 
 #include "definitions.hpp"
+#include "math/bounds.hpp"
 #include "math/vertex.hpp"
 #include "renderer/command_buffer.hpp"
+#include "renderer/geometry_arena.hpp"
 #include "renderer/resource/shader.hpp"
 #include "renderer/resource/texture.hpp"
+#include "renderer/system/upload_system.hpp"
 #include "renderer/vulkan_buffer.hpp"
 #include "math/vector4.hpp"
 #include "math/mat4x4.hpp"
@@ -30,14 +33,28 @@ public:
 
 	std::vector<uint32_t> indices;
 
-	std::unique_ptr<VulkanBuffer> vertex_buffer;
-	std::unique_ptr<VulkanBuffer> index_buffer;
+	/**
+	 * @brief The bounding volumes of the vertices, in model space. Computed once when the mesh is created.
+	 */
+	AABB bounds;
+	BoundingSphere bounding_sphere;
+
+	/**
+	 * @brief The arena the vertices and indices are stored in, and their location within it. The arena updates the
+	 * location when it gets compacted.
+	 *
+	 * Meshes have to be created outside of \ref vulkan_begin_frame and \ref vulkan_end_frame. Their uploads are then
+	 * acquired by the next frame before it draws them. Meshes created during a frame could be drawn before their
+	 * uploads have been handed over.
+	 */
+	GeometryArena* geometry_arena;
+	GeometryRange geometry;
 
 	MeshInstanceUBO instance_ubo;
 	Shader::Instance* shader_instance;
 
 	/**
-	 * @brief A pointer to a loaded material in the lise_obj struct.
+	 * @brief The diffuse texture the mesh was created with. Streamed textures replace it in the shader instance only.
 	 */
 	const Texture* diffuse_texture;
 
@@ -55,8 +72,7 @@ public:
 
 	static std::unique_ptr<Mesh> create(
 		const Device* device,
-		vk::CommandPool command_pool,
-		vk::Queue queue,
+		GeometryArena* geometry_arena,
 		Shader* shader,
 		std::string name,
 		std::vector<vertex> vertices,
@@ -64,8 +80,6 @@ public:
 		vector4f diffuse_color,
 		const Texture* diffuse_texture
 	);
-
-	void draw(CommandBuffer* command_buffer, const mat4x4& model, uint32_t current_image);
 };
 
 }
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "definitions.hpp"
 #include "renderer/resource/mesh.hpp"
 #include "renderer/command_buffer.hpp"
 #include "renderer/device.hpp"
+#include "renderer/render_queue.hpp"
 #include "math/transform.hpp"
 #include "renderer/resource/shader.hpp"
 #include "loader/obj_loader.hpp"
@@ -17,7 +19,20 @@ struct Model
 {
 	Transform transform;
 
-	std::vector<std::unique_ptr<Mesh>> meshes;
+	/**
+	 * @brief The meshes of the model. Meshes are shared between a model and all of its clones.
+	 */
+	std::vector<std::shared_ptr<Mesh>> meshes;
+
+	/**
+	 * @brief Invisible models are skipped when drawing.
+	 */
+	bool is_visible = true;
+
+	/**
+	 * @brief Static models are drawn from the static draw cache. Set using \ref vulkan_set_model_static.
+	 */
+	bool is_static = false;
 
 	Shader* shader;
 
@@ -29,9 +44,25 @@ struct Model
 
 	Model& operator = (Model&) = delete;
 
-	static std::unique_ptr<Model> create(const Device* device, Shader* shader, const Obj& obj);
+	/**
+	 * @brief Creates a model from a loaded obj file. The geometry of the meshes is stored in the given arena.
+	 */
+	static std::unique_ptr<Model> create(
+		const Device* device,
+		GeometryArena* geometry_arena,
+		Shader* shader,
+		const Obj& obj
+	);
+
+	/**
+	 * @brief Creates a new model that shares the meshes of this model, but has its own transform.
+	 */
+	std::unique_ptr<Model> clone() const;
 
-	void draw(CommandBuffer* command_buffer, uint32_t current_image);
+	/**
+	 * @brief Submits the meshes of the model to a render queue, which draws them once it gets flushed.
+	 */
+	void submit(RenderQueue& render_queue) const;
 };
 
 }
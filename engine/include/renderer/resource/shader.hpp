@@ -5,13 +5,19 @@
 #include <vector>
 
 #include "definitions.hpp"
+#include "renderer/bindless_texture_table.hpp"
 #include "renderer/vulkan_buffer.hpp"
 #include "renderer/pipeline.hpp"
+#include "renderer/uniform_allocator.hpp"
 #include "renderer/resource/texture.hpp"
 
 #include "loader/shader_config_loader.hpp"
 
-#define LSHADER_MAX_INSTANCE_COUNT 1024
+/**
+ * @brief The amount of instances the descriptor sets of a single instance descriptor pool are allocated for. Shaders
+ * create another pool whenever their pools are full.
+ */
+#define LSHADER_INSTANCE_POOL_PAGE_SIZE 64
 
 namespace lise
 {
@@ -20,7 +26,13 @@ enum class ShaderScope
 {
 	GLOBAL,
 	INSTANCE,
-	LOCAL
+	LOCAL,
+
+	/**
+	 * @brief Data of a single drawn instance, read from the instance storage buffer using the instance index. Allows
+	 * drawing many copies of a mesh with a single draw call.
+	 */
+	PER_INSTANCE
 };
 
 enum class ShaderUniformType
@@ -80,7 +92,29 @@ struct Shader
 		std::vector<vk::DescriptorSet> descriptor_sets;
 	
 		void* ubo; // NOTE: Maybe make this constant?
-		std::vector<bool> ubo_dirty;
+
+		/**
+		 * @brief The frame number of the uniform allocator at the time the ubo was last written. The ubo is only
+		 * written once per frame, no matter how often the instance gets drawn.
+		 */
+		uint64_t ubo_frame_number;
+
+		/**
+		 * @brief The dynamic offset of the ubo in the uniform allocator for the current frame.
+		 */
+		uint32_t ubo_offset;
+
+		/**
+		 * @brief The frame number of the uniform allocator at the time the instance was last drawn. The texture system
+		 * uses it to find the textures that have not been sampled for the longest time.
+		 */
+		uint64_t last_drawn_frame;
+
+		/**
+		 * @brief Incremented whenever the ubo or a sampler gets set, and whenever a descriptor set gets rewritten.
+		 * Command buffers that are recorded once compare it to find out whether they have to be recorded again.
+		 */
+		uint64_t revision;
 	
 		/**
 		 * @brief An array of texture pointers.
@@ -99,17 +133,33 @@ struct Shader
 
 		Instance(const Instance&) = delete; // Prevent copies.
 	
-		~Instance();
-	
 		Instance& operator = (const Instance&) = delete; // Prevent copies.
 		
 		void set_ubo(void* data);
 	
 		void set_sampler(uint32_t sampler_index, const Texture* sampler);
 	
-		void update_ubo(uint32_t current_image);
+		/**
+		 * @brief Writes the ubo into the uniform allocator once per frame, and updates the descriptors of dirty samplers.
+		 *
+		 * @return false if the uniform allocator ran out of space, in which case \ref ubo_offset does not point to this
+		 * frame's copy of the ubo and must not be bound.
+		 */
+		bool update_ubo(uint32_t current_image);
 
 		void bind_descriptor_set(CommandBuffer* command_buffer, uint32_t current_image);
+
+		/**
+		 * @brief Binds the descriptor set, reading the ubo from the given offset in the uniform allocator instead of from
+		 * the copy written by \ref update_ubo.
+		 */
+		void bind_descriptor_set(CommandBuffer* command_buffer, uint32_t current_image, uint32_t ubo_offset);
+
+		/**
+		 * @brief Writes the ubo and the bindless indices of the samplers into the per instance data of a drawn
+		 * instance, for bindless shaders.
+		 */
+		void write_material(uint8_t* per_instance_data) const;
 	};
 
 	/**
@@ -156,7 +206,7 @@ struct Shader
 	void* global_ubo;
 
 	/**
-	 * @brief The global uniform buffer object.
+	 * @brief The global uniform buffer object. The buffer is persistently mapped.
 	 */
 	std::unique_ptr<VulkanBuffer> global_ub;
 
@@ -169,19 +219,62 @@ struct Shader
 	 */
 	std::vector<ShaderUniform> global_uniforms;
 
+	/**
+	 * @brief An array of the members of the per instance data.
+	 */
+	std::vector<ShaderUniform> per_instance_uniforms;
+
+	/**
+	 * @brief The size of the per instance data of a single instance in the instance storage buffer.
+	 */
+	uint32_t per_instance_stride;
+
 	// Instance uniform data.
-	vk::DescriptorPool instance_descriptor_pool;
 	vk::DescriptorSetLayout instance_descriptor_set_layout;
 
 	/**
-	 * @brief The instance uniform buffer.
+	 * @brief The pages the instance descriptor sets are allocated from. Every pool holds the descriptor sets of
+	 * \ref LSHADER_INSTANCE_POOL_PAGE_SIZE instances, and a new pool is created once the last one is full. Descriptor
+	 * sets are never freed back to their pool, they are recycled through \ref free_instance_slots instead.
+	 */
+	std::vector<vk::DescriptorPool> instance_descriptor_pools;
+
+	/**
+	 * @brief The amount of instances the last pool still has descriptor sets for.
 	 */
-	std::unique_ptr<VulkanBuffer> instance_ub;
+	uint32_t instance_pool_remaining;
 
 	/**
-	 * @brief An array of booleans representing free slots in the instance uniform buffer.
+	 * @brief The sizes of an instance descriptor pool.
 	 */
-	std::vector<bool> instance_ubo_free_list;
+	std::vector<vk::DescriptorPoolSize> instance_pool_sizes;
+
+	/**
+	 * @brief The allocator the instance uniform buffer objects are written to every frame. The instance descriptor
+	 * sets use dynamic offsets into its buffer.
+	 */
+	FrameUniformAllocator* uniform_allocator;
+
+	/**
+	 * @brief The identifier and descriptor sets of a deallocated instance, which the next allocated instance reuses.
+	 */
+	struct InstanceSlot
+	{
+		uint64_t id;
+
+		std::vector<vk::DescriptorSet> descriptor_sets;
+	};
+
+	/**
+	 * @brief The slots of deallocated instances. Allocating an instance pops the last slot, and only creates a new
+	 * slot if there are none.
+	 */
+	std::vector<InstanceSlot> free_instance_slots;
+
+	/**
+	 * @brief The amount of slots that have been created. Also the identifier of the next new slot.
+	 */
+	uint64_t instance_slot_count;
 
 	std::unordered_map<uint64_t, std::unique_ptr<Instance>> instances;
 
@@ -192,6 +285,22 @@ struct Shader
 	uint32_t instance_ubo_size;
 	uint32_t instance_ubo_stride;
 
+	/**
+	 * @brief Whether the instance uniforms and sampler indices are part of the per instance data, and the textures are
+	 * sampled from the bindless texture table. Bindless shaders have no instance descriptor sets, the table is bound to
+	 * set 1 instead.
+	 */
+	bool is_bindless;
+
+	/**
+	 * @brief The offsets of the instance ubo, and of the bindless indices of the instance samplers, in the per instance
+	 * data of bindless shaders. Every sampler index is a 32 bit unsigned integer.
+	 */
+	uint32_t material_offset;
+	uint32_t texture_index_offset;
+
+	BindlessTextureTable* bindless_table;
+
 	std::unique_ptr<Pipeline> pipeline;
 
 	const Device* device;
@@ -210,7 +319,8 @@ struct Shader
 		const RenderPass* render_pass,
 		uint32_t framebuffer_width,
 		uint32_t framebuffer_height,
-		uint32_t swapchain_image_count
+		uint32_t swapchain_image_count,
+		FrameUniformAllocator* uniform_allocator
 	);
 
 	void use(CommandBuffer* command_buffer, uint32_t current_image);
@@ -221,6 +331,22 @@ struct Shader
 
 	Instance* allocate_instance();
 
+	/**
+	 * @brief Whether the shader reads per instance data, and can draw many instances using a single draw call.
+	 */
+	bool is_instanced() const;
+
+	/**
+	 * @brief Finds a member of the per instance data by name.
+	 *
+	 * @return const ShaderUniform* The member, or nullptr if the shader has no such member.
+	 */
+	const ShaderUniform* find_per_instance_uniform(const std::string& name) const;
+
+	/**
+	 * @brief Destroys an instance, and keeps its slot for the next allocated instance. The instance must not be used
+	 * by any command buffer that is still being executed.
+	 */
 	void deallocate_instance(uint64_t id);
 };
 
@@ -5,6 +5,7 @@
 #include "definitions.hpp"
 #include "renderer/device.hpp"
 #include "renderer/vulkan_image.hpp"
+#include "renderer/system/upload_system.hpp"
 
 namespace lise
 {
@@ -17,18 +18,35 @@ struct Texture
 	uint8_t channel_count;
 
 	std::unique_ptr<Image> image;
+
+	/**
+	 * @brief The sampler of the texture, shared with every other texture with the same sampler state. Owned by the
+	 * sampler cache of the device.
+	 */
 	vk::Sampler sampler;
 
+	/**
+	 * @brief The upload of the pixel data. The image is in the shader read only layout once it is complete.
+	 */
+	UploadTicket upload_ticket;
+
+	/**
+	 * @brief The index of the texture in the bindless texture table. Index 0 is the default texture, which textures
+	 * that are not registered fall back to.
+	 */
+	uint32_t bindless_index;
+
 	const Device* device;
 
 	Texture() = default;
 
 	Texture(const Texture&) = delete; // Prevent copies.
 
-	~Texture();
-
 	Texture& operator = (const Texture&) = delete; // Prevent copies.
 
+	/**
+	 * @brief Creates a texture from four channel, eight bit pixel data, and generates its mip chain.
+	 */
 	LAPI static std::unique_ptr<Texture> create(
 		const Device* device,
 		const std::string& path,
@@ -37,6 +55,26 @@ struct Texture
 		const uint8_t* data,
 		bool has_transparency
 	);
+
+	/**
+	 * @brief Creates a texture from pixel data that already contains all of its mip levels, such as the contents of a
+	 * texture container.
+	 *
+	 * @param format The format of the pixel data. Has to be supported by the device, see
+	 * \ref texture_format_is_supported.
+	 * @param mip_levels The amount of mip levels in the pixel data.
+	 * @param data The tightly packed mip levels, starting with the largest.
+	 * @param data_size The amount of bytes in the pixel data.
+	 */
+	LAPI static std::unique_ptr<Texture> create(
+		const Device* device,
+		const std::string& path,
+		vector2ui size,
+		vk::Format format,
+		uint32_t mip_levels,
+		const uint8_t* data,
+		uint64_t data_size
+	);
 };
 
 }
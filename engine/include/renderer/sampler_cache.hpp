@@ -0,0 +1,67 @@
+/**
+ * @file sampler_cache.hpp
+ * @brief This header file contains the sampler cache, which shares a single sampler between everything that samples
+ * with the same state.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <vulkan/vulkan.hpp>
+
+#include "definitions.hpp"
+
+namespace lise
+{
+
+struct Device;
+
+/**
+ * @brief Hashes the state of a sampler create info. The pNext chain is not included.
+ */
+struct SamplerCreateInfoHash
+{
+	size_t operator () (const vk::SamplerCreateInfo& sampler_ci) const;
+};
+
+/**
+ * @brief Creates a sampler once for every distinct sampler state, and hands out the same sampler for every later
+ * request with that state. The samplers live as long as the cache, which keeps the amount of samplers well below
+ * `maxSamplerAllocationCount`. All functions are thread safe.
+ */
+struct SamplerCache
+{
+	const Device* device;
+
+	std::unordered_map<vk::SamplerCreateInfo, vk::Sampler, SamplerCreateInfoHash> samplers;
+
+	mutable std::mutex mutex;
+
+	SamplerCache() = default;
+
+	SamplerCache(const SamplerCache&) = delete; // Prevent copies.
+
+	~SamplerCache();
+
+	SamplerCache& operator = (const SamplerCache&) = delete; // Prevent copies.
+
+	static std::unique_ptr<SamplerCache> create(const Device* device);
+
+	/**
+	 * @brief Gets the sampler with the given state, creating it if it does not exist yet. The sampler is owned by the
+	 * cache, and must not be destroyed.
+	 *
+	 * @param sampler_ci The state of the sampler. Create infos with a pNext chain are not supported.
+	 * @return vk::Sampler The sampler, or a null handle if it could not be created.
+	 */
+	vk::Sampler get(const vk::SamplerCreateInfo& sampler_ci);
+
+	/**
+	 * @brief Gets the amount of samplers created by the cache.
+	 */
+	uint32_t get_sampler_count() const;
+};
+
+}
@@ -0,0 +1,112 @@
+/**
+ * @file static_draw_cache.hpp
+ * @brief This header file contains the static draw cache, which records the draws of models that never move into
+ * secondary command buffers that are reused for many frames.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "definitions.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/device.hpp"
+#include "renderer/render_queue.hpp"
+#include "renderer/uniform_allocator.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief The recorded draws of a single frame in flight.
+ */
+struct StaticDrawCacheFrame
+{
+	vk::CommandPool command_pool;
+	std::unique_ptr<CommandBuffer> command_buffer;
+
+	/**
+	 * @brief The revision of the cache at the time the command buffer was recorded.
+	 */
+	uint64_t revision;
+
+	/**
+	 * @brief The shader instances used by the recorded draws, and their revisions at the time of recording.
+	 */
+	std::vector<std::pair<Shader::Instance*, uint64_t>> instance_revisions;
+
+	/**
+	 * @brief The amount of commands in the command buffer.
+	 */
+	RenderQueueStats stats;
+};
+
+/**
+ * @brief Records the draws of static models once into a secondary command buffer per frame in flight, and executes
+ * them every frame. Frames only record the draws again once the cache has been invalidated, or once the material of one
+ * of the drawn meshes has changed.
+ *
+ * The per instance data and ubos of the draws are kept in the static part of the uniform allocator. Data that changes
+ * every frame has to come from the global ubo.
+ */
+struct StaticDrawCache
+{
+	/**
+	 * @brief The queue the static models are submitted to before recording.
+	 */
+	RenderQueue render_queue;
+
+	std::vector<StaticDrawCacheFrame> frames;
+
+	/**
+	 * @brief Incremented by \ref invalidate. Frames recorded at an older revision are out of date.
+	 */
+	uint64_t revision;
+
+	const Device* device;
+
+	StaticDrawCache() = default;
+
+	StaticDrawCache(const StaticDrawCache&) = delete; // Prevent copies.
+
+	StaticDrawCache& operator = (const StaticDrawCache&) = delete; // Prevent copies.
+
+	~StaticDrawCache();
+
+	static std::unique_ptr<StaticDrawCache> create(const Device* device, uint32_t frame_count);
+
+	/**
+	 * @brief Marks the draws of all frames as out of date. Has to be called whenever the set of static models changes,
+	 * one of them moves, the geometry arena moves its allocations, or the render pass gets recreated.
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Checks whether the draws of a frame have to be recorded again.
+	 */
+	bool is_out_of_date(uint32_t frame) const;
+
+	/**
+	 * @brief Marks the shader instances used by the draws of a frame as drawn, as the draws are executed without being
+	 * prepared again.
+	 */
+	void mark_drawn(uint32_t frame, uint64_t frame_number);
+
+	/**
+	 * @brief Records the items submitted to the render queue into the command buffer of a frame, and empties the queue.
+	 * The fence of the frame has to be waited on before calling this function.
+	 *
+	 * @param render_pass The render pass the command buffer gets executed in, at subpass 0.
+	 * @param viewport The viewport, which is not inherited from the primary command buffer.
+	 * @param scissor The scissor, which is not inherited from the primary command buffer.
+	 */
+	bool record(
+		FrameUniformAllocator* allocator,
+		vk::RenderPass render_pass,
+		const vk::Viewport& viewport,
+		const vk::Rect2D& scissor,
+		uint32_t frame
+	);
+};
+
+}
@@ -44,6 +44,18 @@ struct Swapchain
 
 	bool swapchain_out_of_date = false;
 
+	/**
+	 * @brief Whether this swapchain renders into offscreen images rather than presenting to a surface.
+	 */
+	bool is_headless = false;
+
+	/**
+	 * @brief The offscreen color images backing \ref images when the swapchain is headless.
+	 */
+	std::vector<std::unique_ptr<Image>> offscreen_images;
+
+	uint32_t next_offscreen_image_index = 0;
+
 	vk::SurfaceKHR surface;
 
 	const Device* device;
@@ -61,6 +73,16 @@ struct Swapchain
 		SwapchainInfo swapchain_info
 	);
 
+	/**
+	 * @brief Creates a swapchain without a surface. The images are regular offscreen color images, and presenting only
+	 * advances the current frame.
+	 */
+	static std::unique_ptr<Swapchain> create_headless(
+		const Device* device,
+		const RenderPass* render_pass,
+		SwapchainInfo swapchain_info
+	);
+
 	std::optional<uint32_t> acquire_next_image_index(
 		uint64_t timeout_ns,
 		vk::Semaphore image_available_semaphore,
@@ -70,6 +92,11 @@ struct Swapchain
 	bool present(vk::Semaphore render_complete_semaphore, uint32_t present_image_index);
 
 	static SwapchainInfo query_info(const Device* device, vk::SurfaceKHR surface);
+
+	static SwapchainInfo query_headless_info(const Device* device, vector2ui size);
+
+private:
+	bool create_attachments(const RenderPass* render_pass);
 };
 
 }
@@ -1,16 +1,29 @@
 #pragma once
 
+#include <span>
 #include <string>
+#include <vector>
 
 #include "definitions.hpp"
 #include "renderer/resource/shader.hpp"
 #include "renderer/device.hpp"
 #include "renderer/render_pass.hpp"
 #include "renderer/swapchain.hpp"
+#include "renderer/uniform_allocator.hpp"
 
 namespace lise
 {
 
+/**
+ * @brief A shader to load using \ref shader_system_load_batch.
+ */
+struct ShaderLoadRequest
+{
+	std::string path;
+
+	const RenderPass* render_pass;
+};
+
 /**
  * @brief Initializes the shader system. The shader system loads and caches shaders, and allows the user to retrieve
  * pointers to cached shaders.
@@ -18,11 +31,17 @@ namespace lise
  * @param device A pointer to the device currently in use by the engine. This pointer gets cached internally, so
  * make sure to keep using the same memory address for the device.
  * @param swapchain A pointer to the swapchain. This pointer gets cached internally.
+ * @param uniform_allocator The allocator instance uniform buffer objects get written to. This pointer gets cached
+ * internally.
  * 
  * @return true if the initialisation succeeded.
  * @return false if the initialisation failed.
  */
-bool shader_system_initialize(const Device* device, const Swapchain* swapchain);
+bool shader_system_initialize(
+	const Device* device,
+	const Swapchain* swapchain,
+	FrameUniformAllocator* uniform_allocator
+);
 
 void shader_system_shutdown();
 
@@ -30,6 +49,16 @@ void shader_system_update_cache(const Swapchain* swapchain);
 
 Shader* shader_system_load(const std::string& path, const RenderPass* render_pass);
 
+/**
+ * @brief Loads many shaders at once. The configuration files are read, and the shader modules and pipelines are
+ * created, by the job system. The shaders are registered once all of them have finished, in the order of the
+ * requests.
+ *
+ * @return std::vector<Shader*> The loaded shaders in the order of the requests. Shaders that failed to load, or that
+ * were already loaded, are nullptr.
+ */
+std::vector<Shader*> shader_system_load_batch(std::span<const ShaderLoadRequest> requests);
+
 Shader* shader_system_get(const std::string& path);
 
 }
@@ -1,9 +1,34 @@
 #pragma once
 
 #include "definitions.hpp"
+#include "renderer/bindless_texture_table.hpp"
 #include "renderer/device.hpp"
+#include "renderer/resource/shader.hpp"
 #include "renderer/resource/texture.hpp"
 
+/**
+ * @brief The amount of bytes of streamed textures \ref texture_system_update uploads per frame, so large scenes load
+ * over several frames instead of stalling one. A single texture larger than the budget is still uploaded.
+ */
+#define LTEXTURE_SYSTEM_UPLOAD_BUDGET (16ull * 1024 * 1024)
+
+/**
+ * @brief The amount of bytes resident textures are allowed to take up, until changed using
+ * \ref texture_system_set_budget.
+ */
+#define LTEXTURE_SYSTEM_DEFAULT_BUDGET (512ull * 1024 * 1024)
+
+/**
+ * @brief The amount of frames a texture has to go without being drawn before it is reduced to save memory. Reduced
+ * textures that are drawn within this amount of frames get restored.
+ */
+#define LTEXTURE_SYSTEM_EVICTION_AGE 120
+
+/**
+ * @brief The largest width or height of the largest mip level that reduced textures keep.
+ */
+#define LTEXTURE_SYSTEM_REDUCED_SIZE 64
+
 namespace lise
 {
 
@@ -13,10 +38,81 @@ void texture_system_shutdown();
 
 const Texture* texture_system_get_default_texture();
 
+/**
+ * @brief Gets the table every texture is registered into.
+ *
+ * @return BindlessTextureTable* The table, or nullptr if the device does not support bindless textures.
+ */
+BindlessTextureTable* texture_system_get_bindless_table();
+
+/**
+ * @brief Sets the amount of bytes resident textures are allowed to take up. Once exceeded, \ref texture_system_update
+ * first evicts textures that are no longer referenced, least recently used first. It then reduces textures that
+ * have not been drawn for \ref LTEXTURE_SYSTEM_EVICTION_AGE frames to their smaller mip levels, if all of their
+ * references are samplers set by \ref texture_system_get_or_load_async.
+ */
+void texture_system_set_budget(uint64_t budget_bytes);
+
+/**
+ * @brief Gets the amount of bytes all resident textures take up, excluding the default texture.
+ */
+uint64_t texture_system_get_resident_bytes();
+
+/**
+ * @brief Loads a texture on the calling thread, and adds a reference to it. The reference has to be released using
+ * \ref texture_system_release. Textures that have already been loaded are not loaded again, and textures that are
+ * being streamed in are not waited for, the default texture is returned instead, without a reference.
+ */
 const Texture* texture_system_load(const Device* device, const std::string& path);
 
+/**
+ * @brief Gets a loaded texture, without adding a reference to it.
+ */
 const Texture* texture_system_get(const std::string& path);
 
+/**
+ * @brief Gets a texture, loading it on the calling thread if it has not been loaded yet, and adds a reference to it.
+ * The reference has to be released using \ref texture_system_release. Textures that are being streamed in are not
+ * waited for, the default texture is returned instead, without a reference.
+ */
 const Texture* texture_system_get_or_load(const Device* device, const std::string& path);
 
+/**
+ * @brief Releases a reference added by \ref texture_system_load or \ref texture_system_get_or_load. Unreferenced
+ * textures stay resident until the budget runs out.
+ */
+void texture_system_release(const Texture* texture);
+
+/**
+ * @brief Sets a sampler of a shader instance to a texture, streaming the texture in if it has not been loaded yet.
+ * The texture is decoded by a background job, and uploaded by \ref texture_system_update. Until the upload has
+ * finished, the sampler is set to the default texture. The sampler keeps a reference to the texture until
+ * \ref texture_system_unbind_instance, and is updated whenever the texture is reduced or restored.
+ *
+ * @return const Texture* The texture if it has already been loaded, the default texture otherwise.
+ */
+const Texture* texture_system_get_or_load_async(
+	const Device* device,
+	const std::string& path,
+	Shader::Instance* instance,
+	uint32_t sampler_index
+);
+
+/**
+ * @brief Releases the references of the samplers of a shader instance, and stops textures from being set on it. Has to
+ * be called before the instance is deallocated.
+ */
+void texture_system_unbind_instance(const Shader::Instance* instance);
+
+/**
+ * @brief Uploads decoded textures, up to \ref LTEXTURE_SYSTEM_UPLOAD_BUDGET bytes, and sets the textures whose uploads
+ * have finished on the shader instances waiting for them. Evicts and reduces textures while the budget is exceeded,
+ * and destroys the replaced textures once no frame in flight uses them. Called once per frame by the renderer, after
+ * the uploads of the frame have been acquired.
+ *
+ * @param frame_number The frame number of the uniform allocator, which shader instances are marked drawn with.
+ * @param frames_in_flight The amount of frames that can be in flight at the same time.
+ */
+void texture_system_update(const Device* device, uint64_t frame_number, uint32_t frames_in_flight);
+
 }
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+
+#include "definitions.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/device.hpp"
+#include "renderer/vulkan_buffer.hpp"
+#include "renderer/vulkan_image.hpp"
+
+/**
+ * @brief The size of the staging ring all uploads are copied through. Uploads larger than the ring get a temporary
+ * staging buffer of their own.
+ */
+#define LUPLOAD_SYSTEM_STAGING_SIZE (32ull * 1024 * 1024)
+
+/**
+ * @brief The amount of upload batches that can be in flight at the same time.
+ */
+#define LUPLOAD_SYSTEM_MAX_BATCHES 4
+
+/**
+ * @brief The stages at which a frame waits for the uploads it acquired. The first uses of uploaded resources are
+ * copies by the geometry arena and vertex input.
+ */
+#define LUPLOAD_SYSTEM_WAIT_STAGES (vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput)
+
+namespace lise
+{
+
+/**
+ * @brief Identifies the batch an upload was recorded into. A ticket of 0 is always complete.
+ */
+typedef uint64_t UploadTicket;
+
+/**
+ * @brief Initializes the upload system. The upload system copies data into device local buffers and images through
+ * a persistently mapped staging ring, and records the copies of many uploads into a single submission.
+ *
+ * Uploads are submitted to the transfer queue, so they overlap with rendering if the device has a dedicated transfer
+ * queue family. The renderer hands the uploaded resources over to the graphics queue using
+ * \ref upload_system_acquire.
+ *
+ * @param device A pointer to the device currently in use by the engine. This pointer gets cached internally.
+ *
+ * @return true if the initialisation succeeded.
+ * @return false if the initialisation failed.
+ */
+bool upload_system_initialize(const Device* device);
+
+/**
+ * @brief Waits for all uploads to finish, and shuts down the upload system.
+ */
+void upload_system_shutdown();
+
+/**
+ * @brief Copies data into a buffer. The data is copied into the staging ring immediately, so it does not have to
+ * outlive the call.
+ *
+ * @param buffer The destination buffer. Has to be created with the transfer destination usage.
+ * @param offset The offset within the destination buffer.
+ * @param size The amount of bytes to copy.
+ * @param data The data to copy.
+ *
+ * @return UploadTicket The ticket of the batch the copy was recorded into, or 0 if the upload failed.
+ */
+UploadTicket upload_system_upload_buffer(VulkanBuffer* buffer, uint64_t offset, uint64_t size, const void* data);
+
+/**
+ * @brief Copies tightly packed pixel data into every mip level of an image, and transitions the image to the shader
+ * read only layout once the copy has finished. The previous contents of the image are discarded.
+ *
+ * @param image The destination image. Has to be created with the transfer destination usage.
+ * @param size The amount of bytes to copy.
+ * @param data The pixel data to copy. The mip levels follow each other, starting with the largest.
+ *
+ * @return UploadTicket The ticket of the batch the copy was recorded into, or 0 if the upload failed.
+ */
+UploadTicket upload_system_upload_image(Image* image, uint64_t size, const void* data);
+
+/**
+ * @brief Submits the batch that is currently being recorded, if it contains any uploads. The renderer flushes once
+ * per frame through \ref upload_system_acquire.
+ *
+ * @return UploadTicket The ticket of the submitted batch.
+ */
+UploadTicket upload_system_flush();
+
+/**
+ * @brief Flushes the batch that is being recorded, and hands the resources written by all batches submitted since the
+ * previous call over to the graphics queue. Has to be called at the start of a frame, before anything that uses
+ * uploaded resources is recorded.
+ *
+ * @param command_buffer The graphics command buffer of the frame, which the ownership acquisitions are recorded into.
+ * @param semaphore An unsignaled semaphore, which gets signaled once all handed over resources have been written.
+ *
+ * @return true if the submission of the command buffer has to wait on the semaphore at \ref LUPLOAD_SYSTEM_WAIT_STAGES.
+ */
+bool upload_system_acquire(const CommandBuffer* command_buffer, vk::Semaphore semaphore);
+
+/**
+ * @brief Polls the fences of the submitted batches, and releases the staging memory of every finished batch.
+ */
+void upload_system_update();
+
+/**
+ * @brief Checks whether the batch of a ticket has finished executing on the device, without blocking.
+ */
+bool upload_system_is_complete(UploadTicket ticket);
+
+/**
+ * @brief Blocks until the batch of a ticket has finished executing on the device. Flushes the batch first if it has
+ * not been submitted yet.
+ */
+bool upload_system_wait(UploadTicket ticket);
+
+}
@@ -0,0 +1,57 @@
+/**
+ * @file texture_format.hpp
+ * @brief This header file contains functions describing the formats textures can be stored in, and a CPU decoder for
+ * the block compressed formats, used on devices that cannot sample them.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "definitions.hpp"
+#include "math/vector2.hpp"
+#include "renderer/device.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief Whether textures can be stored in a format: four channel, eight bit pixels, or BC1, BC3, BC7 or ETC2 blocks.
+ */
+bool texture_format_is_known(vk::Format format);
+
+/**
+ * @brief Whether a format stores pixels in 4x4 blocks.
+ */
+bool texture_format_is_block_compressed(vk::Format format);
+
+/**
+ * @brief Gets the amount of bytes a tightly packed image of a format takes up. Partial blocks at the right and bottom
+ * edges take up a whole block.
+ */
+uint64_t texture_format_get_byte_size(vk::Format format, vector2ui size);
+
+/**
+ * @brief Checks whether the device can sample, and upload to, optimally tiled images of a format. Block compressed
+ * formats also need their texture compression feature to be enabled.
+ */
+bool texture_format_is_supported(const Device* device, vk::Format format);
+
+/**
+ * @brief Gets the four channel, eight bit format a block compressed format decodes to. sRGB formats decode to an sRGB
+ * format.
+ */
+vk::Format texture_format_get_decoded_format(vk::Format format);
+
+/**
+ * @brief Decodes a tightly packed image of a block compressed format on the CPU.
+ *
+ * @param format The block compressed format of the image.
+ * @param blocks The blocks of the image, row by row.
+ * @param size The size of the image in pixels.
+ * @param out_pixels [out] A buffer of size.w * size.h four channel, eight bit pixels.
+ *
+ * @return false if the format is not block compressed.
+ */
+bool texture_format_decode(vk::Format format, const uint8_t* blocks, vector2ui size, uint8_t* out_pixels);
+
+}
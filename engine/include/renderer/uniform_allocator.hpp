@@ -0,0 +1,159 @@
+/**
+ * @file uniform_allocator.hpp
+ * @brief This header file contains the per-frame linear uniform allocator.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "definitions.hpp"
+#include "renderer/device.hpp"
+#include "renderer/vulkan_buffer.hpp"
+
+/**
+ * @brief The default size of the region of a single frame in the uniform allocator, in bytes. Large enough for the
+ * per instance data of around 250 000 instanced draws.
+ */
+#define LUNIFORM_ALLOCATOR_DEFAULT_REGION_SIZE (16 * 1024 * 1024)
+
+/**
+ * @brief The default size of the static part at the start of every region, in bytes.
+ */
+#define LUNIFORM_ALLOCATOR_DEFAULT_STATIC_SIZE (4 * 1024 * 1024)
+
+namespace lise
+{
+
+/**
+ * @brief A block of uniform memory that is valid for the duration of a single frame.
+ */
+struct UniformAllocation
+{
+	/**
+	 * @brief A pointer to the mapped memory of the allocation. nullptr if the allocation failed.
+	 */
+	void* data;
+
+	/**
+	 * @brief The offset of the allocation from the start of the buffer. Used as the dynamic offset when binding
+	 * descriptor sets.
+	 */
+	uint32_t offset;
+};
+
+/**
+ * @brief A mapped uniform buffer that is split into a region per frame. Allocations are linear and get released all
+ * at once when the region of a frame gets reused, so writing uniform data is a plain store into mapped memory. The
+ * buffer can be bound as a storage buffer as well, which the per instance data of instanced draws is read from.
+ *
+ * The start of every region is reserved for static allocations, which are not released by \ref begin_frame. They
+ * hold the data of command buffers that are recorded once and submitted for many frames.
+ */
+struct FrameUniformAllocator
+{
+	std::unique_ptr<VulkanBuffer> buffer;
+
+	/**
+	 * @brief A pointer to the start of the mapped buffer. The buffer stays mapped for its entire lifetime.
+	 */
+	uint8_t* mapped_data;
+
+	/**
+	 * @brief The size of the region of a single frame.
+	 */
+	uint64_t region_size;
+
+	/**
+	 * @brief The size of the static part at the start of every region.
+	 */
+	uint64_t static_size;
+
+	/**
+	 * @brief The amount of bytes allocated from the static part of every region.
+	 */
+	std::vector<uint64_t> static_heads;
+
+	uint32_t frame_count;
+
+	/**
+	 * @brief The alignment of every allocation. This is the minimum uniform buffer offset alignment of the device.
+	 */
+	uint64_t alignment;
+
+	/**
+	 * @brief The index of the region currently being allocated from.
+	 */
+	uint32_t current_frame;
+
+	/**
+	 * @brief The amount of bytes allocated from the current region.
+	 */
+	uint64_t region_head;
+
+	/**
+	 * @brief The amount of times \ref begin_frame has been called. Users can cache allocations by comparing it.
+	 */
+	uint64_t frame_number;
+
+	/**
+	 * @brief Whether an allocation has failed during the current frame. Prevents logging every failed allocation.
+	 */
+	bool has_overflowed;
+
+	const Device* device;
+
+	FrameUniformAllocator() = default;
+
+	FrameUniformAllocator(const FrameUniformAllocator&) = delete; // Prevent copies.
+
+	FrameUniformAllocator& operator = (const FrameUniformAllocator&) = delete; // Prevent copies.
+
+	/**
+	 * @brief Creates a uniform allocator. Device local host visible memory is preferred, plain host visible memory
+	 * is used if the device has no such memory type.
+	 *
+	 * @param device The device to create the buffer on.
+	 * @param region_size The size of the region of a single frame, in bytes.
+	 * @param frame_count The amount of regions. Has to be at least the amount of frames in flight.
+	 * @param static_size The size of the static part of every region, in bytes. Included in the region size.
+	 */
+	static std::unique_ptr<FrameUniformAllocator> create(
+		const Device* device,
+		uint64_t region_size,
+		uint32_t frame_count,
+		uint64_t static_size = 0
+	);
+
+	/**
+	 * @brief Starts allocating from the region of the given frame, releasing all previous allocations of that region.
+	 * The fence of the frame has to be waited on before calling this function.
+	 */
+	void begin_frame(uint32_t frame);
+
+	/**
+	 * @brief Allocates a block of uniform memory from the region of the current frame.
+	 *
+	 * @param size The size of the allocation in bytes.
+	 * @return UniformAllocation The allocation. The data pointer is nullptr if the region is exhausted.
+	 */
+	UniformAllocation allocate(uint64_t size);
+
+	/**
+	 * @brief Releases all static allocations of the region of the given frame. The fence of the frame has to be waited
+	 * on before calling this function.
+	 */
+	void reset_static(uint32_t frame);
+
+	/**
+	 * @brief Allocates a block of uniform memory from the static part of the region of the given frame. The block stays
+	 * valid until \ref reset_static gets called for the frame.
+	 *
+	 * @param frame The region to allocate from.
+	 * @param size The size of the allocation in bytes.
+	 * @return UniformAllocation The allocation. The data pointer is nullptr if the static part is exhausted.
+	 */
+	UniformAllocation allocate_static(uint32_t frame, uint64_t size);
+};
+
+}
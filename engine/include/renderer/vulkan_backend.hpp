@@ -7,13 +7,71 @@
 #include "renderer/render_pass.hpp"
 #include "renderer/swapchain.hpp"
 #include "renderer/fence.hpp"
+#include "renderer/geometry_arena.hpp"
+#include "renderer/gpu_culler.hpp"
+#include "renderer/gpu_timer.hpp"
+#include "renderer/renderer.hpp"
+#include "renderer/render_queue.hpp"
+#include "renderer/static_draw_cache.hpp"
+#include "renderer/uniform_allocator.hpp"
 #include "renderer/vulkan_buffer.hpp"
 #include "math/mat4x4.hpp"
+#include "loader/obj_loader.hpp"
+#include "renderer/resource/model.hpp"
 
 namespace lise
 {
 
-bool vulkan_initialize(const char* application_name);
+/**
+ * @brief Statistics about the most recently recorded frame.
+ */
+struct FrameStats
+{
+	/**
+	 * @brief The amount of draw calls recorded, including the ones executed from the static draw cache.
+	 */
+	uint32_t draw_calls;
+
+	/**
+	 * @brief The amount of draw calls executed from the static draw cache, which did not have to be recorded.
+	 */
+	uint32_t static_draw_calls;
+
+	/**
+	 * @brief The amount of pipeline, descriptor set and vertex/index buffer binds recorded by the render queue.
+	 */
+	uint32_t pipeline_binds;
+	uint32_t descriptor_set_binds;
+	uint32_t buffer_binds;
+
+	/**
+	 * @brief The amount of meshes of visible models that were skipped for being outside of the view frustum.
+	 */
+	uint32_t culled_meshes;
+
+	/**
+	 * @brief The amount of visible models that were drawn.
+	 */
+	uint32_t model_count;
+
+	/**
+	 * @brief The GPU time of the most recent frame with available timings, in milliseconds. GPU timings lag behind
+	 * by the amount of frames in flight, and are 0 if the device does not support timestamps.
+	 */
+	double gpu_frame_ms;
+
+	/**
+	 * @brief The GPU time spent in the world render pass, in milliseconds.
+	 */
+	double gpu_world_pass_ms;
+
+	/**
+	 * @brief The GPU time spent in the ui render pass, in milliseconds.
+	 */
+	double gpu_ui_pass_ms;
+};
+
+bool vulkan_initialize(const RendererConfig& config);
 
 void vulkan_shutdown();
 
@@ -23,6 +81,62 @@ bool vulkan_end_frame(float delta_time);
 
 vector2ui vulkan_get_framebuffer_size();
 
+/**
+ * @brief Creates a model using the builtin object shader and adds it to the list of models that get drawn every frame.
+ * 
+ * The model is owned by the renderer. Use \ref vulkan_destroy_model to get rid of it.
+ */
+LAPI Model* vulkan_create_model(const Obj& obj);
+
+/**
+ * @brief Creates a model that shares the meshes of the given model and adds it to the list of models that get drawn
+ * every frame.
+ */
+LAPI Model* vulkan_clone_model(const Model* model);
+
+/**
+ * @brief Removes a model from the list of drawn models. The model gets destroyed once no frame in flight uses it
+ * anymore.
+ */
+LAPI void vulkan_destroy_model(Model* model);
+
+/**
+ * @brief Sets whether a model is static. The draws of static models are recorded once and reused every frame, until
+ * \ref vulkan_invalidate_static_models gets called or the set of static models changes. Static models are not culled.
+ */
+LAPI void vulkan_set_model_static(Model* model, bool is_static);
+
+/**
+ * @brief Records the draws of the static models again before the next frames. Has to be called after moving a static
+ * model or changing its visibility.
+ */
+LAPI void vulkan_invalidate_static_models();
+
+LAPI FrameStats vulkan_get_frame_stats();
+
+/**
+ * @brief Gets all GPU timer scopes of the most recent frame with available timings, including user scopes.
+ */
+LAPI const std::vector<GpuTimerScope>& vulkan_get_gpu_timings();
+
+/**
+ * @brief Begins a GPU timer scope in the command buffer of the current frame. Can only be called between
+ * \ref vulkan_begin_frame and \ref vulkan_end_frame, and has to be ended using \ref vulkan_end_gpu_scope.
+ *
+ * @param name The name of the scope. The string is not copied.
+ */
+LAPI void vulkan_begin_gpu_scope(const char* name);
+
+/**
+ * @brief Ends the most recently begun GPU timer scope.
+ */
+LAPI void vulkan_end_gpu_scope();
+
+/**
+ * @brief Gets statistics about the device memory allocator.
+ */
+LAPI MemoryAllocatorStats vulkan_get_memory_stats();
+
 // TODO: temp hack
 LAPI void vulkan_set_view_matrix_temp(const mat4x4& view);
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderer/device.hpp"
+#include "renderer/memory_allocator.hpp"
 #include "definitions.hpp"
 
 namespace lise
@@ -17,9 +18,28 @@ public:
 
 	bool is_locked;
 
-	vk::DeviceMemory memory;
-	int32_t memory_index;
-	uint32_t memory_property_flags;
+	/**
+	 * @brief The range locked by \ref lock_memory, which gets flushed by \ref unlock_memory.
+	 */
+	uint64_t locked_offset;
+	uint64_t locked_size;
+
+	/**
+	 * @brief The memory of the buffer, sub-allocated by the device's memory allocator.
+	 */
+	MemoryAllocation allocation;
+
+	/**
+	 * @brief The property flags of the memory type the buffer was allocated from. These can contain more flags than
+	 * were requested.
+	 */
+	vk::MemoryPropertyFlags memory_property_flags;
+
+	/**
+	 * @brief A pointer to the start of the buffer if it is persistently mapped, nullptr otherwise. The pointer stays
+	 * valid for the lifetime of the buffer, except for calls to \ref resize.
+	 */
+	void* mapped_data;
 
 	const Device* device;
 
@@ -31,24 +51,51 @@ public:
 
 	VulkanBuffer& operator = (const VulkanBuffer&) = delete; // Prevent copies.
 	
+	/**
+	 * @brief Creates a buffer and allocates its memory from the device's memory allocator.
+	 *
+	 * @param persistently_mapped Exposes a stable pointer to the buffer through \ref mapped_data. The memory has to be
+	 * host visible, and the buffer gets bound on creation.
+	 */
 	LAPI static std::unique_ptr<VulkanBuffer> create(
 		const Device* device,
 		uint64_t size,
 		vk::BufferUsageFlags usage,
 		vk::MemoryPropertyFlags memory_property_flags,
-		bool bind_on_create
+		bool bind_on_create,
+		bool persistently_mapped = false
 	);
 
 	bool resize(uint64_t new_size, vk::Queue& queue, vk::CommandPool& pool);
 
 	bool bind(uint64_t offset);
 
+	/**
+	 * @brief Gets a pointer to a range of the buffer. Host visible memory is mapped once by the memory allocator, so
+	 * this returns a pointer into the existing mapping, after invalidating the range if the memory is not host
+	 * coherent.
+	 */
 	void* lock_memory(uint64_t offset, uint64_t size, vk::MemoryMapFlags flags);
 
+	/**
+	 * @brief Flushes the range locked by \ref lock_memory.
+	 */
 	void unlock_memory();
 
 	void load_data(uint64_t offset, uint64_t size, vk::MemoryMapFlags flags, const void* data);
 
+	/**
+	 * @brief Makes host writes to a range of a mapped buffer visible to the device. Does nothing if the memory is host
+	 * coherent.
+	 */
+	bool flush(uint64_t offset, uint64_t size);
+
+	/**
+	 * @brief Makes device writes to a range of a mapped buffer visible to the host. Does nothing if the memory is host
+	 * coherent.
+	 */
+	bool invalidate(uint64_t offset, uint64_t size);
+
 	void copy_to(
 		vk::CommandPool pool,
 		vk::Fence fence,
@@ -60,6 +107,9 @@ public:
 	);
 
 private:
+	bool is_host_coherent() const;
+
+	vk::MappedMemoryRange get_aligned_range(uint64_t offset, uint64_t size) const;
 };
 
 }
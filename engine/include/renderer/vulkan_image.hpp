@@ -14,11 +14,16 @@ struct Image
 
 	vk::Image handle;
 
-	vk::DeviceMemory memory;
+	MemoryAllocation allocation;
 	vk::ImageView image_view;
 
 	vk::Format image_format;
 
+	/**
+	 * @brief The amount of mip levels of the image. The view covers all of them.
+	 */
+	uint32_t mip_levels;
+
 	const Device* device;
 
 	Image() = default;
@@ -38,12 +43,26 @@ struct Image
 		vk::ImageUsageFlags use_flags,
 		vk::MemoryPropertyFlags memory_flags,
 		bool create_view,
-		vk::ImageAspectFlags view_aspect_flags
+		vk::ImageAspectFlags view_aspect_flags,
+		uint32_t mip_levels = 1
 	);
 
+	/**
+	 * @brief Records a layout transition of all mip levels.
+	 */
 	bool transition_layout(const CommandBuffer* command_buffer, vk::ImageLayout old_layout, vk::ImageLayout new_layout);
 
-	void copy_from_buffer(const CommandBuffer* command_buffer, vk::Buffer buffer);
+	/**
+	 * @brief Records a copy of all mip levels from a buffer. The levels are tightly packed one after another, starting
+	 * with the largest.
+	 */
+	void copy_from_buffer(const CommandBuffer* command_buffer, vk::Buffer buffer, uint64_t buffer_offset = 0);
+
+	/**
+	 * @brief Gets the amount of bytes a tightly packed mip level of the image takes up. Only formats that textures can
+	 * be stored in are supported, see \ref texture_format_is_known.
+	 */
+	uint64_t get_level_byte_size(uint32_t level) const;
 };
 
 }
@@ -5,6 +5,8 @@
 #include "core/clock.hpp"
 #include "core/event.hpp"
 #include "core/input.hpp"
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
 #include "renderer/renderer.hpp"
 #include "platform/platform.hpp"
 
@@ -23,6 +25,10 @@ struct EngineState
 	int16_t width;
 	int16_t height;
 
+	bool is_headless;
+	uint32_t headless_frame_count;
+	double headless_duration;
+
 	Clock delta_clock;
 	double delta_time;
 };
@@ -49,13 +55,27 @@ bool engine_create(EngineCreateInfo app_create_info)
 	engine_state.width = app_create_info.window_width;
 	engine_state.height = app_create_info.window_height;
 
+	engine_state.is_headless = app_create_info.headless;
+	engine_state.headless_frame_count = app_create_info.headless_frame_count;
+	engine_state.headless_duration = app_create_info.headless_duration;
+
 	// Initialize subsystems
 	event_init();
+
+	if (!job_system_init())
+	{
+		sl::log_fatal("Failed to initialize the job system.");
+		return false;
+	}
 	
 	engine_state.is_running = true;
 	engine_state.is_suspended = false;
 
-	if (!platform_init(
+	if (engine_state.is_headless)
+	{
+		sl::log_info("Running headless, the platform window will not be created.");
+	}
+	else if (!platform_init(
 		app_create_info.window_name,
 		app_create_info.window_pos_x,
 		app_create_info.window_pos_y,
@@ -69,7 +89,13 @@ bool engine_create(EngineCreateInfo app_create_info)
 
 	engine_state.delta_clock.reset();
 
-	if (!renderer_initialize(app_create_info.window_name))
+	RendererConfig renderer_config = {};
+	renderer_config.application_name = app_create_info.window_name;
+	renderer_config.headless = app_create_info.headless;
+	renderer_config.width = app_create_info.window_width;
+	renderer_config.height = app_create_info.window_height;
+
+	if (!renderer_initialize(renderer_config))
 	{
 		sl::log_fatal("Failed to initialize renderer submodule.");
 		return false;
@@ -96,13 +122,22 @@ bool engine_run()
 {
 	sl::log_info("Starting the engine.");
 
+	profiler_set_thread_name("main");
+
+	Clock run_clock;
+	run_clock.reset();
+
+	uint32_t frame_count = 0;
+
 	while (engine_state.is_running)
 	{
+		LPROFILE_SCOPE("frame");
+
 		// Calculate delta time.
 		engine_state.delta_time = engine_state.delta_clock.get_elapsed_time();
 		engine_state.delta_clock.reset();
 
-		if (!platform_poll_messages())
+		if (!engine_state.is_headless && !platform_poll_messages())
 		{
 			sl::log_fatal("Failed to poll platform messages");
 			engine_state.is_running = false;
@@ -133,6 +168,24 @@ bool engine_run()
 
 			input_update();
 		}
+
+		frame_count++;
+
+		// Headless runs stop themselves once the requested frame count or duration has been reached.
+		if (engine_state.is_headless)
+		{
+			bool frames_reached =
+				engine_state.headless_frame_count > 0 && frame_count >= engine_state.headless_frame_count;
+
+			bool duration_reached =
+				engine_state.headless_duration > 0.0 && run_clock.get_elapsed_time() >= engine_state.headless_duration;
+
+			if (frames_reached || duration_reached)
+			{
+				sl::log_info("Headless run finished after {} frames.", frame_count);
+				engine_state.is_running = false;
+			}
+		}
 	}
 
 	engine_state.is_running = false;
@@ -143,8 +196,13 @@ bool engine_run()
 	event_shutdown();
 
 	renderer_shutdown();
+
+	job_system_shutdown();
 	
-	platform_shutdown();
+	if (!engine_state.is_headless)
+	{
+		platform_shutdown();
+	}
 
 	sl::log_info("Successfully shut down the engine.");
 
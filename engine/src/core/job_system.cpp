@@ -0,0 +1,232 @@
+#include "core/job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief The jobs started by a single call to \ref job_system_run.
+ */
+struct JobBatch
+{
+	const std::function<void(uint32_t)>* job;
+
+	std::atomic<uint32_t> remaining;
+};
+
+struct Job
+{
+	JobBatch* batch;
+	uint32_t index;
+};
+
+static std::vector<std::thread> workers;
+
+static std::mutex queue_mutex;
+
+/**
+ * @brief Signaled when jobs get queued, or when the workers have to stop.
+ */
+static std::condition_variable queue_condition;
+
+/**
+ * @brief Signaled when the last job of a batch finishes.
+ */
+static std::condition_variable done_condition;
+
+static std::deque<Job> queue;
+
+/**
+ * @brief The jobs queued by \ref job_system_submit. Only taken by the workers, once \ref queue is empty.
+ */
+static std::deque<std::function<void()>> background_queue;
+
+static bool is_shutting_down;
+
+static void worker_main(uint32_t worker_index);
+static void execute(const Job& job);
+
+bool job_system_init(uint32_t worker_count)
+{
+	if (worker_count == 0)
+	{
+		uint32_t hardware_threads = std::thread::hardware_concurrency();
+
+		worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+	}
+
+	worker_count = std::min<uint32_t>(worker_count, LJOB_SYSTEM_MAX_THREADS - 1);
+
+	is_shutting_down = false;
+
+	workers.reserve(worker_count);
+
+	for (uint32_t i = 0; i < worker_count; i++)
+	{
+		workers.emplace_back(worker_main, i);
+	}
+
+	sl::log_info("Started the job system with {} worker threads.", worker_count);
+
+	return true;
+}
+
+void job_system_shutdown()
+{
+	{
+		std::lock_guard lock(queue_mutex);
+		is_shutting_down = true;
+	}
+
+	queue_condition.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	workers.clear();
+}
+
+uint32_t job_system_get_thread_count()
+{
+	return workers.size() + 1;
+}
+
+void job_system_run(uint32_t job_count, const std::function<void(uint32_t job_index)>& job)
+{
+	if (job_count == 0)
+	{
+		return;
+	}
+
+	if (workers.empty() || job_count == 1)
+	{
+		for (uint32_t i = 0; i < job_count; i++)
+		{
+			job(i);
+		}
+
+		return;
+	}
+
+	JobBatch batch;
+	batch.job = &job;
+	batch.remaining = job_count;
+
+	{
+		std::lock_guard lock(queue_mutex);
+
+		for (uint32_t i = 0; i < job_count; i++)
+		{
+			queue.push_back(Job { &batch, i });
+		}
+	}
+
+	queue_condition.notify_all();
+
+	// Help out until every job of the batch has finished. The calling thread might run jobs of other batches as well.
+	std::unique_lock lock(queue_mutex);
+
+	while (batch.remaining > 0)
+	{
+		if (queue.empty())
+		{
+			done_condition.wait(lock);
+			continue;
+		}
+
+		Job next = queue.front();
+		queue.pop_front();
+
+		lock.unlock();
+		execute(next);
+		lock.lock();
+	}
+}
+
+void job_system_submit(std::function<void()> job)
+{
+	if (workers.empty())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard lock(queue_mutex);
+		background_queue.push_back(std::move(job));
+	}
+
+	queue_condition.notify_one();
+}
+
+// Static helper functions.
+static void worker_main(uint32_t worker_index)
+{
+	profiler_set_thread_name("worker " + std::to_string(worker_index));
+
+	std::unique_lock lock(queue_mutex);
+
+	while (true)
+	{
+		queue_condition.wait(lock, [] { return is_shutting_down || !queue.empty() || !background_queue.empty(); });
+
+		if (is_shutting_down && queue.empty())
+		{
+			background_queue.clear();
+			return;
+		}
+
+		if (queue.empty())
+		{
+			std::function<void()> background_job = std::move(background_queue.front());
+			background_queue.pop_front();
+
+			lock.unlock();
+
+			{
+				LPROFILE_SCOPE("background job");
+				background_job();
+			}
+
+			lock.lock();
+			continue;
+		}
+
+		Job next = queue.front();
+		queue.pop_front();
+
+		lock.unlock();
+		execute(next);
+		lock.lock();
+	}
+}
+
+static void execute(const Job& job)
+{
+	LPROFILE_SCOPE("job");
+
+	(*job.batch->job)(job.index);
+
+	if (--job.batch->remaining == 0)
+	{
+		// Lock to prevent the waiting thread from missing the notification between checking and waiting.
+		std::lock_guard lock(queue_mutex);
+		done_condition.notify_all();
+	}
+}
+
+}
@@ -0,0 +1,285 @@
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <simple-logger.hpp>
+
+#include "platform/platform.hpp"
+
+namespace lise
+{
+
+struct ProfileZone
+{
+	const char* name;
+	uint64_t start_ns;
+	uint64_t end_ns;
+};
+
+/**
+ * @brief The ring buffer of a single thread, or of the virtual GPU track. Only a single thread writes zones, other
+ * threads only read them while exporting.
+ */
+struct ProfilerThreadBuffer
+{
+	uint32_t thread_index;
+	std::string thread_name;
+	const char* category;
+
+	std::unique_ptr<ProfileZone[]> zones;
+
+	/**
+	 * @brief The index of the zone stored in each slot of \ref zones, plus one. Zero while the slot is being written,
+	 * so the exporter can skip slots that were overwritten while copying them.
+	 */
+	std::unique_ptr<std::atomic<uint64_t>[]> sequences;
+
+	/**
+	 * @brief The total amount of zones ever written to this buffer.
+	 */
+	std::atomic<uint64_t> head;
+
+	/**
+	 * @brief The value of \ref head at the last reset. Zones before it are not exported.
+	 */
+	std::atomic<uint64_t> tail;
+};
+
+static std::mutex buffers_mutex;
+static std::vector<std::unique_ptr<ProfilerThreadBuffer>> thread_buffers;
+
+static thread_local ProfilerThreadBuffer* local_buffer;
+
+static ProfilerThreadBuffer* gpu_buffer;
+
+static ProfilerThreadBuffer* create_buffer(const char* category);
+static ProfilerThreadBuffer* get_local_buffer();
+static void record_zone(ProfilerThreadBuffer* buffer, const char* name, uint64_t start_ns, uint64_t end_ns);
+static void write_escaped(FILE* file, const char* str);
+
+uint64_t profiler_get_time_ns()
+{
+	return platform_get_absolute_time_ns();
+}
+
+void profiler_record_zone(const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+#ifdef L_ENABLE_PROFILER
+	record_zone(get_local_buffer(), name, start_ns, end_ns);
+#endif
+}
+
+void profiler_record_gpu_zone(const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+#ifdef L_ENABLE_PROFILER
+	if (!gpu_buffer)
+	{
+		gpu_buffer = create_buffer("gpu");
+
+		std::lock_guard lock(buffers_mutex);
+		gpu_buffer->thread_name = "GPU";
+	}
+
+	record_zone(gpu_buffer, name, start_ns, end_ns);
+#endif
+}
+
+void profiler_set_thread_name(const std::string& name)
+{
+#ifdef L_ENABLE_PROFILER
+	// Naming a thread allocates its ring buffer, which is left out when nothing gets recorded.
+	ProfilerThreadBuffer* buffer = get_local_buffer();
+
+	std::lock_guard lock(buffers_mutex);
+
+	buffer->thread_name = name;
+#endif
+}
+
+void profiler_reset()
+{
+	std::lock_guard lock(buffers_mutex);
+
+	for (auto& buffer : thread_buffers)
+	{
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+bool profiler_write_chrome_trace(const std::string& path)
+{
+	FILE* file = std::fopen(path.c_str(), "w");
+
+	if (!file)
+	{
+		sl::log_error("Failed to open trace file `{}` for writing.", path);
+		return false;
+	}
+
+	std::lock_guard lock(buffers_mutex);
+
+	// Copy the zones out of the ring buffers first, so the origin of the timeline can be determined.
+	std::vector<std::vector<ProfileZone>> zones(thread_buffers.size());
+	uint64_t origin_ns = UINT64_MAX;
+
+	for (size_t i = 0; i < thread_buffers.size(); i++)
+	{
+		ProfilerThreadBuffer* buffer = thread_buffers[i].get();
+
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t first = std::max(
+			buffer->tail.load(std::memory_order_relaxed),
+			head > LPROFILER_RING_CAPACITY ? head - LPROFILER_RING_CAPACITY : 0
+		);
+
+		zones[i].reserve(head - first);
+
+		for (uint64_t z = first; z < head; z++)
+		{
+			uint64_t slot = z % LPROFILER_RING_CAPACITY;
+
+			// The owning thread might lap the ring buffer while copying. Skip the zones that are being, or have been,
+			// overwritten, as their copies might be torn.
+			if (buffer->sequences[slot].load(std::memory_order_acquire) != z + 1)
+			{
+				continue;
+			}
+
+			ProfileZone zone = buffer->zones[slot];
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (buffer->sequences[slot].load(std::memory_order_relaxed) != z + 1)
+			{
+				continue;
+			}
+
+			zones[i].push_back(zone);
+		}
+
+		for (auto& zone : zones[i])
+		{
+			origin_ns = std::min(origin_ns, zone.start_ns);
+		}
+	}
+
+	std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	bool first_event = true;
+
+	for (size_t i = 0; i < thread_buffers.size(); i++)
+	{
+		ProfilerThreadBuffer* buffer = thread_buffers[i].get();
+
+		// Thread name metadata.
+		std::fprintf(
+			file,
+			"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+			first_event ? "" : ",\n",
+			buffer->thread_index
+		);
+		write_escaped(file, buffer->thread_name.c_str());
+		std::fprintf(file, "\"}}");
+
+		first_event = false;
+
+		for (auto& zone : zones[i])
+		{
+			// Trace event timestamps are in microseconds.
+			std::fprintf(file, ",\n{\"name\":\"");
+			write_escaped(file, zone.name);
+			std::fprintf(
+				file,
+				"\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+				buffer->category,
+				(zone.start_ns - origin_ns) / 1000.0,
+				(zone.end_ns - zone.start_ns) / 1000.0,
+				buffer->thread_index
+			);
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+
+	bool success = std::ferror(file) == 0;
+
+	std::fclose(file);
+
+	if (!success)
+	{
+		sl::log_error("Failed to write trace file `{}`.", path);
+		return false;
+	}
+
+	sl::log_info("Wrote profiler trace to `{}`.", path);
+
+	return true;
+}
+
+// Static helper functions.
+static ProfilerThreadBuffer* create_buffer(const char* category)
+{
+	auto buffer = std::make_unique<ProfilerThreadBuffer>();
+	buffer->category = category;
+	buffer->zones = std::make_unique<ProfileZone[]>(LPROFILER_RING_CAPACITY);
+	buffer->sequences = std::make_unique<std::atomic<uint64_t>[]>(LPROFILER_RING_CAPACITY);
+	buffer->head = 0;
+	buffer->tail = 0;
+
+	std::lock_guard lock(buffers_mutex);
+
+	buffer->thread_index = thread_buffers.size();
+	buffer->thread_name = "thread " + std::to_string(buffer->thread_index);
+
+	// The buffer outlives the thread, so the zones of finished threads still get exported.
+	ProfilerThreadBuffer* out = buffer.get();
+	thread_buffers.push_back(std::move(buffer));
+
+	return out;
+}
+
+static ProfilerThreadBuffer* get_local_buffer()
+{
+	if (!local_buffer)
+	{
+		local_buffer = create_buffer("cpu");
+	}
+
+	return local_buffer;
+}
+
+static void record_zone(ProfilerThreadBuffer* buffer, const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+
+	uint64_t slot = head % LPROFILER_RING_CAPACITY;
+
+	// Mark the slot as being written before overwriting it.
+	buffer->sequences[slot].store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	buffer->zones[slot] = ProfileZone { name, start_ns, end_ns };
+
+	buffer->sequences[slot].store(head + 1, std::memory_order_release);
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+static void write_escaped(FILE* file, const char* str)
+{
+	for (const char* c = str; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			std::fputc('\\', file);
+		}
+
+		std::fputc(*c, file);
+	}
+}
+
+}
@@ -5,6 +5,7 @@
 
 #include <simple-logger.hpp>
 
+#include "core/profiler.hpp"
 #include "loader/obj_format_loader.hpp"
 #include "util/string_utils.hpp"
 
@@ -13,6 +14,8 @@ namespace lise
 
 std::optional<Obj> Obj::load(const std::string& path)
 {
+	LPROFILE_SCOPE("Obj::load");
+
 	Obj out_obj;
 	// Load the obj file and parse.
 	ObjFormat loaded_obj_format;
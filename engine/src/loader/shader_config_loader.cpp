@@ -201,6 +201,18 @@ bool shader_config_load(const std::string& path, ShaderConfig& out_config)
 		out_config.uniforms[i].name = found_lines[i]->tokens[2];
 	}
 
+	// Check for the optional bindless line.
+	found_lines = obj_format_get_line(loaded_format, "bindless");
+
+	if (found_lines.size() > 1)
+	{
+		sl::log_error("Provided config file `{}` contains too many `bindless` lines. Please provide at most one.", path);
+
+		return false;
+	}
+
+	out_config.is_bindless = found_lines.size() == 1;
+
 	return true;
 }
 
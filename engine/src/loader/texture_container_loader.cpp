@@ -0,0 +1,346 @@
+#include "loader/texture_container_loader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <simple-logger.hpp>
+
+#include "renderer/mip_chain.hpp"
+#include "renderer/texture_format.hpp"
+
+#define KTX2_HEADER_SIZE 80
+#define KTX2_LEVEL_INDEX_ENTRY_SIZE 24
+
+#define TEXTURE_CONTAINER_MAX_DIMENSION (1u << 30)
+
+#define DDS_HEADER_SIZE 128
+#define DDS_DX10_HEADER_SIZE 20
+
+#define DDS_FLAG_MIPMAP_COUNT 0x20000
+#define DDS_PIXEL_FORMAT_FLAG_FOURCC 0x4
+#define DDS_PIXEL_FORMAT_FLAG_RGB 0x40
+#define DDS_CAPS2_CUBEMAP 0x200
+#define DDS_CAPS2_VOLUME 0x200000
+#define DDS_DIMENSION_TEXTURE2D 3
+
+namespace lise
+{
+
+static const uint8_t ktx2_identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+static bool load_ktx2(const std::string& path, const std::vector<uint8_t>& file, TextureContainer& out_container);
+static bool load_dds(const std::string& path, const std::vector<uint8_t>& file, TextureContainer& out_container);
+static vk::Format get_dxgi_format(uint32_t dxgi_format);
+static bool has_valid_size(const std::string& path, const TextureContainer& container);
+static uint64_t get_mip_chain_byte_size(const TextureContainer& container);
+static uint32_t read_u32(const std::vector<uint8_t>& file, uint64_t offset);
+static uint64_t read_u64(const std::vector<uint8_t>& file, uint64_t offset);
+
+bool texture_container_is_container_path(const std::string& path)
+{
+	return path.ends_with(".ktx2") || path.ends_with(".dds");
+}
+
+bool texture_container_load(const std::string& path, TextureContainer& out_container)
+{
+	// Read the entire file.
+	std::ifstream stream(path, std::ios::binary | std::ios::in | std::ios::ate);
+
+	if (stream.fail())
+	{
+		sl::log_error("Failed to open the following texture container: `{}`.", path);
+		return false;
+	}
+
+	std::vector<uint8_t> file(stream.tellg());
+	stream.seekg(0, std::ios::beg);
+	stream.read(reinterpret_cast<char*>(file.data()), file.size());
+
+	if (stream.fail())
+	{
+		sl::log_error("Failed to read the following texture container: `{}`.", path);
+		return false;
+	}
+
+	if (file.size() >= sizeof(ktx2_identifier) && memcmp(file.data(), ktx2_identifier, sizeof(ktx2_identifier)) == 0)
+	{
+		return load_ktx2(path, file, out_container);
+	}
+
+	if (file.size() >= 4 && memcmp(file.data(), "DDS ", 4) == 0)
+	{
+		return load_dds(path, file, out_container);
+	}
+
+	sl::log_error("The following file is neither a KTX2 nor a DDS file: `{}`.", path);
+	return false;
+}
+
+// Static helper functions.
+static bool load_ktx2(const std::string& path, const std::vector<uint8_t>& file, TextureContainer& out_container)
+{
+	if (file.size() < KTX2_HEADER_SIZE)
+	{
+		sl::log_error("The header of the following KTX2 file is truncated: `{}`.", path);
+		return false;
+	}
+
+	uint32_t vk_format = read_u32(file, 12);
+	uint32_t pixel_width = read_u32(file, 20);
+	uint32_t pixel_height = read_u32(file, 24);
+	uint32_t pixel_depth = read_u32(file, 28);
+	uint32_t layer_count = read_u32(file, 32);
+	uint32_t face_count = read_u32(file, 36);
+	uint32_t level_count = read_u32(file, 40);
+	uint32_t supercompression_scheme = read_u32(file, 44);
+
+	if (pixel_depth != 0 || layer_count > 1 || face_count != 1)
+	{
+		sl::log_error("The following KTX2 file is not a single two dimensional image: `{}`.", path);
+		return false;
+	}
+
+	if (supercompression_scheme != 0)
+	{
+		sl::log_error("The following KTX2 file is supercompressed, which is not supported: `{}`.", path);
+		return false;
+	}
+
+	// The values of VkFormat are stored directly.
+	out_container.format = static_cast<vk::Format>(vk_format);
+	out_container.size = { pixel_width, pixel_height };
+
+	// A level count of 0 asks the loader to generate the mip levels. Only the base level is stored then.
+	out_container.mip_levels = std::max(level_count, 1u);
+
+	if (!texture_format_is_known(out_container.format))
+	{
+		sl::log_error("The following KTX2 file has an unsupported format ({}): `{}`.", vk_format, path);
+		return false;
+	}
+
+	if (!has_valid_size(path, out_container))
+	{
+		return false;
+	}
+
+	if (file.size() < KTX2_HEADER_SIZE + (uint64_t) out_container.mip_levels * KTX2_LEVEL_INDEX_ENTRY_SIZE)
+	{
+		sl::log_error("The level index of the following KTX2 file is truncated: `{}`.", path);
+		return false;
+	}
+
+	// Validate the whole level index before allocating anything, so a corrupt header can not ask for more memory than
+	// the file holds.
+	uint64_t data_size = 0;
+
+	for (uint32_t level = 0; level < out_container.mip_levels; level++)
+	{
+		uint64_t entry = KTX2_HEADER_SIZE + (uint64_t) level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+
+		uint64_t byte_offset = read_u64(file, entry);
+		uint64_t byte_length = read_u64(file, entry + 8);
+
+		uint64_t level_size = texture_format_get_byte_size(
+			out_container.format,
+			mip_chain_get_level_size(out_container.size, level)
+		);
+
+		if (byte_length != level_size || byte_offset > file.size() || file.size() - byte_offset < byte_length ||
+			data_size > UINT64_MAX - byte_length)
+		{
+			sl::log_error("Level {} of the following KTX2 file is invalid: `{}`.", level, path);
+			return false;
+		}
+
+		data_size += byte_length;
+	}
+
+	// The level index starts with the largest level, but the file stores the smallest level first. Repack the levels
+	// largest first.
+	out_container.data.resize(data_size);
+
+	uint64_t data_offset = 0;
+
+	for (uint32_t level = 0; level < out_container.mip_levels; level++)
+	{
+		uint64_t entry = KTX2_HEADER_SIZE + (uint64_t) level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+
+		uint64_t byte_offset = read_u64(file, entry);
+		uint64_t byte_length = read_u64(file, entry + 8);
+
+		memcpy(out_container.data.data() + data_offset, file.data() + byte_offset, byte_length);
+
+		data_offset += byte_length;
+	}
+
+	return true;
+}
+
+static bool load_dds(const std::string& path, const std::vector<uint8_t>& file, TextureContainer& out_container)
+{
+	if (file.size() < DDS_HEADER_SIZE)
+	{
+		sl::log_error("The header of the following DDS file is truncated: `{}`.", path);
+		return false;
+	}
+
+	uint32_t flags = read_u32(file, 8);
+	uint32_t height = read_u32(file, 12);
+	uint32_t width = read_u32(file, 16);
+	uint32_t mip_map_count = read_u32(file, 28);
+	uint32_t pixel_format_flags = read_u32(file, 80);
+	uint32_t caps2 = read_u32(file, 112);
+
+	if (caps2 & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME))
+	{
+		sl::log_error("The following DDS file is not a single two dimensional image: `{}`.", path);
+		return false;
+	}
+
+	uint64_t data_offset = DDS_HEADER_SIZE;
+
+	out_container.format = vk::Format::eUndefined;
+
+	if (pixel_format_flags & DDS_PIXEL_FORMAT_FLAG_FOURCC)
+	{
+		const char* four_cc = reinterpret_cast<const char*>(file.data() + 84);
+
+		if (memcmp(four_cc, "DXT1", 4) == 0)
+		{
+			out_container.format = vk::Format::eBc1RgbaUnormBlock;
+		}
+		else if (memcmp(four_cc, "DXT5", 4) == 0)
+		{
+			out_container.format = vk::Format::eBc3UnormBlock;
+		}
+		else if (memcmp(four_cc, "DX10", 4) == 0)
+		{
+			if (file.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE)
+			{
+				sl::log_error("The DX10 header of the following DDS file is truncated: `{}`.", path);
+				return false;
+			}
+
+			uint32_t resource_dimension = read_u32(file, DDS_HEADER_SIZE + 4);
+			uint32_t array_size = read_u32(file, DDS_HEADER_SIZE + 12);
+
+			if (resource_dimension != DDS_DIMENSION_TEXTURE2D || array_size > 1)
+			{
+				sl::log_error("The following DDS file is not a single two dimensional image: `{}`.", path);
+				return false;
+			}
+
+			out_container.format = get_dxgi_format(read_u32(file, DDS_HEADER_SIZE));
+
+			data_offset += DDS_DX10_HEADER_SIZE;
+		}
+	}
+	else if (pixel_format_flags & DDS_PIXEL_FORMAT_FLAG_RGB)
+	{
+		// Only uncompressed files whose pixels are laid out as R, G, B and A bytes are supported.
+		if (read_u32(file, 88) == 32 && read_u32(file, 92) == 0x000000FF && read_u32(file, 96) == 0x0000FF00 &&
+			read_u32(file, 100) == 0x00FF0000 && read_u32(file, 104) == 0xFF000000)
+		{
+			out_container.format = vk::Format::eR8G8B8A8Unorm;
+		}
+	}
+
+	if (out_container.format == vk::Format::eUndefined)
+	{
+		sl::log_error("The following DDS file has an unsupported format: `{}`.", path);
+		return false;
+	}
+
+	out_container.size = { width, height };
+	out_container.mip_levels = (flags & DDS_FLAG_MIPMAP_COUNT) ? std::max(mip_map_count, 1u) : 1;
+
+	if (!has_valid_size(path, out_container))
+	{
+		return false;
+	}
+
+	// DDS files already store the levels tightly packed, largest first.
+	uint64_t data_size = get_mip_chain_byte_size(out_container);
+
+	if (file.size() - data_offset < data_size)
+	{
+		sl::log_error("The pixel data of the following DDS file is truncated: `{}`.", path);
+		return false;
+	}
+
+	out_container.data.assign(file.begin() + data_offset, file.begin() + data_offset + data_size);
+
+	return true;
+}
+
+static vk::Format get_dxgi_format(uint32_t dxgi_format)
+{
+	switch (dxgi_format)
+	{
+	case 28: return vk::Format::eR8G8B8A8Unorm;
+	case 29: return vk::Format::eR8G8B8A8Srgb;
+	case 71: return vk::Format::eBc1RgbaUnormBlock;
+	case 72: return vk::Format::eBc1RgbaSrgbBlock;
+	case 77: return vk::Format::eBc3UnormBlock;
+	case 78: return vk::Format::eBc3SrgbBlock;
+	case 98: return vk::Format::eBc7UnormBlock;
+	case 99: return vk::Format::eBc7SrgbBlock;
+	default: return vk::Format::eUndefined;
+	}
+}
+
+static bool has_valid_size(const std::string& path, const TextureContainer& container)
+{
+	if (container.size.w == 0 || container.size.h == 0)
+	{
+		sl::log_error("The following texture container is empty: `{}`.", path);
+		return false;
+	}
+
+	// Larger sizes could overflow the byte sizes of the levels.
+	if (container.size.w > TEXTURE_CONTAINER_MAX_DIMENSION || container.size.h > TEXTURE_CONTAINER_MAX_DIMENSION)
+	{
+		sl::log_error("The following texture container is too large: `{}`.", path);
+		return false;
+	}
+
+	if (container.mip_levels > mip_chain_get_level_count(container.size))
+	{
+		sl::log_error("The following texture container has more mip levels than its size allows: `{}`.", path);
+		return false;
+	}
+
+	return true;
+}
+
+static uint64_t get_mip_chain_byte_size(const TextureContainer& container)
+{
+	uint64_t size = 0;
+
+	for (uint32_t level = 0; level < container.mip_levels; level++)
+	{
+		size += texture_format_get_byte_size(container.format, mip_chain_get_level_size(container.size, level));
+	}
+
+	return size;
+}
+
+static uint32_t read_u32(const std::vector<uint8_t>& file, uint64_t offset)
+{
+	uint32_t value;
+	memcpy(&value, file.data() + offset, sizeof(value));
+
+	return value;
+}
+
+static uint64_t read_u64(const std::vector<uint8_t>& file, uint64_t offset)
+{
+	uint64_t value;
+	memcpy(&value, file.data() + offset, sizeof(value));
+
+	return value;
+}
+
+}
@@ -0,0 +1,80 @@
+#include "math/bounds.hpp"
+
+#include "math/math.hpp"
+
+namespace lise
+{
+
+AABB AABB::from_vertices(const vertex* vertices, size_t count)
+{
+	if (count == 0)
+	{
+		return AABB { LVEC3_ZERO, LVEC3_ZERO };
+	}
+
+	AABB out = { vertices[0].position, vertices[0].position };
+
+	for (size_t i = 1; i < count; i++)
+	{
+		const vector3f& p = vertices[i].position;
+
+		out.min.x = lise::min(out.min.x, p.x);
+		out.min.y = lise::min(out.min.y, p.y);
+		out.min.z = lise::min(out.min.z, p.z);
+
+		out.max.x = lise::max(out.max.x, p.x);
+		out.max.y = lise::max(out.max.y, p.y);
+		out.max.z = lise::max(out.max.z, p.z);
+	}
+
+	return out;
+}
+
+BoundingSphere BoundingSphere::from_vertices(const vertex* vertices, size_t count, const AABB& bounds)
+{
+	BoundingSphere out;
+
+	out.center.x = (bounds.min.x + bounds.max.x) * 0.5f;
+	out.center.y = (bounds.min.y + bounds.max.y) * 0.5f;
+	out.center.z = (bounds.min.z + bounds.max.z) * 0.5f;
+
+	// The furthest vertex from the center. Tighter than half the diagonal of the box for most meshes.
+	float radius_squared = 0.0f;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		vector3f d = {
+			vertices[i].position.x - out.center.x,
+			vertices[i].position.y - out.center.y,
+			vertices[i].position.z - out.center.z
+		};
+
+		radius_squared = lise::max(radius_squared, d.length_squared());
+	}
+
+	out.radius = lise::sqrt(radius_squared);
+
+	return out;
+}
+
+BoundingSphere BoundingSphere::transformed(const mat4x4& model) const
+{
+	const float* m = model.data;
+
+	BoundingSphere out;
+
+	out.center.x = m[0] * center.x + m[4] * center.y + m[8] * center.z + m[12];
+	out.center.y = m[1] * center.x + m[5] * center.y + m[9] * center.z + m[13];
+	out.center.z = m[2] * center.x + m[6] * center.y + m[10] * center.z + m[14];
+
+	// The length of the longest basis vector is the largest scale of the matrix.
+	float scale_x = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+	float scale_y = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+	float scale_z = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+
+	out.radius = radius * lise::sqrt(lise::max(scale_x, lise::max(scale_y, scale_z)));
+
+	return out;
+}
+
+}
@@ -0,0 +1,176 @@
+#include "math/frustum.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "math/math.hpp"
+
+namespace lise
+{
+
+static vector4f normalize_plane(float x, float y, float z, float w);
+
+Frustum Frustum::from_matrix(const mat4x4& view_projection)
+{
+	// The matrix is column major, row r of the clip space transform is made up of m[r], m[4 + r], m[8 + r] and
+	// m[12 + r]. The planes are combinations of the fourth row with one of the other rows (Gribb & Hartmann). The clip
+	// space depth ranges from -w to w, as in the projection built by mat4x4::perspective.
+	const float* m = view_projection.data;
+
+	Frustum out;
+
+	out.planes[0] = normalize_plane(m[3] + m[0], m[7] + m[4], m[11] + m[8], m[15] + m[12]);
+	out.planes[1] = normalize_plane(m[3] - m[0], m[7] - m[4], m[11] - m[8], m[15] - m[12]);
+	out.planes[2] = normalize_plane(m[3] + m[1], m[7] + m[5], m[11] + m[9], m[15] + m[13]);
+	out.planes[3] = normalize_plane(m[3] - m[1], m[7] - m[5], m[11] - m[9], m[15] - m[13]);
+	out.planes[4] = normalize_plane(m[3] + m[2], m[7] + m[6], m[11] + m[10], m[15] + m[14]);
+	out.planes[5] = normalize_plane(m[3] - m[2], m[7] - m[6], m[11] - m[10], m[15] - m[14]);
+
+	return out;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		const vector4f& p = planes[i];
+
+		float distance = p.x * sphere.center.x + p.y * sphere.center.y + p.z * sphere.center.z + p.w;
+
+		if (distance < -sphere.radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Frustum::intersects(const AABB& box) const
+{
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		const vector4f& p = planes[i];
+
+		// Test the corner of the box that lies furthest along the normal of the plane.
+		float x = p.x >= 0.0f ? box.max.x : box.min.x;
+		float y = p.y >= 0.0f ? box.max.y : box.min.y;
+		float z = p.z >= 0.0f ? box.max.z : box.min.z;
+
+		if (p.x * x + p.y * y + p.z * z + p.w < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t frustum_cull_spheres(
+	const Frustum& frustum,
+	const float* x,
+	const float* y,
+	const float* z,
+	const float* radius,
+	uint32_t count,
+	uint8_t* out_visible
+)
+{
+	uint32_t visible_count = 0;
+	uint32_t i = 0;
+
+#if defined(__AVX__)
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 sx = _mm256_loadu_ps(x + i);
+		__m256 sy = _mm256_loadu_ps(y + i);
+		__m256 sz = _mm256_loadu_ps(z + i);
+		__m256 neg_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (uint32_t p = 0; p < 6; p++)
+		{
+			const vector4f& plane = frustum.planes[p];
+
+			__m256 distance = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(sx, _mm256_set1_ps(plane.x)), _mm256_mul_ps(sy, _mm256_set1_ps(plane.y))),
+				_mm256_add_ps(_mm256_mul_ps(sz, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w))
+			);
+
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, neg_radius, _CMP_GE_OQ));
+		}
+
+		uint32_t mask = _mm256_movemask_ps(inside);
+
+		for (uint32_t j = 0; j < 8; j++)
+		{
+			out_visible[i + j] = (mask >> j) & 1;
+		}
+
+		visible_count += __builtin_popcount(mask);
+	}
+#elif defined(__SSE__)
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 sx = _mm_loadu_ps(x + i);
+		__m128 sy = _mm_loadu_ps(y + i);
+		__m128 sz = _mm_loadu_ps(z + i);
+		__m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+		__m128 inside = _mm_cmpeq_ps(sx, sx);
+
+		for (uint32_t p = 0; p < 6; p++)
+		{
+			const vector4f& plane = frustum.planes[p];
+
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(plane.x)), _mm_mul_ps(sy, _mm_set1_ps(plane.y))),
+				_mm_add_ps(_mm_mul_ps(sz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w))
+			);
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_radius));
+		}
+
+		uint32_t mask = _mm_movemask_ps(inside);
+
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			out_visible[i + j] = (mask >> j) & 1;
+		}
+
+		visible_count += __builtin_popcount(mask);
+	}
+#endif
+
+	// The remaining spheres, or all of them on targets without SIMD support.
+	for (; i < count; i++)
+	{
+		BoundingSphere sphere = { { x[i], y[i], z[i] }, radius[i] };
+
+		out_visible[i] = frustum.intersects(sphere);
+
+		visible_count += out_visible[i];
+	}
+
+	return visible_count;
+}
+
+// Static helper functions.
+static vector4f normalize_plane(float x, float y, float z, float w)
+{
+	float length = lise::sqrt(x * x + y * y + z * z);
+
+	vector4f out;
+	out.x = x / length;
+	out.y = y / length;
+	out.z = z / length;
+	out.w = w / length;
+
+	return out;
+}
+
+}
@@ -308,6 +308,13 @@ double platform_get_absolute_time()
 	return now.tv_sec + now.tv_nsec * 0.000000001;
 }
 
+uint64_t platform_get_absolute_time_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
 void platform_sleep(uint64_t ms)
 {
 #if _POSIX_C_SOURCE >= 199309L
@@ -163,11 +163,41 @@ void platform_console_write_error(const char *message, uint8_t colour)
 
 double platform_get_absolute_time()
 {
+	// The clock frequency is set up by `platform_init`, which never gets called when the engine runs headless.
+	if (clock_frequency == 0.0)
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		clock_frequency = 1.0 / (double) freq.QuadPart;
+	}
+
 	LARGE_INTEGER now_time;
 	QueryPerformanceCounter(&now_time);
 	return (double) now_time.QuadPart * clock_frequency;
 }
 
+uint64_t platform_get_absolute_time_ns()
+{
+	static uint64_t ticks_per_second = 0;
+
+	if (ticks_per_second == 0)
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		ticks_per_second = freq.QuadPart;
+	}
+
+	LARGE_INTEGER now_time;
+	QueryPerformanceCounter(&now_time);
+
+	// Split the conversion into whole seconds and the remainder, so the multiplication can not overflow.
+	uint64_t ticks = now_time.QuadPart;
+	uint64_t seconds = ticks / ticks_per_second;
+	uint64_t remainder = ticks % ticks_per_second;
+
+	return seconds * 1000000000ull + remainder * 1000000000ull / ticks_per_second;
+}
+
 void platform_sleep(uint64_t ms)
 {
 	Sleep(ms);
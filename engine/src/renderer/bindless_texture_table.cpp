@@ -0,0 +1,168 @@
+#include "renderer/bindless_texture_table.hpp"
+
+#include <algorithm>
+
+#include <simple-logger.hpp>
+
+namespace lise
+{
+
+bool BindlessTextureTable::is_supported(const Device* device)
+{
+	return device->is_descriptor_indexing_enabled;
+}
+
+std::unique_ptr<BindlessTextureTable> BindlessTextureTable::create(const Device* device)
+{
+	if (!is_supported(device))
+	{
+		sl::log_error("Failed to create the bindless texture table, descriptor indexing is not enabled.");
+		return nullptr;
+	}
+
+	auto out = std::make_unique<BindlessTextureTable>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->used_count = 0;
+
+	// Stay within the limits for descriptors that are updated after bind.
+	auto& properties = device->physical_device_properties;
+
+	vk::PhysicalDeviceVulkan12Properties vulkan12_properties;
+	vk::PhysicalDeviceProperties2 properties2;
+	properties2.pNext = &vulkan12_properties;
+
+	device->physical_device.getProperties2(&properties2);
+
+	out->capacity = std::min<uint32_t>({
+		LBINDLESS_TEXTURE_TABLE_CAPACITY,
+		properties.limits.maxPerStageDescriptorSamplers,
+		properties.limits.maxPerStageDescriptorSampledImages,
+		vulkan12_properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+		vulkan12_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		vulkan12_properties.maxDescriptorSetUpdateAfterBindSamplers,
+		vulkan12_properties.maxDescriptorSetUpdateAfterBindSampledImages
+	});
+
+	// Create the descriptor set layout.
+	vk::DescriptorSetLayoutBinding binding(
+		0,
+		vk::DescriptorType::eCombinedImageSampler,
+		out->capacity,
+		vk::ShaderStageFlagBits::eFragment
+	);
+
+	vk::DescriptorBindingFlags binding_flags =
+		vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind;
+
+	vk::DescriptorSetLayoutBindingFlagsCreateInfo binding_flags_ci(1, &binding_flags);
+
+	vk::DescriptorSetLayoutCreateInfo layout_ci(
+		vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+		1,
+		&binding
+	);
+
+	layout_ci.pNext = &binding_flags_ci;
+
+	vk::Result r;
+
+	std::tie(r, out->descriptor_set_layout) = device->logical_device.createDescriptorSetLayout(layout_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the bindless texture descriptor set layout.");
+		return nullptr;
+	}
+
+	// Create the descriptor pool.
+	vk::DescriptorPoolSize pool_size(vk::DescriptorType::eCombinedImageSampler, out->capacity);
+
+	vk::DescriptorPoolCreateInfo pool_ci(
+		vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
+		1,
+		1,
+		&pool_size
+	);
+
+	std::tie(r, out->descriptor_pool) = device->logical_device.createDescriptorPool(pool_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the bindless texture descriptor pool.");
+		return nullptr;
+	}
+
+	// Allocate the descriptor set.
+	vk::DescriptorSetAllocateInfo set_ai(out->descriptor_pool, 1, &out->descriptor_set_layout);
+
+	std::vector<vk::DescriptorSet> sets;
+
+	std::tie(r, sets) = device->logical_device.allocateDescriptorSets(set_ai);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to allocate the bindless texture descriptor set.");
+		return nullptr;
+	}
+
+	out->descriptor_set = sets[0];
+
+	sl::log_debug("Created a bindless texture table with {} elements.", out->capacity);
+
+	return out;
+}
+
+BindlessTextureTable::~BindlessTextureTable()
+{
+	// Destroying the pool frees the descriptor set.
+	device->logical_device.destroy(descriptor_pool);
+	device->logical_device.destroy(descriptor_set_layout);
+}
+
+uint32_t BindlessTextureTable::register_texture(vk::ImageView image_view, vk::Sampler sampler)
+{
+	uint32_t index;
+
+	if (!free_indices.empty())
+	{
+		index = free_indices.back();
+		free_indices.pop_back();
+	}
+	else if (used_count < capacity)
+	{
+		index = used_count++;
+	}
+	else
+	{
+		sl::log_error("The bindless texture table is full, it can hold at most {} textures.", capacity);
+		return UINT32_MAX;
+	}
+
+	vk::DescriptorImageInfo image_info(sampler, image_view, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+	vk::WriteDescriptorSet write;
+	write.dstSet = descriptor_set;
+	write.dstBinding = 0;
+	write.dstArrayElement = index;
+	write.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+	write.descriptorCount = 1;
+	write.pImageInfo = &image_info;
+
+	device->logical_device.updateDescriptorSets(1, &write, 0, nullptr);
+
+	return index;
+}
+
+void BindlessTextureTable::release(uint32_t index)
+{
+	if (index >= used_count)
+	{
+		return;
+	}
+
+	free_indices.push_back(index);
+}
+
+}
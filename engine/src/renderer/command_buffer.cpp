@@ -55,10 +55,16 @@ void CommandBuffer::reset()
 	state = CommandBufferState::READY;
 }
 
-bool CommandBuffer::begin(bool is_single_use, bool is_render_pass_continue, bool is_simultaneous_use)
+bool CommandBuffer::begin(
+	bool is_single_use,
+	bool is_render_pass_continue,
+	bool is_simultaneous_use,
+	const vk::CommandBufferInheritanceInfo* inheritance_info
+)
 {
 	vk::CommandBufferBeginInfo begin_info = {};
 	begin_info.sType = vk::StructureType::eCommandBufferBeginInfo;
+	begin_info.pInheritanceInfo = inheritance_info;
 
 	if (is_single_use) {
 		begin_info.flags |= vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
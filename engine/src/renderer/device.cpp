@@ -1,16 +1,43 @@
 #include "renderer/device.hpp"
 
 #include <memory>
+#include <cstdio>
 #include <cstring>
 #include <stdexcept>
 
 #include <simple-logger.hpp>
 
+#include "math/crc.hpp"
+
 #define AMD_VENDOR_ID 0x1002
 
+#define PIPELINE_CACHE_MAGIC 0x4843504C // "LPCH"
+#define PIPELINE_CACHE_VERSION 1
+
 namespace lise
 {
 
+/**
+ * @brief Precedes the pipeline cache data in the pipeline cache file. The cache is only used if it was written by the
+ * same device and driver, and its data is intact.
+ */
+struct PipelineCacheFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint32_t driver_version;
+	uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
+
+	uint64_t data_size;
+	uint64_t data_crc;
+};
+
+static std::vector<uint8_t> read_pipeline_cache_file(const vk::PhysicalDeviceProperties& properties);
+static PipelineCacheFileHeader make_pipeline_cache_header(const vk::PhysicalDeviceProperties& properties);
+
 std::unique_ptr<Device> Device::create(
 	vk::Instance instance,
 	std::span<std::string> physical_device_extensions,
@@ -72,8 +99,44 @@ std::unique_ptr<Device> Device::create(
 		);
 	}
 
-	// Request features
-	vk::PhysicalDeviceFeatures device_features = {};
+	// Request features. Indirect draws are optional, the renderer falls back to direct draws without them. Textures
+	// in compressed formats the device cannot sample are decoded on the CPU.
+	out->enabled_features = vk::PhysicalDeviceFeatures();
+	out->enabled_features.multiDrawIndirect = out->physical_device_features.multiDrawIndirect;
+	out->enabled_features.drawIndirectFirstInstance = out->physical_device_features.drawIndirectFirstInstance;
+	out->enabled_features.textureCompressionBC = out->physical_device_features.textureCompressionBC;
+	out->enabled_features.textureCompressionETC2 = out->physical_device_features.textureCompressionETC2;
+
+	vk::PhysicalDeviceVulkan12Features vulkan12_features;
+
+	if (out->physical_device_properties.apiVersion >= VK_API_VERSION_1_2)
+	{
+		auto supported_features = out->physical_device.getFeatures2<
+			vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceVulkan12Features
+		>();
+
+		auto& supported_vulkan12_features = supported_features.get<vk::PhysicalDeviceVulkan12Features>();
+
+		vulkan12_features.drawIndirectCount = supported_vulkan12_features.drawIndirectCount;
+
+		// Bindless textures are only used if every feature they rely on is supported.
+		bool is_descriptor_indexing_supported =
+			supported_vulkan12_features.descriptorIndexing &&
+			supported_vulkan12_features.runtimeDescriptorArray &&
+			supported_vulkan12_features.descriptorBindingPartiallyBound &&
+			supported_vulkan12_features.descriptorBindingSampledImageUpdateAfterBind &&
+			supported_vulkan12_features.shaderSampledImageArrayNonUniformIndexing;
+
+		vulkan12_features.descriptorIndexing = is_descriptor_indexing_supported;
+		vulkan12_features.runtimeDescriptorArray = is_descriptor_indexing_supported;
+		vulkan12_features.descriptorBindingPartiallyBound = is_descriptor_indexing_supported;
+		vulkan12_features.descriptorBindingSampledImageUpdateAfterBind = is_descriptor_indexing_supported;
+		vulkan12_features.shaderSampledImageArrayNonUniformIndexing = is_descriptor_indexing_supported;
+	}
+
+	out->is_draw_indirect_count_enabled = vulkan12_features.drawIndirectCount;
+	out->is_descriptor_indexing_enabled = vulkan12_features.descriptorIndexing;
 
 	// Create device
 	// Convert string array to char* array.
@@ -94,9 +157,15 @@ std::unique_ptr<Device> Device::create(
 		nullptr,
 #endif
 		pde_chars,
-		&device_features
+		&out->enabled_features
 	);
 
+	// Vulkan 1.2 features can only be enabled on Vulkan 1.2 devices.
+	if (out->physical_device_properties.apiVersion >= VK_API_VERSION_1_2)
+	{
+		create_info.pNext = &vulkan12_features;
+	}
+
 	vk::Result r;
 
 	std::tie(r, out->logical_device) = out->physical_device.createDevice(create_info);
@@ -128,9 +197,119 @@ std::unique_ptr<Device> Device::create(
 		return nullptr;
 	}
 
+	// Create the transfer command pool
+	vk::CommandPoolCreateInfo transfer_pool_ci(
+		vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient,
+		out->queue_indices.transfer_queue_index
+	);
+
+	std::tie(r, out->transfer_command_pool) = out->logical_device.createCommandPool(transfer_pool_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the transfer command pool.");
+
+		return nullptr;
+	}
+
+	if (out->has_dedicated_transfer_queue())
+	{
+		sl::log_info("Using queue family {} for transfers.", out->queue_indices.transfer_queue_index);
+	}
+
+	// Create the memory allocator
+	out->allocator = MemoryAllocator::create(out.get());
+
+	out->sampler_cache = SamplerCache::create(out.get());
+
+	// Create the pipeline cache, seeded with the pipelines of previous runs.
+	std::vector<uint8_t> pipeline_cache_data = read_pipeline_cache_file(out->physical_device_properties);
+
+	vk::PipelineCacheCreateInfo pipeline_cache_ci({}, pipeline_cache_data.size(), pipeline_cache_data.data());
+
+	std::tie(r, out->pipeline_cache) = out->logical_device.createPipelineCache(pipeline_cache_ci);
+
+	if (r != vk::Result::eSuccess && !pipeline_cache_data.empty())
+	{
+		sl::log_warn("Failed to create the pipeline cache from `{}`, starting empty.", LDEVICE_PIPELINE_CACHE_PATH);
+
+		pipeline_cache_ci.initialDataSize = 0;
+		pipeline_cache_ci.pInitialData = nullptr;
+
+		std::tie(r, out->pipeline_cache) = out->logical_device.createPipelineCache(pipeline_cache_ci);
+	}
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the pipeline cache.");
+
+		return nullptr;
+	}
+
 	return out;
 }
 
+bool Device::has_dedicated_transfer_queue() const
+{
+	return queue_indices.transfer_queue_index != queue_indices.graphics_queue_index;
+}
+
+bool Device::save_pipeline_cache() const
+{
+	auto [r, data] = logical_device.getPipelineCacheData(pipeline_cache);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to get the pipeline cache data.");
+		return false;
+	}
+
+	PipelineCacheFileHeader header = make_pipeline_cache_header(physical_device_properties);
+	header.data_size = data.size();
+	header.data_crc = hash_crc64(0, reinterpret_cast<const char*>(data.data()), data.size());
+
+	// Write to a temporary file first, so the previous cache stays intact if writing gets interrupted.
+	std::string temporary_path = std::string(LDEVICE_PIPELINE_CACHE_PATH) + ".tmp";
+
+	FILE* file = std::fopen(temporary_path.c_str(), "wb");
+
+	if (!file)
+	{
+		sl::log_error("Failed to open `{}` for writing.", temporary_path);
+		return false;
+	}
+
+	bool is_written =
+		std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+		std::fwrite(data.data(), 1, data.size(), file) == data.size();
+
+	is_written = std::fclose(file) == 0 && is_written;
+
+	if (!is_written)
+	{
+		sl::log_error("Failed to write the pipeline cache to `{}`.", temporary_path);
+
+		std::remove(temporary_path.c_str());
+		return false;
+	}
+
+	// Renaming does not replace existing files on every platform.
+	if (std::rename(temporary_path.c_str(), LDEVICE_PIPELINE_CACHE_PATH) != 0)
+	{
+		std::remove(LDEVICE_PIPELINE_CACHE_PATH);
+
+		if (std::rename(temporary_path.c_str(), LDEVICE_PIPELINE_CACHE_PATH) != 0)
+		{
+			sl::log_error("Failed to replace `{}`.", LDEVICE_PIPELINE_CACHE_PATH);
+			return false;
+		}
+	}
+
+	sl::log_info("Wrote {} bytes of pipeline cache to `{}`.", data.size(), LDEVICE_PIPELINE_CACHE_PATH);
+
+	return true;
+}
+
 DeviceSwapChainSupportInfo Device::query_swapchain_support(vk::PhysicalDevice physical_device, vk::SurfaceKHR surface)
 {
 	DeviceSwapChainSupportInfo swapchain_info = {};
@@ -151,8 +330,16 @@ DeviceSwapChainSupportInfo Device::query_swapchain_support(vk::PhysicalDevice ph
 
 Device::~Device()
 {
-	// Destroy graphics command pool
+	// Free all remaining memory blocks
+	allocator.reset();
+
+	sampler_cache.reset();
+
+	logical_device.destroy(pipeline_cache);
+
+	// Destroy command pools
 	logical_device.destroy(graphics_command_pool);
+	logical_device.destroy(transfer_command_pool);
 
 	// Destroy the logical device
 	logical_device.destroy();
@@ -242,6 +429,12 @@ bool Device::is_physical_device_suitable(
 		}
 	}
 
+	// Headless devices do not present, so there is no swapchain support to check.
+	if (!surface)
+	{
+		return true;
+	}
+
 	// Check if swapchain supported by the physcial device is adequate for our needs
 	auto swap_chain_info = query_swapchain_support(physical_device, surface);
 
@@ -271,20 +464,103 @@ DeviceQueueIndices Device::find_queue_families(vk::PhysicalDevice& physical_devi
 			queue_indices.graphics_queue_index = i;
 		}
 
-		auto [_, present_support] = physical_device.getSurfaceSupportKHR(i, surface);
-
-		if (present_support)
+		if (surface)
 		{
-			queue_indices.present_queue_index = i;
+			auto [_, present_support] = physical_device.getSurfaceSupportKHR(i, surface);
+
+			if (present_support)
+			{
+				queue_indices.present_queue_index = i;
+			}
 		}
 
-		if (queue_families[i].queueFlags & vk::QueueFlagBits::eTransfer)
+		// Transfer-only queue families usually map to dedicated copy engines that run alongside rendering.
+		if (queue_families[i].queueFlags & vk::QueueFlagBits::eTransfer &&
+			!(queue_families[i].queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute)))
 		{
 			queue_indices.transfer_queue_index = i;
 		}
 	}
 
+	// Graphics queue families always support transfers, so fall back to the graphics queue.
+	if (queue_indices.transfer_queue_index == UINT32_MAX)
+	{
+		queue_indices.transfer_queue_index = queue_indices.graphics_queue_index;
+	}
+
+	// Without a surface nothing gets presented. Alias the present queue to the graphics queue so the rest of the
+	// renderer does not need to special-case it.
+	if (!surface)
+	{
+		queue_indices.present_queue_index = queue_indices.graphics_queue_index;
+	}
+
 	return queue_indices;
 }
 
+static std::vector<uint8_t> read_pipeline_cache_file(const vk::PhysicalDeviceProperties& properties)
+{
+	FILE* file = std::fopen(LDEVICE_PIPELINE_CACHE_PATH, "rb");
+
+	if (!file)
+	{
+		sl::log_info("No pipeline cache found at `{}`, pipelines will be compiled.", LDEVICE_PIPELINE_CACHE_PATH);
+		return {};
+	}
+
+	std::fseek(file, 0, SEEK_END);
+	long file_size = std::ftell(file);
+	std::fseek(file, 0, SEEK_SET);
+
+	PipelineCacheFileHeader header;
+	PipelineCacheFileHeader expected = make_pipeline_cache_header(properties);
+
+	std::vector<uint8_t> data;
+
+	bool is_valid =
+		std::fread(&header, sizeof(header), 1, file) == 1 &&
+		header.data_size == (uint64_t) file_size - sizeof(header) &&
+		header.magic == expected.magic &&
+		header.version == expected.version &&
+		header.vendor_id == expected.vendor_id &&
+		header.device_id == expected.device_id &&
+		header.driver_version == expected.driver_version &&
+		memcmp(header.pipeline_cache_uuid, expected.pipeline_cache_uuid, VK_UUID_SIZE) == 0;
+
+	if (is_valid)
+	{
+		data.resize(header.data_size);
+
+		is_valid =
+			std::fread(data.data(), 1, data.size(), file) == data.size() &&
+			hash_crc64(0, reinterpret_cast<const char*>(data.data()), data.size()) == header.data_crc;
+	}
+
+	std::fclose(file);
+
+	if (!is_valid)
+	{
+		// Written by another device or driver, or damaged. The driver would reject most of these, but not all.
+		sl::log_info("Ignoring the outdated pipeline cache at `{}`.", LDEVICE_PIPELINE_CACHE_PATH);
+		return {};
+	}
+
+	sl::log_info("Loaded {} bytes of pipeline cache from `{}`.", data.size(), LDEVICE_PIPELINE_CACHE_PATH);
+
+	return data;
+}
+
+static PipelineCacheFileHeader make_pipeline_cache_header(const vk::PhysicalDeviceProperties& properties)
+{
+	PipelineCacheFileHeader header = {};
+	header.magic = PIPELINE_CACHE_MAGIC;
+	header.version = PIPELINE_CACHE_VERSION;
+	header.vendor_id = properties.vendorID;
+	header.device_id = properties.deviceID;
+	header.driver_version = properties.driverVersion;
+	memcpy(header.pipeline_cache_uuid, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+	return header;
+}
+
 }
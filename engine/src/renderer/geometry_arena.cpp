@@ -0,0 +1,384 @@
+#include "renderer/geometry_arena.hpp"
+
+#include <algorithm>
+
+#include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+void GeometryArenaFreeList::reset(uint32_t capacity, uint32_t used)
+{
+	this->capacity = capacity;
+
+	blocks.clear();
+
+	if (used < capacity)
+	{
+		blocks.push_back(GeometryArenaBlock { used, capacity - used });
+	}
+}
+
+std::optional<uint32_t> GeometryArenaFreeList::allocate(uint32_t size)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		GeometryArenaBlock& block = blocks[i];
+
+		if (block.size < size)
+		{
+			continue;
+		}
+
+		uint32_t offset = block.offset;
+
+		block.offset += size;
+		block.size -= size;
+
+		if (block.size == 0)
+		{
+			blocks.erase(blocks.begin() + i);
+		}
+
+		return offset;
+	}
+
+	return {};
+}
+
+void GeometryArenaFreeList::free(uint32_t offset, uint32_t size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	// The first block after the freed range.
+	auto next = std::lower_bound(blocks.begin(), blocks.end(), offset, [](const GeometryArenaBlock& block, uint32_t o)
+	{
+		return block.offset < o;
+	});
+
+	bool merges_previous = next != blocks.begin() && (next - 1)->offset + (next - 1)->size == offset;
+	bool merges_next = next != blocks.end() && offset + size == next->offset;
+
+	if (merges_previous && merges_next)
+	{
+		(next - 1)->size += size + next->size;
+		blocks.erase(next);
+	}
+	else if (merges_previous)
+	{
+		(next - 1)->size += size;
+	}
+	else if (merges_next)
+	{
+		next->offset = offset;
+		next->size += size;
+	}
+	else
+	{
+		blocks.insert(next, GeometryArenaBlock { offset, size });
+	}
+}
+
+uint32_t GeometryArenaFreeList::get_hole_size() const
+{
+	uint32_t hole_size = 0;
+
+	for (const GeometryArenaBlock& block : blocks)
+	{
+		// The block at the end of the buffer is not a hole.
+		if (block.offset + block.size != capacity)
+		{
+			hole_size += block.size;
+		}
+	}
+
+	return hole_size;
+}
+
+std::unique_ptr<GeometryArena> GeometryArena::create(
+	const Device* device,
+	uint32_t vertex_capacity,
+	uint32_t index_capacity
+)
+{
+	auto out = std::make_unique<GeometryArena>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->is_compaction_requested = false;
+	out->is_compaction_deferred = false;
+
+	out->free_vertices.reset(vertex_capacity, 0);
+	out->free_indices.reset(index_capacity, 0);
+
+	if (!out->create_buffers(vertex_capacity, index_capacity, out->vertex_buffer, out->index_buffer))
+	{
+		return nullptr;
+	}
+
+	return out;
+}
+
+bool GeometryArena::allocate(
+	GeometryRange* out_range,
+	const vertex* vertices,
+	uint32_t vertex_count,
+	const uint32_t* indices,
+	uint32_t index_count
+)
+{
+	std::optional<uint32_t> vertex_offset = free_vertices.allocate(vertex_count);
+	std::optional<uint32_t> first_index = free_indices.allocate(index_count);
+
+	if (!vertex_offset || !first_index)
+	{
+		if (vertex_offset)
+		{
+			free_vertices.free(*vertex_offset, vertex_count);
+		}
+
+		if (first_index)
+		{
+			free_indices.free(*first_index, index_count);
+		}
+
+		sl::log_error(
+			"The geometry arena has no room for {} vertices and {} indices.",
+			vertex_count,
+			index_count
+		);
+
+		// The space might be there, just not in one piece.
+		is_compaction_requested = true;
+		is_compaction_deferred = false;
+
+		return false;
+	}
+
+	out_range->vertex_offset = *vertex_offset;
+	out_range->vertex_count = vertex_count;
+	out_range->first_index = *first_index;
+	out_range->index_count = index_count;
+
+	allocations.push_back(out_range);
+
+	// Upload the geometry. Both uploads end up in the same batch.
+	upload_system_upload_buffer(
+		vertex_buffer.get(),
+		(uint64_t) out_range->vertex_offset * sizeof(vertex),
+		(uint64_t) vertex_count * sizeof(vertex),
+		vertices
+	);
+
+	upload_system_upload_buffer(
+		index_buffer.get(),
+		(uint64_t) out_range->first_index * sizeof(uint32_t),
+		(uint64_t) index_count * sizeof(uint32_t),
+		indices
+	);
+
+	return true;
+}
+
+void GeometryArena::free(GeometryRange* range)
+{
+	auto it = std::find(allocations.begin(), allocations.end(), range);
+
+	if (it == allocations.end())
+	{
+		return;
+	}
+
+	*it = allocations.back();
+	allocations.pop_back();
+
+	free_vertices.free(range->vertex_offset, range->vertex_count);
+	free_indices.free(range->first_index, range->index_count);
+
+	is_compaction_deferred = false;
+}
+
+bool GeometryArena::update(CommandBuffer* command_buffer, uint64_t frame_number, uint32_t frames_in_flight)
+{
+	// Destroy retired buffers that are no longer used by any frame in flight.
+	std::erase_if(retired_buffers, [&](const RetiredBuffers& retired)
+	{
+		return frame_number >= retired.frame_number + frames_in_flight;
+	});
+
+	bool is_fragmented =
+		free_vertices.get_hole_size() > free_vertices.capacity * LGEOMETRY_ARENA_COMPACTION_THRESHOLD ||
+		free_indices.get_hole_size() > free_indices.capacity * LGEOMETRY_ARENA_COMPACTION_THRESHOLD;
+
+	if ((!is_fragmented || is_compaction_deferred) && !is_compaction_requested)
+	{
+		return false;
+	}
+
+	is_compaction_requested = false;
+
+	// Back off after a failed compaction, until something changes that might let it succeed.
+	is_compaction_deferred = !compact(command_buffer, frame_number);
+
+	return !is_compaction_deferred;
+}
+
+void GeometryArena::bind(CommandBuffer* command_buffer) const
+{
+	vk::DeviceSize offsets[1] = {0};
+	command_buffer->handle.bindVertexBuffers(0, 1, &vertex_buffer->handle, offsets);
+
+	command_buffer->handle.bindIndexBuffer(index_buffer->handle, 0, vk::IndexType::eUint32);
+}
+
+bool GeometryArena::compact(CommandBuffer* command_buffer, uint64_t frame_number)
+{
+	LPROFILE_FUNCTION();
+
+	// Copy into a new pair of buffers, as the ranges of copies within a single buffer must not overlap.
+	std::unique_ptr<VulkanBuffer> new_vertex_buffer;
+	std::unique_ptr<VulkanBuffer> new_index_buffer;
+
+	if (!create_buffers(free_vertices.capacity, free_indices.capacity, new_vertex_buffer, new_index_buffer))
+	{
+		sl::log_warn("Failed to compact the geometry arena.");
+		return false;
+	}
+
+	// Move every allocation to the end of the previous one.
+	std::vector<vk::BufferCopy> vertex_copies;
+	std::vector<vk::BufferCopy> index_copies;
+
+	vertex_copies.reserve(allocations.size());
+	index_copies.reserve(allocations.size());
+
+	uint32_t vertex_head = 0;
+	uint32_t index_head = 0;
+
+	for (GeometryRange* range : allocations)
+	{
+		if (range->vertex_count > 0)
+		{
+			vertex_copies.push_back(vk::BufferCopy(
+				(uint64_t) range->vertex_offset * sizeof(vertex),
+				(uint64_t) vertex_head * sizeof(vertex),
+				(uint64_t) range->vertex_count * sizeof(vertex)
+			));
+		}
+
+		if (range->index_count > 0)
+		{
+			index_copies.push_back(vk::BufferCopy(
+				(uint64_t) range->first_index * sizeof(uint32_t),
+				(uint64_t) index_head * sizeof(uint32_t),
+				(uint64_t) range->index_count * sizeof(uint32_t)
+			));
+		}
+
+		// The indices are relative to the vertex offset, so they stay valid.
+		range->vertex_offset = vertex_head;
+		range->first_index = index_head;
+
+		vertex_head += range->vertex_count;
+		index_head += range->index_count;
+	}
+
+	if (!vertex_copies.empty())
+	{
+		command_buffer->handle.copyBuffer(vertex_buffer->handle, new_vertex_buffer->handle, vertex_copies);
+	}
+
+	if (!index_copies.empty())
+	{
+		command_buffer->handle.copyBuffer(index_buffer->handle, new_index_buffer->handle, index_copies);
+	}
+
+	vk::MemoryBarrier barrier(
+		vk::AccessFlagBits::eTransferWrite,
+		vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead
+	);
+
+	command_buffer->handle.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer,
+		vk::PipelineStageFlagBits::eVertexInput,
+		{},
+		1, &barrier,
+		0, nullptr,
+		0, nullptr
+	);
+
+	sl::log_info(
+		"Compacted the geometry arena, reclaimed {} vertices and {} indices.",
+		free_vertices.get_hole_size(),
+		free_indices.get_hole_size()
+	);
+
+	// Frames in flight might still read from the old buffers.
+	retired_buffers.push_back(RetiredBuffers {
+		std::move(vertex_buffer),
+		std::move(index_buffer),
+		frame_number
+	});
+
+	vertex_buffer = std::move(new_vertex_buffer);
+	index_buffer = std::move(new_index_buffer);
+
+	free_vertices.reset(free_vertices.capacity, vertex_head);
+	free_indices.reset(free_indices.capacity, index_head);
+
+	return true;
+}
+
+bool GeometryArena::create_buffers(
+	uint32_t vertex_capacity,
+	uint32_t index_capacity,
+	std::unique_ptr<VulkanBuffer>& out_vertex_buffer,
+	std::unique_ptr<VulkanBuffer>& out_index_buffer
+) const
+{
+	// Create the vertex buffer.
+	out_vertex_buffer = VulkanBuffer::create(
+		device,
+		(uint64_t) vertex_capacity * sizeof(vertex),
+		vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst |
+			vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eDeviceLocal,
+		true
+	);
+
+	if (!out_vertex_buffer)
+	{
+		sl::log_error("Failed to create the vertex buffer of the geometry arena.");
+		return false;
+	}
+
+	// Create the index buffer.
+	out_index_buffer = VulkanBuffer::create(
+		device,
+		(uint64_t) index_capacity * sizeof(uint32_t),
+		vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst |
+			vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eDeviceLocal,
+		true
+	);
+
+	if (!out_index_buffer)
+	{
+		sl::log_error("Failed to create the index buffer of the geometry arena.");
+		return false;
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,311 @@
+#include "renderer/gpu_culler.hpp"
+
+#include <algorithm>
+
+#include <simple-logger.hpp>
+
+namespace lise
+{
+
+/**
+ * @brief The push constants of the cull shader.
+ */
+struct GpuCullPushConstants
+{
+	vector4f planes[6];
+	uint32_t first_object;
+	uint32_t object_count;
+	uint32_t uses_draw_count;
+};
+
+/**
+ * @brief The amount of invocations in a work group of the cull shader.
+ */
+#define LGPU_CULLER_GROUP_SIZE 64
+
+bool GpuCuller::is_supported(const Device* device)
+{
+	return device->enabled_features.multiDrawIndirect && device->enabled_features.drawIndirectFirstInstance;
+}
+
+std::unique_ptr<GpuCuller> GpuCuller::create(
+	const Device* device,
+	const FrameUniformAllocator* uniform_allocator,
+	uint32_t frame_count
+)
+{
+	auto out = std::make_unique<GpuCuller>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->uses_draw_count = device->is_draw_indirect_count_enabled;
+	out->max_draw_command_count = std::min<uint32_t>(
+		device->physical_device_properties.limits.maxDrawIndirectCount,
+		LGPU_CULLER_MAX_OBJECTS
+	);
+
+	vk::Result r;
+
+	// Load the cull shader.
+	out->shader_stage = ShaderStage::create(
+		device,
+		"assets/shaders/builtin.cull.comp.spv",
+		vk::ShaderStageFlagBits::eCompute
+	);
+
+	if (!out->shader_stage)
+	{
+		sl::log_error("Failed to load the cull shader.");
+		return nullptr;
+	}
+
+	// Create the descriptor set layout. The objects, the draw commands and the draw counts.
+	vk::DescriptorSetLayoutBinding bindings[3];
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		bindings[i] = vk::DescriptorSetLayoutBinding(
+			i,
+			vk::DescriptorType::eStorageBuffer,
+			1,
+			vk::ShaderStageFlagBits::eCompute
+		);
+	}
+
+	vk::DescriptorSetLayoutCreateInfo layout_ci({}, 3, bindings);
+
+	std::tie(r, out->descriptor_set_layout) = device->logical_device.createDescriptorSetLayout(layout_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the descriptor set layout of the GPU culler.");
+		return nullptr;
+	}
+
+	// Create the descriptor pool.
+	vk::DescriptorPoolSize pool_size(vk::DescriptorType::eStorageBuffer, 3 * frame_count);
+
+	vk::DescriptorPoolCreateInfo pool_ci({}, frame_count, 1, &pool_size);
+
+	std::tie(r, out->descriptor_pool) = device->logical_device.createDescriptorPool(pool_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the descriptor pool of the GPU culler.");
+		return nullptr;
+	}
+
+	// Create the pipeline.
+	vk::PushConstantRange push_constant_range(vk::ShaderStageFlagBits::eCompute, 0, sizeof(GpuCullPushConstants));
+
+	out->pipeline = Pipeline::create_compute(
+		device,
+		{ out->descriptor_set_layout },
+		out->shader_stage->shader_stage_create_info,
+		{ push_constant_range }
+	);
+
+	if (!out->pipeline)
+	{
+		sl::log_error("Failed to create the pipeline of the GPU culler.");
+		return nullptr;
+	}
+
+	// Create the buffers of every frame.
+	out->command_buffers.resize(frame_count);
+	out->count_buffers.resize(frame_count);
+
+	for (uint32_t i = 0; i < frame_count; i++)
+	{
+		out->command_buffers[i] = VulkanBuffer::create(
+			device,
+			LGPU_CULLER_MAX_OBJECTS * sizeof(vk::DrawIndexedIndirectCommand),
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			true
+		);
+
+		out->count_buffers[i] = VulkanBuffer::create(
+			device,
+			LGPU_CULLER_MAX_DRAWS * sizeof(uint32_t),
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer |
+				vk::BufferUsageFlagBits::eTransferDst,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			true
+		);
+
+		if (!out->command_buffers[i] || !out->count_buffers[i])
+		{
+			sl::log_error("Failed to create the buffers of the GPU culler.");
+			return nullptr;
+		}
+	}
+
+	// Allocate the descriptor sets.
+	std::vector<vk::DescriptorSetLayout> layouts(frame_count, out->descriptor_set_layout);
+
+	vk::DescriptorSetAllocateInfo set_ai(out->descriptor_pool, layouts);
+
+	std::tie(r, out->descriptor_sets) = device->logical_device.allocateDescriptorSets(set_ai);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to allocate the descriptor sets of the GPU culler.");
+		return nullptr;
+	}
+
+	// Point the descriptors to the buffers. The objects are read from the uniform allocator.
+	uint64_t object_range = std::min<uint64_t>(
+		uniform_allocator->buffer->size,
+		device->physical_device_properties.limits.maxStorageBufferRange
+	);
+
+	for (uint32_t i = 0; i < frame_count; i++)
+	{
+		vk::DescriptorBufferInfo buffer_infos[3] = {
+			vk::DescriptorBufferInfo(uniform_allocator->buffer->handle, 0, object_range),
+			vk::DescriptorBufferInfo(out->command_buffers[i]->handle, 0, VK_WHOLE_SIZE),
+			vk::DescriptorBufferInfo(out->count_buffers[i]->handle, 0, VK_WHOLE_SIZE)
+		};
+
+		vk::WriteDescriptorSet write(
+			out->descriptor_sets[i],
+			0,
+			0,
+			3,
+			vk::DescriptorType::eStorageBuffer,
+			nullptr,
+			buffer_infos
+		);
+
+		device->logical_device.updateDescriptorSets(1, &write, 0, nullptr);
+	}
+
+	sl::log_info("Using GPU culling{}.", out->uses_draw_count ? " with draw counts" : "");
+
+	return out;
+}
+
+GpuCuller::~GpuCuller()
+{
+	pipeline.reset();
+
+	if (descriptor_pool)
+	{
+		device->logical_device.destroy(descriptor_pool);
+	}
+
+	if (descriptor_set_layout)
+	{
+		device->logical_device.destroy(descriptor_set_layout);
+	}
+}
+
+void GpuCuller::cull(
+	CommandBuffer* command_buffer,
+	uint32_t frame,
+	const Frustum& frustum,
+	uint32_t first_object,
+	uint32_t object_count,
+	uint32_t draw_count
+)
+{
+	if (uses_draw_count)
+	{
+		// Reset the draw counts, the cull shader increments them.
+		command_buffer->handle.fillBuffer(count_buffers[frame]->handle, 0, draw_count * sizeof(uint32_t), 0);
+
+		vk::MemoryBarrier reset_barrier(
+			vk::AccessFlagBits::eTransferWrite,
+			vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+		);
+
+		command_buffer->handle.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eComputeShader,
+			{},
+			1, &reset_barrier,
+			0, nullptr,
+			0, nullptr
+		);
+	}
+
+	GpuCullPushConstants push_constants;
+
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		push_constants.planes[i] = frustum.planes[i];
+	}
+
+	push_constants.first_object = first_object;
+	push_constants.object_count = object_count;
+	push_constants.uses_draw_count = uses_draw_count;
+
+	pipeline->bind(command_buffer, vk::PipelineBindPoint::eCompute);
+
+	command_buffer->handle.bindDescriptorSets(
+		vk::PipelineBindPoint::eCompute,
+		pipeline->pipeline_layout,
+		0,
+		1,
+		&descriptor_sets[frame],
+		0,
+		nullptr
+	);
+
+	command_buffer->handle.pushConstants(
+		pipeline->pipeline_layout,
+		vk::ShaderStageFlagBits::eCompute,
+		0,
+		sizeof(GpuCullPushConstants),
+		&push_constants
+	);
+
+	command_buffer->handle.dispatch((object_count + LGPU_CULLER_GROUP_SIZE - 1) / LGPU_CULLER_GROUP_SIZE, 1, 1);
+
+	// Make the draw commands and counts visible to the indirect draws.
+	vk::MemoryBarrier cull_barrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead);
+
+	command_buffer->handle.pipelineBarrier(
+		vk::PipelineStageFlagBits::eComputeShader,
+		vk::PipelineStageFlagBits::eDrawIndirect,
+		{},
+		1, &cull_barrier,
+		0, nullptr,
+		0, nullptr
+	);
+}
+
+void GpuCuller::draw(
+	CommandBuffer* command_buffer,
+	uint32_t frame,
+	uint32_t draw_index,
+	uint32_t command_base,
+	uint32_t object_count
+)
+{
+	uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+	if (uses_draw_count)
+	{
+		command_buffer->handle.drawIndexedIndirectCount(
+			command_buffers[frame]->handle,
+			command_base * stride,
+			count_buffers[frame]->handle,
+			draw_index * sizeof(uint32_t),
+			object_count,
+			stride
+		);
+	}
+	else
+	{
+		command_buffer->handle.drawIndexedIndirect(
+			command_buffers[frame]->handle,
+			command_base * stride,
+			object_count,
+			stride
+		);
+	}
+}
+
+}
@@ -0,0 +1,261 @@
+#include "renderer/gpu_timer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+std::unique_ptr<GpuTimer> GpuTimer::create(const Device* device, uint32_t frame_count)
+{
+	auto out = std::make_unique<GpuTimer>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->timestamp_period = device->physical_device_properties.limits.timestampPeriod;
+	out->current_frame = 0;
+	out->frames.resize(frame_count);
+
+	for (auto& frame : out->frames)
+	{
+		frame.is_submitted = false;
+	}
+
+	// Timestamps are only supported if the graphics queue has valid timestamp bits.
+	auto queue_families = device->physical_device.getQueueFamilyProperties();
+	uint32_t valid_bits = queue_families[device->queue_indices.graphics_queue_index].timestampValidBits;
+
+	out->is_supported = valid_bits > 0 && out->timestamp_period > 0.0;
+	out->timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (1ull << valid_bits) - 1;
+
+	if (!out->is_supported)
+	{
+		sl::log_warn("The graphics queue does not support timestamps, GPU timings will not be available.");
+		return out;
+	}
+
+	// Every scope writes two timestamps.
+	vk::QueryPoolCreateInfo query_pool_ci(
+		{},
+		vk::QueryType::eTimestamp,
+		frame_count * LGPU_TIMER_MAX_SCOPES * 2
+	);
+
+	vk::Result r;
+
+	std::tie(r, out->query_pool) = device->logical_device.createQueryPool(query_pool_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the timestamp query pool.");
+		return nullptr;
+	}
+
+	return out;
+}
+
+GpuTimer::~GpuTimer()
+{
+	if (query_pool)
+	{
+		device->logical_device.destroy(query_pool);
+	}
+}
+
+void GpuTimer::begin_frame(CommandBuffer* command_buffer, uint32_t frame)
+{
+	current_frame = frame;
+	open_scopes.clear();
+
+	if (!is_supported)
+	{
+		return;
+	}
+
+	// The fence of this frame has been waited on, so the results of its previous use are available.
+	if (frames[frame].is_submitted)
+	{
+		read_results(frame);
+	}
+
+	frames[frame].names.clear();
+	frames[frame].depths.clear();
+	frames[frame].is_submitted = false;
+
+	command_buffer->handle.resetQueryPool(query_pool, frame * LGPU_TIMER_MAX_SCOPES * 2, LGPU_TIMER_MAX_SCOPES * 2);
+}
+
+void GpuTimer::end_frame(CommandBuffer* command_buffer)
+{
+	if (!is_supported)
+	{
+		return;
+	}
+
+	if (!open_scopes.empty())
+	{
+		sl::log_warn("{} GPU timer scope(s) were not ended before the end of the frame.", open_scopes.size());
+
+		while (!open_scopes.empty())
+		{
+			end_scope(command_buffer);
+		}
+	}
+
+	frames[current_frame].submit_time_ns = profiler_get_time_ns();
+	frames[current_frame].is_submitted = true;
+}
+
+void GpuTimer::begin_scope(CommandBuffer* command_buffer, const char* name)
+{
+	if (!is_supported)
+	{
+		return;
+	}
+
+	FrameQueries& frame = frames[current_frame];
+
+	if (frame.names.size() >= LGPU_TIMER_MAX_SCOPES)
+	{
+		// Still push the scope so the matching end_scope call stays balanced.
+		open_scopes.push_back(UINT32_MAX);
+		return;
+	}
+
+	uint32_t scope = frame.names.size();
+
+	frame.names.push_back(name);
+	frame.depths.push_back(open_scopes.size());
+
+	open_scopes.push_back(scope);
+
+	command_buffer->handle.writeTimestamp(
+		vk::PipelineStageFlagBits::eTopOfPipe,
+		query_pool,
+		(current_frame * LGPU_TIMER_MAX_SCOPES + scope) * 2
+	);
+}
+
+void GpuTimer::end_scope(CommandBuffer* command_buffer)
+{
+	if (!is_supported)
+	{
+		return;
+	}
+
+	if (open_scopes.empty())
+	{
+		sl::log_warn("Attempting to end a GPU timer scope that was never begun.");
+		return;
+	}
+
+	uint32_t scope = open_scopes.back();
+	open_scopes.pop_back();
+
+	if (scope == UINT32_MAX)
+	{
+		return;
+	}
+
+	command_buffer->handle.writeTimestamp(
+		vk::PipelineStageFlagBits::eBottomOfPipe,
+		query_pool,
+		(current_frame * LGPU_TIMER_MAX_SCOPES + scope) * 2 + 1
+	);
+}
+
+double GpuTimer::get_scope_ms(const char* name) const
+{
+	double total = 0.0;
+
+	for (auto& scope : results)
+	{
+		if (scope.depth == 0 && std::strcmp(scope.name, name) == 0)
+		{
+			total += scope.get_duration_ms();
+		}
+	}
+
+	return total;
+}
+
+double GpuTimer::get_frame_ms() const
+{
+	uint64_t end_ns = 0;
+
+	for (auto& scope : results)
+	{
+		end_ns = std::max(end_ns, scope.end_ns);
+	}
+
+	// Scope times are relative to the start of the first scope.
+	return end_ns / 1000000.0;
+}
+
+void GpuTimer::read_results(uint32_t frame)
+{
+	FrameQueries& queries = frames[frame];
+
+	uint32_t query_count = queries.names.size() * 2;
+
+	if (query_count == 0)
+	{
+		return;
+	}
+
+	uint64_t timestamps[LGPU_TIMER_MAX_SCOPES * 2];
+
+	vk::Result r = device->logical_device.getQueryPoolResults(
+		query_pool,
+		frame * LGPU_TIMER_MAX_SCOPES * 2,
+		query_count,
+		sizeof(timestamps),
+		timestamps,
+		sizeof(uint64_t),
+		vk::QueryResultFlagBits::e64
+	);
+
+	// Without the wait flag, eNotReady is returned if any of the results is not available (yet). Keep the previous
+	// results in that case rather than stalling.
+	if (r != vk::Result::eSuccess)
+	{
+		return;
+	}
+
+	uint64_t base = timestamps[0] & timestamp_mask;
+
+	results.clear();
+	results.reserve(queries.names.size());
+
+	for (size_t i = 0; i < queries.names.size(); i++)
+	{
+		uint64_t start = ((timestamps[i * 2] & timestamp_mask) - base) & timestamp_mask;
+		uint64_t end = ((timestamps[i * 2 + 1] & timestamp_mask) - base) & timestamp_mask;
+
+		GpuTimerScope scope;
+		scope.name = queries.names[i];
+		scope.start_ns = (uint64_t) (start * timestamp_period);
+		scope.end_ns = (uint64_t) (end * timestamp_period);
+		scope.depth = queries.depths[i];
+
+		results.push_back(scope);
+	}
+
+#ifdef L_ENABLE_PROFILER
+	// The GPU clock is not the CPU clock, so anchor the first scope at the moment the frame was submitted.
+	for (auto& scope : results)
+	{
+		profiler_record_gpu_zone(
+			scope.name,
+			queries.submit_time_ns + scope.start_ns,
+			queries.submit_time_ns + scope.end_ns
+		);
+	}
+#endif
+}
+
+}
@@ -0,0 +1,392 @@
+#include "renderer/memory_allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include <simple-logger.hpp>
+
+#include "renderer/device.hpp"
+
+namespace lise
+{
+
+static constexpr uint32_t max_order =
+	std::countr_zero(LMEMORY_ALLOCATOR_BLOCK_SIZE / LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE);
+
+static uint32_t get_order(uint64_t size);
+static std::optional<uint64_t> allocate_from_block(MemoryBlock* block, uint32_t order);
+
+std::unique_ptr<MemoryAllocator> MemoryAllocator::create(const Device* device)
+{
+	auto out = std::make_unique<MemoryAllocator>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->dedicated_allocation_count = 0;
+	out->dedicated_bytes = 0;
+
+	return out;
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+	for (auto& block : blocks)
+	{
+		if (block->allocation_count > 0)
+		{
+			sl::log_warn("Destroying a memory block with {} live allocation(s).", block->allocation_count);
+		}
+
+		if (block->mapped_data)
+		{
+			device->logical_device.unmapMemory(block->memory);
+		}
+
+		device->logical_device.freeMemory(block->memory);
+	}
+
+	if (dedicated_allocation_count > 0)
+	{
+		sl::log_warn("Destroying the memory allocator with {} live dedicated allocation(s).", dedicated_allocation_count);
+	}
+}
+
+std::optional<MemoryAllocation> MemoryAllocator::allocate(
+	const vk::MemoryRequirements& requirements,
+	vk::MemoryPropertyFlags property_flags,
+	bool is_linear
+)
+{
+	std::lock_guard lock(mutex);
+
+	int32_t memory_type = find_memory_type(requirements.memoryTypeBits, property_flags);
+
+	if (memory_type == -1)
+	{
+		sl::log_error("Required memory type was not found.");
+		return {};
+	}
+
+	// Buddy ranges are aligned to their own size, so rounding up to the alignment satisfies it.
+	uint64_t size = std::max(requirements.size, requirements.alignment);
+
+	if (size > LMEMORY_ALLOCATOR_BLOCK_SIZE / 2)
+	{
+		return allocate_dedicated(requirements.size, memory_type);
+	}
+
+	uint32_t order = get_order(size);
+
+	MemoryBlock* block = nullptr;
+	std::optional<uint64_t> offset;
+
+	for (auto& b : blocks)
+	{
+		if (b->memory_type_index != (uint32_t) memory_type || b->is_linear != is_linear)
+		{
+			continue;
+		}
+
+		offset = allocate_from_block(b.get(), order);
+
+		if (offset)
+		{
+			block = b.get();
+			break;
+		}
+	}
+
+	if (!block)
+	{
+		block = create_block(memory_type, is_linear);
+
+		if (!block)
+		{
+			return {};
+		}
+
+		offset = allocate_from_block(block, order);
+	}
+
+	block->allocation_count++;
+	block->used_bytes += requirements.size;
+	block->allocated_bytes += LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE << order;
+
+	MemoryAllocation allocation;
+	allocation.memory = block->memory;
+	allocation.offset = *offset;
+	allocation.size = requirements.size;
+	allocation.memory_size = LMEMORY_ALLOCATOR_BLOCK_SIZE;
+	allocation.mapped_data = block->mapped_data ? static_cast<uint8_t*>(block->mapped_data) + *offset : nullptr;
+	allocation.memory_type_index = memory_type;
+	allocation.property_flags = device->physical_device_memory_properties.memoryTypes[memory_type].propertyFlags;
+	allocation.block = block;
+	allocation.order = order;
+
+	return allocation;
+}
+
+void MemoryAllocator::free(const MemoryAllocation& allocation)
+{
+	std::lock_guard lock(mutex);
+
+	if (!allocation.block)
+	{
+		// Dedicated allocation.
+		if (allocation.mapped_data)
+		{
+			device->logical_device.unmapMemory(allocation.memory);
+		}
+
+		device->logical_device.freeMemory(allocation.memory);
+
+		dedicated_allocation_count--;
+		dedicated_bytes -= allocation.memory_size;
+
+		return;
+	}
+
+	MemoryBlock* block = allocation.block;
+
+	block->allocation_count--;
+	block->used_bytes -= allocation.size;
+	block->allocated_bytes -= LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE << allocation.order;
+
+	// Merge the range with its buddy for as long as the buddy is free.
+	uint64_t offset = allocation.offset;
+	uint32_t order = allocation.order;
+
+	while (order < max_order)
+	{
+		uint64_t buddy = offset ^ (LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE << order);
+
+		auto it = block->free_lists[order].find(buddy);
+
+		if (it == block->free_lists[order].end())
+		{
+			break;
+		}
+
+		block->free_lists[order].erase(it);
+
+		offset = std::min(offset, buddy);
+		order++;
+	}
+
+	block->free_lists[order].insert(offset);
+
+	if (block->allocation_count > 0)
+	{
+		return;
+	}
+
+	// Keep a single empty block of every kind around, so allocating and freeing a single resource does not allocate
+	// and free device memory every time.
+	size_t similar_blocks = std::count_if(blocks.begin(), blocks.end(), [block](const std::unique_ptr<MemoryBlock>& b)
+	{
+		return b->memory_type_index == block->memory_type_index && b->is_linear == block->is_linear;
+	});
+
+	if (similar_blocks > 1)
+	{
+		if (block->mapped_data)
+		{
+			device->logical_device.unmapMemory(block->memory);
+		}
+
+		device->logical_device.freeMemory(block->memory);
+
+		std::erase_if(blocks, [block](const std::unique_ptr<MemoryBlock>& b) { return b.get() == block; });
+	}
+}
+
+MemoryAllocatorStats MemoryAllocator::get_stats() const
+{
+	std::lock_guard lock(mutex);
+
+	MemoryAllocatorStats stats = {};
+
+	stats.block_count = blocks.size();
+	stats.dedicated_allocation_count = dedicated_allocation_count;
+	stats.allocation_count = dedicated_allocation_count;
+	stats.reserved_bytes = blocks.size() * LMEMORY_ALLOCATOR_BLOCK_SIZE + dedicated_bytes;
+	stats.used_bytes = dedicated_bytes;
+	stats.allocated_bytes = dedicated_bytes;
+
+	for (auto& block : blocks)
+	{
+		stats.allocation_count += block->allocation_count;
+		stats.used_bytes += block->used_bytes;
+		stats.allocated_bytes += block->allocated_bytes;
+
+		for (uint32_t order = 0; order <= max_order; order++)
+		{
+			uint64_t range_size = LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE << order;
+
+			stats.free_bytes += block->free_lists[order].size() * range_size;
+
+			if (!block->free_lists[order].empty())
+			{
+				stats.largest_free_range = std::max(stats.largest_free_range, range_size);
+			}
+		}
+	}
+
+	stats.fragmentation = stats.free_bytes > 0 ?
+		1.0f - (float) ((double) stats.largest_free_range / (double) stats.free_bytes) :
+		0.0f;
+
+	return stats;
+}
+
+int32_t MemoryAllocator::find_memory_type(uint32_t type_bits, vk::MemoryPropertyFlags property_flags) const
+{
+	auto& memory_properties = device->physical_device_memory_properties;
+
+	int32_t memory_type = -1;
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if (type_bits & (1 << i) &&
+			(memory_properties.memoryTypes[i].propertyFlags & property_flags) == property_flags &&
+			(static_cast<uint32_t>(
+				memory_properties.memoryTypes[i].propertyFlags &
+				vk::MemoryPropertyFlagBits::eDeviceCoherentAMD
+			) == 0))
+		{
+			memory_type = i;
+		}
+	}
+
+	return memory_type;
+}
+
+MemoryBlock* MemoryAllocator::create_block(uint32_t memory_type_index, bool is_linear)
+{
+	auto block = std::make_unique<MemoryBlock>();
+
+	block->memory_type_index = memory_type_index;
+	block->is_linear = is_linear;
+	block->mapped_data = nullptr;
+	block->allocation_count = 0;
+	block->used_bytes = 0;
+	block->allocated_bytes = 0;
+
+	vk::MemoryAllocateInfo allocate_info(LMEMORY_ALLOCATOR_BLOCK_SIZE, memory_type_index);
+
+	vk::Result r;
+
+	std::tie(r, block->memory) = device->logical_device.allocateMemory(allocate_info);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to allocate a memory block of memory type {}.", memory_type_index);
+		return nullptr;
+	}
+
+	// Map host visible blocks once, so their allocations never have to be mapped.
+	auto property_flags = device->physical_device_memory_properties.memoryTypes[memory_type_index].propertyFlags;
+
+	if (property_flags & vk::MemoryPropertyFlagBits::eHostVisible)
+	{
+		std::tie(r, block->mapped_data) = device->logical_device.mapMemory(block->memory, 0, VK_WHOLE_SIZE, {});
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to map a memory block of memory type {}.", memory_type_index);
+
+			device->logical_device.freeMemory(block->memory);
+			return nullptr;
+		}
+	}
+
+	// The whole block starts out as a single free range.
+	block->free_lists.resize(max_order + 1);
+	block->free_lists[max_order].insert(0);
+
+	blocks.push_back(std::move(block));
+
+	sl::log_debug("Allocated memory block {} of memory type {}.", blocks.size() - 1, memory_type_index);
+
+	return blocks.back().get();
+}
+
+std::optional<MemoryAllocation> MemoryAllocator::allocate_dedicated(uint64_t size, uint32_t memory_type_index)
+{
+	vk::MemoryAllocateInfo allocate_info(size, memory_type_index);
+
+	MemoryAllocation allocation;
+	allocation.offset = 0;
+	allocation.size = size;
+	allocation.memory_size = size;
+	allocation.mapped_data = nullptr;
+	allocation.memory_type_index = memory_type_index;
+	allocation.property_flags = device->physical_device_memory_properties.memoryTypes[memory_type_index].propertyFlags;
+	allocation.block = nullptr;
+	allocation.order = 0;
+
+	vk::Result r;
+
+	std::tie(r, allocation.memory) = device->logical_device.allocateMemory(allocate_info);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to allocate {} bytes of dedicated memory.", size);
+		return {};
+	}
+
+	if (allocation.property_flags & vk::MemoryPropertyFlagBits::eHostVisible)
+	{
+		std::tie(r, allocation.mapped_data) = device->logical_device.mapMemory(allocation.memory, 0, VK_WHOLE_SIZE, {});
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to map dedicated memory.");
+
+			device->logical_device.freeMemory(allocation.memory);
+			return {};
+		}
+	}
+
+	dedicated_allocation_count++;
+	dedicated_bytes += size;
+
+	return allocation;
+}
+
+// Static helper functions.
+static uint32_t get_order(uint64_t size)
+{
+	uint64_t range_size = std::bit_ceil(std::max(size, LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE));
+
+	return std::countr_zero(range_size / LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE);
+}
+
+static std::optional<uint64_t> allocate_from_block(MemoryBlock* block, uint32_t order)
+{
+	// Find the smallest free range that fits.
+	uint32_t j = order;
+
+	while (j <= max_order && block->free_lists[j].empty())
+	{
+		j++;
+	}
+
+	if (j > max_order)
+	{
+		return {};
+	}
+
+	uint64_t offset = *block->free_lists[j].begin();
+	block->free_lists[j].erase(block->free_lists[j].begin());
+
+	// Split the range until it has the requested order, freeing the upper halves.
+	while (j > order)
+	{
+		j--;
+		block->free_lists[j].insert(offset + (LMEMORY_ALLOCATOR_MIN_ALLOCATION_SIZE << j));
+	}
+
+	return offset;
+}
+
+}
@@ -0,0 +1,130 @@
+#include "renderer/mip_chain.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LMIP_CHAIN_USE_SSE2
+#endif
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+static void downsample_level(const uint8_t* source, vector2ui source_size, uint8_t* dest, vector2ui dest_size);
+
+uint32_t mip_chain_get_level_count(vector2ui size)
+{
+	return std::bit_width(std::max(std::max(size.w, size.h), 1u));
+}
+
+vector2ui mip_chain_get_level_size(vector2ui size, uint32_t level)
+{
+	return vector2ui { std::max(size.w >> level, 1u), std::max(size.h >> level, 1u) };
+}
+
+uint64_t mip_chain_get_byte_size(vector2ui size, uint32_t level_count)
+{
+	uint64_t byte_size = 0;
+
+	for (uint32_t level = 0; level < level_count; level++)
+	{
+		vector2ui level_size = mip_chain_get_level_size(size, level);
+
+		byte_size += (uint64_t) level_size.w * level_size.h * 4;
+	}
+
+	return byte_size;
+}
+
+void mip_chain_generate(const uint8_t* pixels, vector2ui size, uint32_t level_count, uint8_t* out_chain)
+{
+	LPROFILE_FUNCTION();
+
+	memcpy(out_chain, pixels, (uint64_t) size.w * size.h * 4);
+
+	uint8_t* source = out_chain;
+	vector2ui source_size = size;
+
+	for (uint32_t level = 1; level < level_count; level++)
+	{
+		uint8_t* dest = source + (uint64_t) source_size.w * source_size.h * 4;
+		vector2ui dest_size = mip_chain_get_level_size(size, level);
+
+		downsample_level(source, source_size, dest, dest_size);
+
+		source = dest;
+		source_size = dest_size;
+	}
+}
+
+// Static helper functions.
+static void downsample_level(const uint8_t* source, vector2ui source_size, uint8_t* dest, vector2ui dest_size)
+{
+	uint64_t source_stride = (uint64_t) source_size.w * 4;
+
+	for (uint32_t y = 0; y < dest_size.h; y++)
+	{
+		// Levels that are a single pixel high average the same row twice.
+		const uint8_t* row0 = source + std::min(y * 2, source_size.h - 1) * source_stride;
+		const uint8_t* row1 = source + std::min(y * 2 + 1, source_size.h - 1) * source_stride;
+
+		uint8_t* out = dest + (uint64_t) y * dest_size.w * 4;
+
+		uint32_t x = 0;
+
+#ifdef LMIP_CHAIN_USE_SSE2
+		// Four destination pixels at a time, from eight pixels of both source rows.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rounding = _mm_set1_epi16(2);
+
+		for (; x + 4 <= dest_size.w && x * 2 + 8 <= source_size.w; x += 4)
+		{
+			__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+			__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+			__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+			__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+			// Widen to 16 bits and add the rows. Every register holds the sums of two horizontally adjacent pixels.
+			__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+			// Add the two pixels of every register, leaving the sum in the low half.
+			s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+			s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+			s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+			s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+			__m128i sum01 = _mm_unpacklo_epi64(s0, s1);
+			__m128i sum23 = _mm_unpacklo_epi64(s2, s3);
+
+			// Divide by four, rounding to nearest, and narrow back to 8 bits.
+			sum01 = _mm_srli_epi16(_mm_add_epi16(sum01, rounding), 2);
+			sum23 = _mm_srli_epi16(_mm_add_epi16(sum23, rounding), 2);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum01, sum23));
+		}
+#endif
+
+		// The remaining pixels, or all of them on targets without SSE2.
+		for (; x < dest_size.w; x++)
+		{
+			const uint8_t* p00 = row0 + std::min(x * 2, source_size.w - 1) * 4;
+			const uint8_t* p01 = row0 + std::min(x * 2 + 1, source_size.w - 1) * 4;
+			const uint8_t* p10 = row1 + std::min(x * 2, source_size.w - 1) * 4;
+			const uint8_t* p11 = row1 + std::min(x * 2 + 1, source_size.w - 1) * 4;
+
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				out[x * 4 + c] = static_cast<uint8_t>((p00[c] + p01[c] + p10[c] + p11[c] + 2) >> 2);
+			}
+		}
+	}
+}
+
+}
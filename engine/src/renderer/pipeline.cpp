@@ -166,7 +166,10 @@ std::unique_ptr<Pipeline> Pipeline::create(
 		-1
 	);
 
-	std::tie(r, out->handle) = out->device->logical_device.createGraphicsPipeline({}, pipeline_create_info);
+	std::tie(r, out->handle) = out->device->logical_device.createGraphicsPipeline(
+		out->device->pipeline_cache,
+		pipeline_create_info
+	);
 
 	if (r != vk::Result::eSuccess)
 	{
@@ -177,6 +180,57 @@ std::unique_ptr<Pipeline> Pipeline::create(
 	return out;
 }
 
+std::unique_ptr<Pipeline> Pipeline::create_compute(
+	const Device* device,
+	const std::vector<vk::DescriptorSetLayout>& descriptor_set_layouts,
+	const vk::PipelineShaderStageCreateInfo& shader_stage,
+	const std::vector<vk::PushConstantRange>& push_constant_ranges
+)
+{
+	auto out = std::make_unique<Pipeline>();
+
+	// Copy trivial data.
+	out->device = device;
+
+	// Pipeline layout
+	vk::PipelineLayoutCreateInfo pipeline_layout_create_info(
+		{},
+		descriptor_set_layouts,
+		push_constant_ranges
+	);
+
+	// Create the pipeline layout.
+	vk::Result r;
+
+	std::tie(r, out->pipeline_layout) = out->device->logical_device.createPipelineLayout(pipeline_layout_create_info);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create pipline layout.");
+		return nullptr;
+	}
+
+	// Pipeline create
+	vk::ComputePipelineCreateInfo pipeline_create_info(
+		{},
+		shader_stage,
+		out->pipeline_layout
+	);
+
+	std::tie(r, out->handle) = out->device->logical_device.createComputePipeline(
+		out->device->pipeline_cache,
+		pipeline_create_info
+	);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create the compute pipeline.");
+		return nullptr;
+	}
+
+	return out;
+}
+
 Pipeline::~Pipeline()
 {
 	if (handle)
@@ -155,7 +155,7 @@ RenderPass::~RenderPass()
 	device->logical_device.destroy(handle);
 }
 
-void RenderPass::begin(CommandBuffer* cb, vk::Framebuffer frame_buffer)
+void RenderPass::begin(CommandBuffer* cb, vk::Framebuffer frame_buffer, vk::SubpassContents contents)
 {
 	vk::RenderPassBeginInfo begin_info(
 		handle,
@@ -200,7 +200,7 @@ void RenderPass::begin(CommandBuffer* cb, vk::Framebuffer frame_buffer)
 
 	begin_info.pClearValues = begin_info.clearValueCount > 0 ? clear_values : nullptr;
 
-	cb->handle.beginRenderPass(begin_info, vk::SubpassContents::eInline);
+	cb->handle.beginRenderPass(begin_info, contents);
 
 	cb->set_state(CommandBufferState::IN_RENDER_PASS);
 }
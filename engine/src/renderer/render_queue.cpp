@@ -0,0 +1,620 @@
+#include "renderer/render_queue.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+template<typename T>
+static uint32_t get_dense_index(std::unordered_map<const T*, uint32_t>& indices, const T* object);
+static uint64_t make_sort_key(
+	RenderLayer layer,
+	uint64_t shader_index,
+	uint64_t instance_index,
+	uint64_t mesh_index,
+	uint16_t depth
+);
+static void radix_sort(std::vector<RenderQueueSortEntry>& entries, std::vector<RenderQueueSortEntry>& scratch);
+
+void RenderQueue::set_camera(const mat4x4& projection, const mat4x4& view, float depth_range)
+{
+	this->view = view;
+	this->depth_range = depth_range;
+
+	frustum = Frustum::from_matrix(view * projection);
+}
+
+void RenderQueue::submit(Mesh* mesh, const mat4x4& model, RenderLayer layer)
+{
+	BoundingSphere sphere = mesh->bounding_sphere.transformed(model);
+
+	items.push_back(RenderQueueItem { mesh, model, layer });
+
+	bounds_x.push_back(sphere.center.x);
+	bounds_y.push_back(sphere.center.y);
+	bounds_z.push_back(sphere.center.z);
+	bounds_radius.push_back(sphere.radius);
+}
+
+void RenderQueue::prepare(
+	CommandBuffer* command_buffer,
+	FrameUniformAllocator* allocator,
+	GpuCuller* gpu_culler,
+	uint32_t current_image
+)
+{
+	LPROFILE_FUNCTION();
+
+	stats = {};
+
+	uint32_t item_count = items.size();
+
+	// The draw commands of all items have to fit in the buffers of the culler.
+	if (item_count > LGPU_CULLER_MAX_OBJECTS)
+	{
+		gpu_culler = nullptr;
+	}
+
+	// Static queues are drawn for many frames, so they have to be drawn in full.
+	if (is_static)
+	{
+		gpu_culler = nullptr;
+	}
+
+	this->gpu_culler = gpu_culler;
+
+	// Allocates memory that stays valid for as long as the queue is drawn.
+	auto allocate = [&](uint64_t size)
+	{
+		return is_static ? allocator->allocate_static(current_image, size) : allocator->allocate(size);
+	};
+
+	{
+		LPROFILE_SCOPE("RenderQueue::cull");
+
+		visible.resize(item_count);
+
+		if (is_static)
+		{
+			std::fill(visible.begin(), visible.end(), 1);
+		}
+		else if (gpu_culler)
+		{
+			// Items with instanced shaders are culled on the GPU, test the rest one by one.
+			for (uint32_t i = 0; i < item_count; i++)
+			{
+				BoundingSphere sphere = { { bounds_x[i], bounds_y[i], bounds_z[i] }, bounds_radius[i] };
+
+				visible[i] = items[i].mesh->shader->is_instanced() || frustum.intersects(sphere);
+
+				stats.culled_items += !visible[i];
+			}
+		}
+		else
+		{
+			uint32_t visible_count = frustum_cull_spheres(
+				frustum,
+				bounds_x.data(),
+				bounds_y.data(),
+				bounds_z.data(),
+				bounds_radius.data(),
+				item_count,
+				visible.data()
+			);
+
+			stats.culled_items = item_count - visible_count;
+		}
+	}
+
+	{
+		LPROFILE_SCOPE("RenderQueue::sort");
+
+		shader_indices.clear();
+		instance_indices.clear();
+		mesh_indices.clear();
+
+		for (uint32_t i = 0; i < item_count; i++)
+		{
+			if (!visible[i])
+			{
+				continue;
+			}
+
+			// The view space depth of the center of the bounds. The camera looks down the negative z axis.
+			float view_depth = -(
+				view.data[2] * bounds_x[i] + view.data[6] * bounds_y[i] + view.data[10] * bounds_z[i] + view.data[14]
+			);
+
+			float normalized_depth = std::clamp(view_depth / depth_range, 0.0f, 1.0f);
+
+			uint16_t depth = static_cast<uint16_t>(normalized_depth * UINT16_MAX);
+
+			const Mesh* mesh = items[i].mesh;
+
+			uint32_t shader_index = get_dense_index(shader_indices, mesh->shader);
+			uint32_t instance_index = get_dense_index(instance_indices, mesh->shader_instance);
+			uint32_t mesh_index = get_dense_index(mesh_indices, mesh);
+
+			// Items whose indices do not fit share key bits with others, which only makes batching less effective.
+			if ((shader_index > 0xFFF || instance_index > 0xFFFF || mesh_index > 0xFFFF) && !has_warned_key_overflow)
+			{
+				sl::log_warn(
+					"The render queue holds more shaders, shader instances or meshes than fit in its sort keys. Draws "
+					"will not be batched optimally."
+				);
+
+				has_warned_key_overflow = true;
+			}
+
+			RenderQueueSortEntry entry;
+			entry.key = make_sort_key(items[i].layer, shader_index, instance_index, mesh_index, depth);
+			entry.index = i;
+
+			sort_entries.push_back(entry);
+		}
+
+		radix_sort(sort_entries, sort_scratch);
+	}
+
+	// The objects culled on the GPU. The objects have to start at a multiple of their size, so allocate an extra
+	// object to leave room for alignment.
+	GpuCullObject* objects = nullptr;
+	uint32_t first_object = 0;
+	uint32_t object_count = 0;
+
+	if (gpu_culler)
+	{
+		uint32_t gpu_item_count = 0;
+
+		for (const RenderQueueSortEntry& entry : sort_entries)
+		{
+			gpu_item_count += items[entry.index].mesh->shader->is_instanced();
+		}
+
+		UniformAllocation allocation = allocator->allocate((uint64_t) (gpu_item_count + 1) * sizeof(GpuCullObject));
+
+		if (allocation.data)
+		{
+			first_object = (allocation.offset + sizeof(GpuCullObject) - 1) / sizeof(GpuCullObject);
+
+			objects = reinterpret_cast<GpuCullObject*>(
+				static_cast<uint8_t*>(allocation.data) + (first_object * sizeof(GpuCullObject) - allocation.offset)
+			);
+		}
+		else
+		{
+			// Draw the items directly instead, without culling them.
+			this->gpu_culler = gpu_culler = nullptr;
+		}
+	}
+
+	// Split the sorted items into batches.
+	uint32_t draw_count = 0;
+
+	size_t batch_begin = 0;
+
+	while (batch_begin < sort_entries.size())
+	{
+		Mesh* mesh = items[sort_entries[batch_begin].index].mesh;
+		Shader* shader = mesh->shader;
+
+		// Indirect draws can draw different meshes, as they share the geometry arena. Stop creating them once the
+		// culler is out of draw counts.
+		bool is_indirect = gpu_culler && shader->is_instanced() && draw_count < LGPU_CULLER_MAX_DRAWS;
+
+		size_t batch_end = batch_begin + 1;
+
+		while (batch_end < sort_entries.size())
+		{
+			// A single indirect draw can not exceed the maxDrawIndirectCount of the device.
+			if (is_indirect && batch_end - batch_begin >= gpu_culler->max_draw_command_count)
+			{
+				break;
+			}
+
+			Mesh* next_mesh = items[sort_entries[batch_end].index].mesh;
+
+			// Bindless shaders read their materials from the per instance data, so an indirect draw can span all items
+			// that share the shader.
+			bool is_same_batch;
+
+			if (!is_indirect)
+			{
+				is_same_batch = next_mesh == mesh;
+			}
+			else if (shader->is_bindless)
+			{
+				is_same_batch = next_mesh->shader == shader;
+			}
+			else
+			{
+				is_same_batch = next_mesh->shader_instance == mesh->shader_instance;
+			}
+
+			if (!is_same_batch)
+			{
+				break;
+			}
+
+			batch_end++;
+		}
+
+		RenderQueueBatch batch = {};
+		batch.mesh = mesh;
+		batch.first_entry = batch_begin;
+		batch.entry_count = batch_end - batch_begin;
+		batch.is_indirect = is_indirect;
+
+		batch_begin = batch_end;
+
+		// Instanced shaders read the per instance data using the instance index, which starts at the first instance.
+		// The data has to start at a multiple of the stride, so allocate an extra element to leave room for alignment.
+		if (shader->is_instanced())
+		{
+			uint32_t stride = shader->per_instance_stride;
+
+			UniformAllocation allocation = allocate((uint64_t) (batch.entry_count + 1) * stride);
+
+			if (!allocation.data)
+			{
+				continue;
+			}
+
+			batch.first_instance = (allocation.offset + stride - 1) / stride;
+
+			uint8_t* instance_data =
+				static_cast<uint8_t*>(allocation.data) + (batch.first_instance * stride - allocation.offset);
+
+			const ShaderUniform* model_uniform = shader->find_per_instance_uniform("model");
+
+			if (model_uniform)
+			{
+				for (uint32_t i = 0; i < batch.entry_count; i++)
+				{
+					memcpy(
+						instance_data + i * stride + model_uniform->offset,
+						&items[sort_entries[batch.first_entry + i].index].model,
+						sizeof(mat4x4)
+					);
+				}
+			}
+
+			if (shader->is_bindless)
+			{
+				for (uint32_t i = 0; i < batch.entry_count; i++)
+				{
+					const Mesh* item_mesh = items[sort_entries[batch.first_entry + i].index].mesh;
+
+					item_mesh->shader_instance->write_material(instance_data + i * stride);
+					item_mesh->shader_instance->last_drawn_frame = allocator->frame_number;
+				}
+			}
+		}
+
+		// Every item of an indirect draw is culled as an object of its own, with a draw command of its own.
+		if (is_indirect)
+		{
+			batch.draw_index = draw_count++;
+			batch.command_base = object_count;
+
+			for (uint32_t i = 0; i < batch.entry_count; i++)
+			{
+				uint32_t index = sort_entries[batch.first_entry + i].index;
+
+				const GeometryRange& geometry = items[index].mesh->geometry;
+
+				GpuCullObject& object = objects[object_count];
+				object.sphere.x = bounds_x[index];
+				object.sphere.y = bounds_y[index];
+				object.sphere.z = bounds_z[index];
+				object.sphere.w = bounds_radius[index];
+				object.index_count = geometry.index_count;
+				object.first_index = geometry.first_index;
+				object.vertex_offset = geometry.vertex_offset;
+				object.first_instance = batch.first_instance + i;
+				object.command_base = batch.command_base;
+				object.command_index = object_count;
+				object.draw_index = batch.draw_index;
+
+				object_count++;
+			}
+		}
+
+		batches.push_back(batch);
+	}
+
+	if (object_count > 0)
+	{
+		gpu_culler->cull(command_buffer, current_image, frustum, first_object, object_count, draw_count);
+	}
+
+	// Update the uniforms (if needed). This has to happen before the descriptor sets get bound, as it can update the
+	// descriptor sets, and before recording, as it allocates from the uniform allocator, which is not thread safe.
+	Shader::Instance* previous_instance = nullptr;
+	uint32_t previous_ubo_offset = 0;
+
+	for (RenderQueueBatch& batch : batches)
+	{
+		Shader::Instance* instance = batch.mesh->shader_instance;
+
+		// Bindless shaders have written their materials into the per instance data already.
+		if (instance->shader->is_bindless)
+		{
+			continue;
+		}
+
+		instance->last_drawn_frame = allocator->frame_number;
+
+		if (!instance->update_ubo(current_image))
+		{
+			batch.is_skipped = true;
+			continue;
+		}
+
+		batch.ubo_offset = instance->ubo_offset;
+
+		// Static queues keep a copy of the ubo of their own, as the copy written by the instance only lasts a frame.
+		if (is_static && instance->ubo)
+		{
+			if (instance == previous_instance)
+			{
+				batch.ubo_offset = previous_ubo_offset;
+				continue;
+			}
+
+			UniformAllocation allocation = allocate(instance->shader->instance_ubo_size);
+
+			if (!allocation.data)
+			{
+				batch.is_skipped = true;
+				continue;
+			}
+
+			memcpy(allocation.data, instance->ubo, instance->shader->instance_ubo_size);
+			batch.ubo_offset = allocation.offset;
+
+			previous_instance = instance;
+			previous_ubo_offset = batch.ubo_offset;
+		}
+	}
+}
+
+RenderQueueStats RenderQueue::flush(CommandBuffer* command_buffer, uint32_t current_image)
+{
+	LPROFILE_FUNCTION();
+
+	stats.add(record(command_buffer, 0, batches.size(), current_image));
+
+	clear();
+
+	return stats;
+}
+
+uint32_t RenderQueue::get_job_count(uint32_t max_job_count) const
+{
+	uint32_t job_count = batches.size() / LRENDER_QUEUE_MIN_BATCHES_PER_JOB;
+
+	return std::clamp<uint32_t>(job_count, 1, std::max<uint32_t>(max_job_count, 1));
+}
+
+RenderQueueStats RenderQueue::record(
+	CommandBuffer* command_buffer,
+	uint32_t first_batch,
+	uint32_t batch_count,
+	uint32_t current_image
+) const
+{
+	LPROFILE_FUNCTION();
+
+	RenderQueueStats recorded = {};
+
+	// The state bound by the previous draw.
+	Shader* bound_shader = nullptr;
+	Shader::Instance* bound_instance = nullptr;
+	GeometryArena* bound_arena = nullptr;
+
+	for (uint32_t b = first_batch; b < first_batch + batch_count; b++)
+	{
+		const RenderQueueBatch& batch = batches[b];
+
+		if (batch.is_skipped)
+		{
+			continue;
+		}
+
+		Mesh* mesh = batch.mesh;
+		Shader* shader = mesh->shader;
+
+		if (shader != bound_shader)
+		{
+			// Binds the pipeline and the global descriptor set.
+			shader->use(command_buffer, current_image);
+
+			bound_shader = shader;
+			bound_instance = nullptr;
+
+			recorded.pipeline_binds++;
+		}
+
+		// Bindless shaders bind their textures along with the pipeline.
+		if (!shader->is_bindless && mesh->shader_instance != bound_instance)
+		{
+			mesh->shader_instance->bind_descriptor_set(command_buffer, current_image, batch.ubo_offset);
+
+			bound_instance = mesh->shader_instance;
+
+			recorded.descriptor_set_binds++;
+		}
+
+		if (mesh->geometry_arena != bound_arena)
+		{
+			mesh->geometry_arena->bind(command_buffer);
+
+			bound_arena = mesh->geometry_arena;
+
+			recorded.buffer_binds++;
+		}
+
+		const GeometryRange& geometry = mesh->geometry;
+
+		if (batch.is_indirect)
+		{
+			gpu_culler->draw(command_buffer, current_image, batch.draw_index, batch.command_base, batch.entry_count);
+
+			recorded.draw_calls++;
+		}
+		else if (shader->is_instanced())
+		{
+			command_buffer->handle.drawIndexed(
+				geometry.index_count,
+				batch.entry_count,
+				geometry.first_index,
+				geometry.vertex_offset,
+				batch.first_instance
+			);
+
+			recorded.draw_calls++;
+		}
+		else
+		{
+			// The shader reads the model matrix from a push constant, so every item needs a draw call of its own.
+			for (uint32_t i = 0; i < batch.entry_count; i++)
+			{
+				command_buffer->handle.pushConstants(
+					shader->pipeline->pipeline_layout,
+					vk::ShaderStageFlagBits::eVertex,
+					0,
+					64,
+					&items[sort_entries[batch.first_entry + i].index].model
+				);
+
+				command_buffer->handle.drawIndexed(
+					geometry.index_count,
+					1,
+					geometry.first_index,
+					geometry.vertex_offset,
+					0
+				);
+			}
+
+			recorded.draw_calls += batch.entry_count;
+		}
+	}
+
+	return recorded;
+}
+
+void RenderQueue::clear()
+{
+	items.clear();
+	sort_entries.clear();
+	batches.clear();
+
+	bounds_x.clear();
+	bounds_y.clear();
+	bounds_z.clear();
+	bounds_radius.clear();
+}
+
+// Static helper functions.
+template<typename T>
+static uint32_t get_dense_index(std::unordered_map<const T*, uint32_t>& indices, const T* object)
+{
+	// New objects get the next index.
+	return indices.try_emplace(object, static_cast<uint32_t>(indices.size())).first->second;
+}
+
+static uint64_t make_sort_key(
+	RenderLayer layer,
+	uint64_t shader_index,
+	uint64_t instance_index,
+	uint64_t mesh_index,
+	uint16_t depth
+)
+{
+	uint64_t layer_bits = static_cast<uint64_t>(layer) & 0xF;
+	uint64_t shader_bits = shader_index & 0xFFF;
+	uint64_t instance_bits = instance_index & 0xFFFF;
+	uint64_t mesh_bits = mesh_index & 0xFFFF;
+
+	if (layer == RenderLayer::TRANSPARENT)
+	{
+		// Draw back to front, the render state only breaks ties.
+		uint64_t inverted_depth = UINT16_MAX - depth;
+
+		return layer_bits << 60 | inverted_depth << 44 | shader_bits << 32 | instance_bits << 16 | mesh_bits;
+	}
+
+	return layer_bits << 60 | shader_bits << 48 | instance_bits << 32 | mesh_bits << 16 | depth;
+}
+
+static void radix_sort(std::vector<RenderQueueSortEntry>& entries, std::vector<RenderQueueSortEntry>& scratch)
+{
+	size_t count = entries.size();
+
+	if (count < 2)
+	{
+		return;
+	}
+
+	scratch.resize(count);
+
+	// Count the occurrences of every byte value of all eight bytes in a single pass.
+	uint32_t histograms[8][256] = {};
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint64_t key = entries[i].key;
+
+		for (uint32_t b = 0; b < 8; b++)
+		{
+			histograms[b][(key >> (b * 8)) & 0xFF]++;
+		}
+	}
+
+	RenderQueueSortEntry* source = entries.data();
+	RenderQueueSortEntry* dest = scratch.data();
+
+	// Least significant byte first. Every pass is stable, so the order of the previous passes is preserved.
+	for (uint32_t b = 0; b < 8; b++)
+	{
+		uint32_t shift = b * 8;
+		uint32_t* histogram = histograms[b];
+
+		// Skip the pass if all keys share the same byte, which is common for the layer and shader bytes.
+		if (histogram[(source[0].key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		// Turn the counts into the first destination index of every byte value.
+		uint32_t offset = 0;
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = histogram[i];
+			histogram[i] = offset;
+			offset += c;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			dest[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+
+		std::swap(source, dest);
+	}
+
+	// An odd amount of passes leaves the sorted entries in the scratch memory.
+	if (source != entries.data())
+	{
+		entries.swap(scratch);
+	}
+}
+
+}
@@ -1,14 +1,16 @@
 #include "renderer/renderer.hpp"
 
 #include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
 #include "renderer/vulkan_backend.hpp"
 
 namespace lise
 {
 
-bool renderer_initialize(const char* consumer_name)
+bool renderer_initialize(const RendererConfig& config)
 {
-	if (!vulkan_initialize(consumer_name))
+	if (!vulkan_initialize(config))
 	{
 		sl::log_fatal("Failed to initialize the vulkan backend.");
 		return false;
@@ -24,6 +26,8 @@ void renderer_shutdown()
 
 bool renderer_draw_frame(float delta_time)
 {
+	LPROFILE_FUNCTION();
+
 	// Begin the frame
 	if (!vulkan_begin_frame(delta_time))
 	{
@@ -1,5 +1,6 @@
 #include "renderer/resource/model.hpp"
 
+#include "core/profiler.hpp"
 #include "renderer/system/texture_system.hpp"
 
 #include <simple-logger.hpp>
@@ -7,8 +8,15 @@
 namespace lise
 {
 	
-std::unique_ptr<Model> Model::create(const Device* device, Shader* shader, const Obj& obj)
+std::unique_ptr<Model> Model::create(
+	const Device* device,
+	GeometryArena* geometry_arena,
+	Shader* shader,
+	const Obj& obj
+)
 {
+	LPROFILE_SCOPE("Model::create");
+
 	auto out = std::make_unique<Model>();
 
 	// Allocate meshes.
@@ -20,22 +28,19 @@ std::unique_ptr<Model> Model::create(const Device* device, Shader* shader, const
 	// Prase meshes.
 	for (uint32_t i = 0; i < obj.meshes.size(); i++)
 	{
-		const Texture* loaded_texture = texture_system_get_or_load(device, obj.meshes[i].material->map_Kd);
-
 		vector3f Kd = obj.meshes[i].material->Kd;
 //		vec4 diffuse_color = (vec4) { Kd.r, Kd.g, Kd.b, 1.0f };
 		vector4f diffuse_color = { 1.0f, 1.0f, 1.0f, 1.0f }; // TODO: Put this back to configurable.
 
 		auto m = Mesh::create(
 			device,
-			device->graphics_command_pool,
-			device->graphics_queue,
+			geometry_arena,
 			shader,
 			obj.meshes[i].name,
 			obj.meshes[i].vertices,
 			obj.meshes[i].indices,
 			diffuse_color,
-			loaded_texture
+			texture_system_get_default_texture()
 		);
 
 		if (!m)
@@ -45,17 +50,41 @@ std::unique_ptr<Model> Model::create(const Device* device, Shader* shader, const
 			return nullptr;
 		}
 
+		// Stream the diffuse texture in, instead of decoding it here. The mesh is drawn with the default texture until
+		// the upload has finished.
+		texture_system_get_or_load_async(device, obj.meshes[i].material->map_Kd, m->shader_instance, 0);
+
 		out->meshes.push_back(std::move(m));
 	}
 
 	return out;
 }
 
-void Model::draw(CommandBuffer* command_buffer, uint32_t current_image)
+std::unique_ptr<Model> Model::clone() const
+{
+	auto out = std::make_unique<Model>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->shader = shader;
+	out->meshes = meshes;
+	out->is_visible = is_visible;
+	out->is_static = is_static;
+
+	out->transform.set_scale(transform.get_scale());
+	out->transform.set_rotation(transform.get_rotation());
+	out->transform.set_position(transform.get_position());
+
+	return out;
+}
+
+void Model::submit(RenderQueue& render_queue) const
 {
+	mat4x4 model = transform.get_transformation_matrix();
+
 	for (size_t i = 0; i < meshes.size(); i++)
 	{
-		meshes[i]->draw(command_buffer, transform.get_transformation_matrix(), current_image);
+		render_queue.submit(meshes[i].get(), model);
 	}
 }
 
@@ -1,9 +1,12 @@
 #include "renderer/resource/shader.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include <simple-logger.hpp>
 
+#include "core/profiler.hpp"
 #include "loader/shader_config_loader.hpp"
 #include "math/vertex.hpp"
 #include "renderer/resource/shader_stage.hpp"
@@ -20,13 +23,16 @@ static uint64_t get_uniform_type_size(ShaderUniformType type);
 static vk::Format parse_attribute_format(std::string type);
 static uint64_t get_attribute_format_size(vk::Format format);
 
+static bool allocate_instance_descriptor_sets(Shader* shader, std::vector<vk::DescriptorSet>& out_descriptor_sets);
+
 std::unique_ptr<Shader> Shader::create(
 	const Device* device,
 	const ShaderConfig& shader_config,
 	const RenderPass* render_pass,
 	uint32_t framebuffer_width,
 	uint32_t framebuffer_height,
-	uint32_t swapchain_image_count
+	uint32_t swapchain_image_count,
+	FrameUniformAllocator* uniform_allocator
 )
 {
 	auto out = std::make_unique<Shader>();
@@ -35,7 +41,18 @@ std::unique_ptr<Shader> Shader::create(
 	out->device = device;
 	out->name = shader_config.name;
 	out->swapchain_image_count = swapchain_image_count;
+	out->uniform_allocator = uniform_allocator;
 	out->minimum_uniform_alignment = device->physical_device_properties.limits.minUniformBufferOffsetAlignment;
+	out->is_bindless = shader_config.is_bindless;
+	out->bindless_table = shader_config.is_bindless ? texture_system_get_bindless_table() : nullptr;
+	out->material_offset = 0;
+	out->texture_index_offset = 0;
+
+	if (out->is_bindless && !out->bindless_table)
+	{
+		sl::log_error("Shader `{}` is bindless, but the device does not support bindless textures.", shader_config.name);
+		return nullptr;
+	}
 
 	// Create the shader stages.
 	std::vector<std::unique_ptr<ShaderStage>> shader_stages;
@@ -93,6 +110,8 @@ std::unique_ptr<Shader> Shader::create(
 	uint64_t local_uniform_total_size = 0;
 	std::vector<ShaderUniform> local_uniforms;
 
+	uint64_t per_instance_total_size = 0;
+
 	for (auto& u : shader_config.uniforms)
 	{
 		ShaderUniform uniform;
@@ -144,15 +163,52 @@ std::unique_ptr<Shader> Shader::create(
 
 			local_uniform_total_size += uniform.size;
 			break;
+		case ShaderScope::PER_INSTANCE:
+			uniform.offset = per_instance_total_size;
+
+			if (uniform.type == ShaderUniformType::SAMPLER)
+			{
+				sl::log_error("Shader `{}` has a per instance sampler, which is not supported.", shader_config.name);
+				return nullptr;
+			}
+
+			out->per_instance_uniforms.push_back(uniform);
+
+			per_instance_total_size += uniform.size;
+			break;
+		default:
+			sl::log_error("Uniform `{}` of shader `{}` has an invalid scope.", u.name, shader_config.name);
+			return nullptr;
 		}
 	}
 
 	out->instance_ubo_size = instance_uniform_total_size;
 	out->global_ubo_size = global_uniform_total_size;
 
+	// Bindless shaders read the instance ubo, followed by the sampler indices, from the per instance data.
+	if (out->is_bindless)
+	{
+		if (per_instance_total_size == 0)
+		{
+			sl::log_error("Shader `{}` is bindless, but has no per instance uniforms.", shader_config.name);
+			return nullptr;
+		}
+
+		out->material_offset = align(per_instance_total_size, 16);
+		out->texture_index_offset = out->material_offset + out->instance_ubo_size;
+
+		per_instance_total_size = out->texture_index_offset + out->instance_samplers.size() * sizeof(uint32_t);
+
+		instance_has_uniform = false;
+		instance_has_sampler = false;
+	}
+
 	out->instance_ubo_stride = align(out->instance_ubo_size, out->minimum_uniform_alignment);
 	out->global_ubo_stride = align(out->global_ubo_size, out->minimum_uniform_alignment);
 
+	// Array elements of std430 structs containing vectors or matrices are aligned to 16 bytes.
+	out->per_instance_stride = per_instance_total_size > 0 ? align(per_instance_total_size, 16) : 0;
+
 	// Create global descriptor set layout.
 	std::vector<vk::DescriptorSetLayoutBinding> global_set_bindings;
 
@@ -168,6 +224,20 @@ std::unique_ptr<Shader> Shader::create(
 		global_set_bindings.push_back(binding);
 	}
 
+	if (out->is_instanced())
+	{
+		// The per instance data of all draws lives in the uniform allocator. Draws select their range using the first
+		// instance, so the descriptor covers the entire buffer and never has to be updated.
+		vk::DescriptorSetLayoutBinding binding(
+			1,
+			vk::DescriptorType::eStorageBuffer,
+			1,
+			vk::ShaderStageFlagBits::eVertex
+		);
+
+		global_set_bindings.push_back(binding);
+	}
+
 	// TODO: Handle global samplers.
 
 	vk::DescriptorSetLayoutCreateInfo global_layout_ci(
@@ -187,13 +257,16 @@ std::unique_ptr<Shader> Shader::create(
 	}
 
 	// Create global descriptor pool.
-	vk::DescriptorPoolSize global_pool_size(vk::DescriptorType::eUniformBuffer, swapchain_image_count * swapchain_image_count);
+	vk::DescriptorPoolSize global_pool_sizes[2] = {
+		vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, swapchain_image_count * swapchain_image_count),
+		vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, swapchain_image_count)
+	};
 
 	vk::DescriptorPoolCreateInfo global_pool_ci(
 		{},
 		swapchain_image_count,
-		1,
-		&global_pool_size
+		out->is_instanced() ? 2 : 1,
+		global_pool_sizes
 	);
 
 	std::tie(r, out->global_descriptor_pool) = out->device->logical_device.createDescriptorPool(global_pool_ci);
@@ -209,9 +282,10 @@ std::unique_ptr<Shader> Shader::create(
 
 	if (instance_has_uniform)
 	{
+		// The instance ubo lives in the uniform allocator, so its location changes every frame.
 		vk::DescriptorSetLayoutBinding binding(
 			instance_set_bindings.size(),
-			vk::DescriptorType::eUniformBuffer,
+			vk::DescriptorType::eUniformBufferDynamic,
 			1,
 			vk::ShaderStageFlagBits::eFragment
 		);
@@ -231,37 +305,31 @@ std::unique_ptr<Shader> Shader::create(
 		instance_set_bindings.push_back(binding);
 	}
 
-	vk::DescriptorSetLayoutCreateInfo instance_layout_ci({}, instance_set_bindings);
+	// Bindless shaders use the layout of the bindless texture table instead, and do not allocate instance sets. The
+	// instance descriptor pools are created once the first instance gets allocated.
+	out->instance_pool_remaining = 0;
 
-	std::tie(r, out->instance_descriptor_set_layout) =
-		out->device->logical_device.createDescriptorSetLayout(instance_layout_ci);
-
-	if (r != vk::Result::eSuccess)
+	if (!out->is_bindless)
 	{
-		sl::log_error("Failed to create instance descriptor set layout.");
-		return nullptr;
-	}
+		vk::DescriptorSetLayoutCreateInfo instance_layout_ci({}, instance_set_bindings);
 
-	std::vector<vk::DescriptorPoolSize> instance_sizes(instance_set_bindings.size());
+		std::tie(r, out->instance_descriptor_set_layout) =
+			out->device->logical_device.createDescriptorSetLayout(instance_layout_ci);
 
-	for (uint64_t i = 0; i < instance_set_bindings.size(); i++)
-	{
-		instance_sizes[i].type = instance_set_bindings[i].descriptorType;
-		instance_sizes[i].descriptorCount = LSHADER_MAX_INSTANCE_COUNT; // TODO: Add caluclation for exact dCount.
-	}
-
-	vk::DescriptorPoolCreateInfo instance_pool_ci(
-		vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-		LSHADER_MAX_INSTANCE_COUNT,
-		instance_sizes
-	);
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to create instance descriptor set layout.");
+			return nullptr;
+		}
 
-	std::tie(r, out->instance_descriptor_pool) = out->device->logical_device.createDescriptorPool(instance_pool_ci);
+		// Every instance has a descriptor set per swapchain image, with a descriptor per binding.
+		out->instance_pool_sizes.resize(instance_set_bindings.size());
 
-	if (r != vk::Result::eSuccess)
-	{
-		sl::log_error("Failed to create instance descriptor pool.");
-		return nullptr;
+		for (uint64_t i = 0; i < instance_set_bindings.size(); i++)
+		{
+			out->instance_pool_sizes[i].type = instance_set_bindings[i].descriptorType;
+			out->instance_pool_sizes[i].descriptorCount = LSHADER_INSTANCE_POOL_PAGE_SIZE * swapchain_image_count;
+		}
 	}
 
 	// Push constants / Local uniforms.
@@ -315,7 +383,7 @@ std::unique_ptr<Shader> Shader::create(
 	// Create pipeline.
 	std::vector<vk::DescriptorSetLayout> set_layouts = {
 		out->global_descriptor_set_layout,
-		out->instance_descriptor_set_layout
+		out->is_bindless ? out->bindless_table->descriptor_set_layout : out->instance_descriptor_set_layout
 	};
 
 	out->pipeline = Pipeline::create(
@@ -345,6 +413,7 @@ std::unique_ptr<Shader> Shader::create(
 		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eUniformBuffer,
 		vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible |
 		vk::MemoryPropertyFlagBits::eHostCoherent,
+		true,
 		true
 	);
 
@@ -388,29 +457,35 @@ std::unique_ptr<Shader> Shader::create(
 		global_descriptor_writes[i].pBufferInfo = &global_descriptor_buffer_infos[i];
 	}
 
-	device->logical_device.updateDescriptorSets(global_descriptor_writes, nullptr);
-
-	// Set global ubos to be dirty.
-	out->global_ubo_dirty.resize(swapchain_image_count, true);
-
-	// Allocate the instance uniform buffer.
-	out->instance_ub = VulkanBuffer::create(
-		device,
-		instance_uniform_total_size * LSHADER_MAX_INSTANCE_COUNT * swapchain_image_count,
-		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eUniformBuffer,
-		vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible |
-		vk::MemoryPropertyFlagBits::eHostCoherent,
-		true
+	// Point the instance storage buffer descriptors to the uniform allocator.
+	uint64_t instance_storage_range = std::min<uint64_t>(
+		uniform_allocator->buffer->size,
+		device->physical_device_properties.limits.maxStorageBufferRange
 	);
 
-	if (!out->instance_ub)
+	vk::DescriptorBufferInfo instance_storage_buffer_info(uniform_allocator->buffer->handle, 0, instance_storage_range);
+
+	if (out->is_instanced())
 	{
-		sl::log_error("Failed to create the object unbiform buffer.");
-		return nullptr;
+		for (uint32_t i = 0; i < swapchain_image_count; i++)
+		{
+			vk::WriteDescriptorSet write;
+			write.dstSet = out->global_descriptor_sets[i];
+			write.dstBinding = 1;
+			write.descriptorType = vk::DescriptorType::eStorageBuffer;
+			write.descriptorCount = 1;
+			write.pBufferInfo = &instance_storage_buffer_info;
+
+			global_descriptor_writes.push_back(write);
+		}
 	}
 
-	// Allocate the instance uniform buffer object free list.
-	out->instance_ubo_free_list.resize(LSHADER_MAX_INSTANCE_COUNT, true);
+	device->logical_device.updateDescriptorSets(global_descriptor_writes, nullptr);
+
+	// Set global ubos to be dirty.
+	out->global_ubo_dirty.resize(swapchain_image_count, true);
+
+	out->instance_slot_count = 0;
 
 	return out;
 }
@@ -418,10 +493,16 @@ std::unique_ptr<Shader> Shader::create(
 Shader::~Shader()
 {
 	instances.clear();
+	free_instance_slots.clear();
 
-	// Destroy the descriptor pools.
+	// Destroy the descriptor pools, which frees all descriptor sets allocated from them. Bindless shaders have no
+	// instance pools, and a null instance layout.
 	device->logical_device.destroy(global_descriptor_pool);
-	device->logical_device.destroy(instance_descriptor_pool);
+
+	for (vk::DescriptorPool pool : instance_descriptor_pools)
+	{
+		device->logical_device.destroy(pool);
+	}
 
 	// Destroy the descriptor set layouts.
 	device->logical_device.destroy(global_descriptor_set_layout);
@@ -430,12 +511,18 @@ Shader::~Shader()
 
 void Shader::use(CommandBuffer* command_buffer, uint32_t current_image)
 {
+	// Bindless shaders bind the texture table along with the global set, and never bind another set afterwards.
+	vk::DescriptorSet sets[2] = {
+		global_descriptor_sets[current_image],
+		is_bindless ? bindless_table->descriptor_set : vk::DescriptorSet()
+	};
+
 	command_buffer->handle.bindDescriptorSets(
 		vk::PipelineBindPoint::eGraphics,
 		pipeline->pipeline_layout,
 		0,
-		1,
-		&global_descriptor_sets[current_image],
+		is_bindless ? 2 : 1,
+		sets,
 		0,
 		nullptr
 	);
@@ -459,11 +546,10 @@ void Shader::update_global_uniforms(uint32_t current_image)
 	// Uniform buffers.
 	if (global_ubo_dirty[current_image])
 	{
-		global_ub->load_data(
-			current_image * global_ubo_stride,
-			global_ubo_size,
-			{},
-			global_ubo
+		memcpy(
+			static_cast<uint8_t*>(global_ub->mapped_data) + current_image * global_ubo_stride,
+			global_ubo,
+			global_ubo_size
 		);
 
 		// Undirty ubo.
@@ -477,32 +563,36 @@ Shader::Instance* Shader::allocate_instance()
 
 	out->shader = this;
 
-	// Iterate the free list and pick a free spot.
-	bool slot_found = false;
-	uint64_t id;
-	for (uint64_t i = 0; i < LSHADER_MAX_INSTANCE_COUNT; i++)
+	// Reuse the slot of a deallocated instance, including its descriptor sets. The sets already point to the uniform
+	// allocator, and their samplers are marked dirty below.
+	if (!free_instance_slots.empty())
+	{
+		InstanceSlot& slot = free_instance_slots.back();
+
+		out->id = slot.id;
+		out->descriptor_sets = std::move(slot.descriptor_sets);
+
+		free_instance_slots.pop_back();
+	}
+	else
 	{
-		if (instance_ubo_free_list[i])
+		// Bindless instances have no descriptor sets, their material is part of the per instance data.
+		if (!is_bindless && !allocate_instance_descriptor_sets(this, out->descriptor_sets))
 		{
-			id = i;
-			slot_found = true;
-			break;
+			sl::log_error("Failed to allocate instance descriptor sets for shader `{}`.", name);
+			return nullptr;
 		}
-	}
 
-	if (!slot_found)
-	{
-		sl::log_error("Failed to find a free slot in the instance uniform buffer of shader `{}`.", name);
-		return nullptr;
+		out->id = instance_slot_count++;
 	}
 
-	// Claim slot.
-	instance_ubo_free_list[id] = false;
-	out->id = id;
+	out->ubo = nullptr;
+	out->ubo_frame_number = UINT64_MAX;
+	out->ubo_offset = 0;
+	out->last_drawn_frame = uniform_allocator->frame_number;
+	out->revision = 0;
 
 	// Allocate arrays.
-	out->ubo_dirty.resize(swapchain_image_count, true);
-
 	if (instance_samplers.size() > 0)
 	{
 		out->samplers.resize(instance_samplers.size(), texture_system_get_default_texture());
@@ -510,71 +600,53 @@ Shader::Instance* Shader::allocate_instance()
 		out->sampler_dirty.resize(swapchain_image_count * instance_samplers.size(), true);
 	}
 
-	// Allocate the descriptor sets.
-	std::vector<vk::DescriptorSetLayout> layouts(swapchain_image_count, instance_descriptor_set_layout);
-
-	vk::DescriptorSetAllocateInfo d_set_ai(
-		instance_descriptor_pool,
-		layouts
-	);
-
-	vk::Result r;
-
-	std::tie(r, out->descriptor_sets) = device->logical_device.allocateDescriptorSets(d_set_ai);
+	uint64_t id = out->id;
 
-	if (r != vk::Result::eSuccess)
-	{
-		sl::log_error("Failed to allocate instance descriptor sets for shader `{}`.", name);
-		return nullptr;
-	}
+	return (*(instances.insert({id, std::move(out)}).first)).second.get();
+}
 
-	// Point the descriptors to the corrosponding location in the uniform buffer.
-	std::vector<vk::DescriptorBufferInfo> instance_descriptor_buffer_infos(swapchain_image_count);
-	std::vector<vk::WriteDescriptorSet> instance_descriptor_writes(swapchain_image_count);
+bool Shader::is_instanced() const
+{
+	return per_instance_uniforms.size() > 0;
+}
 
-	for (uint32_t i = 0; i < swapchain_image_count; i++)
+const ShaderUniform* Shader::find_per_instance_uniform(const std::string& name) const
+{
+	for (auto& uniform : per_instance_uniforms)
 	{
-		instance_descriptor_buffer_infos[i].buffer = instance_ub->handle;
-		instance_descriptor_buffer_infos[i].offset = (swapchain_image_count * id + i) * instance_ubo_stride;
-		instance_descriptor_buffer_infos[i].range = instance_ubo_size;
-
-		instance_descriptor_writes[i].dstSet = out->descriptor_sets[i];
-		instance_descriptor_writes[i].dstBinding = 0;
-		instance_descriptor_writes[i].descriptorType = vk::DescriptorType::eUniformBuffer;
-		instance_descriptor_writes[i].descriptorCount = 1;
-		instance_descriptor_writes[i].pBufferInfo = &instance_descriptor_buffer_infos[i];
+		if (uniform.name == name)
+		{
+			return &uniform;
+		}
 	}
 
-	device->logical_device.updateDescriptorSets(instance_descriptor_writes, nullptr);
-
-	return (*(instances.insert({id, std::move(out)}).first)).second.get();
+	return nullptr;
 }
 
 void Shader::deallocate_instance(uint64_t id)
 {
-	// Return slot to the free list.
-	instance_ubo_free_list[id] = true;
+	auto it = instances.find(id);
 
-	instances.erase(id);
-}
-
-Shader::Instance::~Instance()
-{
-	if (shader)
+	if (it == instances.end())
 	{
-		shader->device->logical_device.free(shader->instance_descriptor_pool, descriptor_sets);
+		sl::log_warn("Attempting to deallocate instance {} of shader `{}`, which is not allocated.", id, name);
+		return;
 	}
+
+	// Return the slot to the free list.
+	free_instance_slots.push_back(InstanceSlot { id, std::move(it->second->descriptor_sets) });
+
+	instances.erase(it);
 }
 
 void Shader::Instance::set_ubo(void* data)
 {
 	ubo = data;
 
-	// Set ubos to be dirty;
-	for (uint64_t i = 0; i < ubo_dirty.size(); i++)
-	{
-		ubo_dirty[i] = true;
-	}
+	// Make sure the new data gets written, even if the ubo has already been written this frame.
+	ubo_frame_number = UINT64_MAX;
+
+	revision++;
 }
 
 void Shader::Instance::set_sampler(uint32_t sampler_index, const Texture* sampler)
@@ -586,25 +658,39 @@ void Shader::Instance::set_sampler(uint32_t sampler_index, const Texture* sample
 	{
 		sampler_dirty[i] = true;
 	}
+
+	revision++;
 }
 
-void Shader::Instance::update_ubo(uint32_t current_image)
+bool Shader::Instance::update_ubo(uint32_t current_image)
 {
-	// Uniform buffer objects.
-	if (ubo_dirty[current_image])
-	{
-		// Uniform is dirty. Update the instance uniform buffer. The descriptors do not need to be updated as they
-		// point to the same address.
-		shader->instance_ub->load_data(
-			(shader->swapchain_image_count * id + current_image) * shader->instance_ubo_stride,
-			shader->instance_ubo_size,
-			{},
-			ubo
-		);
+	LPROFILE_SCOPE("Shader::Instance::update_ubo");
 
-		// Undirty ubo.
-		ubo_dirty[current_image] = false;
+	// Bindless instances write their material into the per instance data instead.
+	if (shader->is_bindless)
+	{
+		return true;
+	}
+
+	// Uniform buffer objects. The regions of the uniform allocator get reused every frame, so the ubo is written
+	// once per frame. The descriptors do not need to be updated, as the location is passed as a dynamic offset.
+	FrameUniformAllocator* allocator = shader->uniform_allocator;
+
+	if (ubo && ubo_frame_number != allocator->frame_number)
+	{
+		UniformAllocation allocation = allocator->allocate(shader->instance_ubo_size);
+
+		// The frame number is left alone on failure, as the offset still points into the region of another frame.
+		if (allocation.data)
+		{
+			memcpy(allocation.data, ubo, shader->instance_ubo_size);
+			ubo_offset = allocation.offset;
+
+			ubo_frame_number = allocator->frame_number;
+		}
 	}
+
+	bool is_ubo_written = !ubo || ubo_frame_number == allocator->frame_number;
 	
 	// Samplers.
 	uint32_t d = 0; // Dirty sampler count.
@@ -626,29 +712,71 @@ void Shader::Instance::update_ubo(uint32_t current_image)
 			instance_descriptor_writes[d].descriptorCount = 1;
 			instance_descriptor_writes[d].pImageInfo = &instance_descriptor_image_infos[d];
 
+			// The descriptor of this image is up to date once the write is issued.
+			sampler_dirty[i * shader->swapchain_image_count + current_image] = false;
+
 			d++;
 		}
 	}
 
 	if (d)
 	{
+		instance_descriptor_writes.resize(d);
+
 		shader->device->logical_device.updateDescriptorSets(instance_descriptor_writes, nullptr);
+
+		// Command buffers that have the set bound are invalidated by the write, so they have to be recorded again.
+		revision++;
 	}
+
+	return is_ubo_written;
 }
 
 void Shader::Instance::bind_descriptor_set(CommandBuffer* command_buffer, uint32_t current_image)
 {
+	bind_descriptor_set(command_buffer, current_image, ubo_offset);
+}
+
+void Shader::Instance::bind_descriptor_set(CommandBuffer* command_buffer, uint32_t current_image, uint32_t ubo_offset)
+{
+	if (shader->is_bindless)
+	{
+		return;
+	}
+
+	// Only shaders with instance uniforms have a dynamic uniform buffer binding.
+	uint32_t dynamic_offset_count = shader->instance_uniforms.size() > 0 ? 1 : 0;
+
 	command_buffer->handle.bindDescriptorSets(
 		vk::PipelineBindPoint::eGraphics,
 		shader->pipeline->pipeline_layout,
 		1,
 		1,
 		&descriptor_sets[current_image],
-		0,
-		0
+		dynamic_offset_count,
+		&ubo_offset
 	);
 }
 
+void Shader::Instance::write_material(uint8_t* per_instance_data) const
+{
+	if (ubo)
+	{
+		memcpy(per_instance_data + shader->material_offset, ubo, shader->instance_ubo_size);
+	}
+	else
+	{
+		memset(per_instance_data + shader->material_offset, 0, shader->instance_ubo_size);
+	}
+
+	uint32_t* texture_indices = reinterpret_cast<uint32_t*>(per_instance_data + shader->texture_index_offset);
+
+	for (uint32_t i = 0; i < samplers.size(); i++)
+	{
+		texture_indices[i] = samplers[i]->bindless_index;
+	}
+}
+
 // Static helper functions.
 static ShaderUniformType parse_uniform_type(const std::string& type)
 {
@@ -807,4 +935,69 @@ static uint64_t get_attribute_format_size(vk::Format format)
 	}
 }
 
+static bool allocate_instance_descriptor_sets(Shader* shader, std::vector<vk::DescriptorSet>& out_descriptor_sets)
+{
+	const Device* device = shader->device;
+
+	vk::Result r;
+
+	// Create a new page once the last one is full.
+	if (shader->instance_pool_remaining == 0)
+	{
+		vk::DescriptorPoolCreateInfo pool_ci(
+			{},
+			LSHADER_INSTANCE_POOL_PAGE_SIZE * shader->swapchain_image_count,
+			shader->instance_pool_sizes
+		);
+
+		vk::DescriptorPool pool;
+
+		std::tie(r, pool) = device->logical_device.createDescriptorPool(pool_ci);
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to create an instance descriptor pool for shader `{}`.", shader->name);
+			return false;
+		}
+
+		shader->instance_descriptor_pools.push_back(pool);
+		shader->instance_pool_remaining = LSHADER_INSTANCE_POOL_PAGE_SIZE;
+	}
+
+	std::vector<vk::DescriptorSetLayout> layouts(shader->swapchain_image_count, shader->instance_descriptor_set_layout);
+
+	vk::DescriptorSetAllocateInfo set_ai(shader->instance_descriptor_pools.back(), layouts);
+
+	std::tie(r, out_descriptor_sets) = device->logical_device.allocateDescriptorSets(set_ai);
+
+	if (r != vk::Result::eSuccess)
+	{
+		return false;
+	}
+
+	shader->instance_pool_remaining--;
+
+	// Point the descriptors to the start of the uniform allocator. The actual location is passed as a dynamic offset
+	// when binding the descriptor set, so these never have to be updated again, not even when the sets get recycled.
+	if (shader->instance_uniforms.size() > 0)
+	{
+		vk::DescriptorBufferInfo buffer_info(shader->uniform_allocator->buffer->handle, 0, shader->instance_ubo_size);
+
+		std::vector<vk::WriteDescriptorSet> writes(shader->swapchain_image_count);
+
+		for (uint32_t i = 0; i < shader->swapchain_image_count; i++)
+		{
+			writes[i].dstSet = out_descriptor_sets[i];
+			writes[i].dstBinding = 0;
+			writes[i].descriptorType = vk::DescriptorType::eUniformBufferDynamic;
+			writes[i].descriptorCount = 1;
+			writes[i].pBufferInfo = &buffer_info;
+		}
+
+		device->logical_device.updateDescriptorSets(writes, nullptr);
+	}
+
+	return true;
+}
+
 }
@@ -1,8 +1,11 @@
 #include "renderer/resource/texture.hpp"
 
+#include <vector>
+
 #include <simple-logger.hpp>
 
-#include "renderer/vulkan_buffer.hpp"
+#include "renderer/mip_chain.hpp"
+#include "renderer/texture_format.hpp"
 
 namespace lise
 {
@@ -15,6 +18,43 @@ std::unique_ptr<Texture> Texture::create(
 	const uint8_t* data,
 	bool has_transparency
 )
+{
+	// The pixel data is always expanded to four channels by the loader, regardless of the channel count of the file.
+	// Minified textures sample from a complete mip chain, which is built on the CPU, as the upload can run on a transfer
+	// queue that does not support blits.
+	uint32_t mip_levels = mip_chain_get_level_count(size);
+
+	std::vector<uint8_t> mip_chain(mip_chain_get_byte_size(size, mip_levels));
+
+	mip_chain_generate(data, size, mip_levels, mip_chain.data());
+
+	auto out = create(
+		device,
+		path,
+		size,
+		vk::Format::eR8G8B8A8Unorm,
+		mip_levels,
+		mip_chain.data(),
+		mip_chain.size()
+	);
+
+	if (out)
+	{
+		out->channel_count = channel_count;
+	}
+
+	return out;
+}
+
+std::unique_ptr<Texture> Texture::create(
+	const Device* device,
+	const std::string& path,
+	vector2ui size,
+	vk::Format format,
+	uint32_t mip_levels,
+	const uint8_t* data,
+	uint64_t data_size
+)
 {
 	auto out = std::make_unique<Texture>();
 
@@ -22,66 +62,48 @@ std::unique_ptr<Texture> Texture::create(
 	out->device = device;
 	out->path = path;
 	out->size = size;
-	out->channel_count = channel_count;
+	out->channel_count = 4;
+	out->bindless_index = 0;
 
-	uint64_t byte_size = size.w * size.h * channel_count;
+	// Block compressed formats can not be rendered to.
+	vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
 
-	// Assume format.
-	vk::Format image_format = vk::Format::eR8G8B8A8Unorm;
-	
-	// Create a staging buffer and load texture data into it.
-	auto staging_buffer = VulkanBuffer::create(
-		device,
-		byte_size,
-		vk::BufferUsageFlagBits::eTransferSrc,
-		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-		true
-	);
-
-	staging_buffer->load_data(0, byte_size, {}, data);
+	if (!texture_format_is_block_compressed(format))
+	{
+		usage |= vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eColorAttachment;
+	}
 
-	// Create the image. A lot of assumptions are made here to work with the PNG format.
 	out->image = Image::create(
 		device,
 		vk::ImageType::e2D,
 		size,
-		image_format,
+		format,
 		vk::ImageTiling::eOptimal,
-		vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled |
-		vk::ImageUsageFlagBits::eColorAttachment,
+		usage,
 		vk::MemoryPropertyFlagBits::eDeviceLocal,
 		true,
-		vk::ImageAspectFlagBits::eColor
+		vk::ImageAspectFlagBits::eColor,
+		mip_levels
 	);
 
-	// Create and begin a temporary buffer.
-	auto temp_buffer = CommandBuffer::create(device, device->graphics_command_pool, true);
-
-	if (!temp_buffer)
+	if (!out->image)
 	{
-		sl::log_error("Failed failed to create temporary command buffer.");
+		sl::log_error("Failed to create an image for the following texture: `{}`.", path);
 		return nullptr;
 	}
 
-	temp_buffer->begin(true, false, false);
-
-	// Transition the image layout from undefined to optimal for receiving data.
-	out->image->transition_layout(temp_buffer.get(), vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-
-	// Copy the data from the staging buffer to the image buffer.
-	out->image->copy_from_buffer(temp_buffer.get(), staging_buffer->handle);
-
-	// Transition the image layout from optimal for receiving data to a shader read only optimal layout.
-	out->image->transition_layout(
-		temp_buffer.get(),
-		vk::ImageLayout::eTransferDstOptimal,
-		vk::ImageLayout::eShaderReadOnlyOptimal
-	);
+	// Copy the data to the image, which also transitions it to a shader read only optimal layout.
+	out->upload_ticket = upload_system_upload_image(out->image.get(), data_size, data);
 
-	// End and submit the temporary command buffer.
-	temp_buffer->end_and_submit_single_use(device->graphics_queue);
+	if (out->upload_ticket == 0)
+	{
+		sl::log_error("Failed to upload the following texture: `{}`.", path);
+		return nullptr;
+	}
 
-	// Create a sampler for the texture.
+	// Textures share their sampler through the sampler cache. The level of detail is not clamped, as the image view
+	// already limits sampling to the mip levels of the texture, so textures with different amounts of mip levels can
+	// share the sampler as well.
 	vk::SamplerCreateInfo sampler_ci(
 		{},
 		vk::Filter::eLinear,
@@ -96,30 +118,20 @@ std::unique_ptr<Texture> Texture::create(
 		vk::False,
 		vk::CompareOp::eAlways,
 		0.0f,
-		0.0f,
+		VK_LOD_CLAMP_NONE,
 		vk::BorderColor::eIntOpaqueBlack,
 		vk::False
 	);
 
-	vk::Result r;
-
-	std::tie(r, out->sampler) = device->logical_device.createSampler(sampler_ci);
+	out->sampler = device->sampler_cache->get(sampler_ci);
 
-	if (r != vk::Result::eSuccess)
+	if (!out->sampler)
 	{
-		sl::log_error("Failed to create a sampler for the following texture: `%s`.", path);
+		sl::log_error("Failed to get a sampler for the following texture: `{}`.", path);
 		return nullptr;
 	}
 
 	return out;
 }
 
-Texture::~Texture()
-{
-	if (sampler)
-	{
-		device->logical_device.destroy(sampler);
-	}
-}
-
 }
@@ -0,0 +1,105 @@
+#include "renderer/sampler_cache.hpp"
+
+#include <simple-logger.hpp>
+
+#include "renderer/device.hpp"
+
+namespace lise
+{
+
+template<typename T>
+static void hash_combine(size_t& seed, const T& value);
+
+size_t SamplerCreateInfoHash::operator () (const vk::SamplerCreateInfo& sampler_ci) const
+{
+	size_t seed = 0;
+
+	hash_combine(seed, static_cast<VkSamplerCreateFlags>(sampler_ci.flags));
+	hash_combine(seed, sampler_ci.magFilter);
+	hash_combine(seed, sampler_ci.minFilter);
+	hash_combine(seed, sampler_ci.mipmapMode);
+	hash_combine(seed, sampler_ci.addressModeU);
+	hash_combine(seed, sampler_ci.addressModeV);
+	hash_combine(seed, sampler_ci.addressModeW);
+	hash_combine(seed, sampler_ci.mipLodBias);
+	hash_combine(seed, sampler_ci.anisotropyEnable);
+	hash_combine(seed, sampler_ci.maxAnisotropy);
+	hash_combine(seed, sampler_ci.compareEnable);
+	hash_combine(seed, sampler_ci.compareOp);
+	hash_combine(seed, sampler_ci.minLod);
+	hash_combine(seed, sampler_ci.maxLod);
+	hash_combine(seed, sampler_ci.borderColor);
+	hash_combine(seed, sampler_ci.unnormalizedCoordinates);
+
+	return seed;
+}
+
+std::unique_ptr<SamplerCache> SamplerCache::create(const Device* device)
+{
+	auto out = std::make_unique<SamplerCache>();
+
+	// Copy trivial data.
+	out->device = device;
+
+	return out;
+}
+
+SamplerCache::~SamplerCache()
+{
+	for (auto& [sampler_ci, sampler] : samplers)
+	{
+		device->logical_device.destroy(sampler);
+	}
+}
+
+vk::Sampler SamplerCache::get(const vk::SamplerCreateInfo& sampler_ci)
+{
+	if (sampler_ci.pNext)
+	{
+		sl::log_error("Sampler create infos with a pNext chain can not be cached.");
+		return nullptr;
+	}
+
+	std::lock_guard lock(mutex);
+
+	auto it = samplers.find(sampler_ci);
+
+	if (it != samplers.end())
+	{
+		return it->second;
+	}
+
+	if (samplers.size() >= device->physical_device_properties.limits.maxSamplerAllocationCount)
+	{
+		sl::log_error("Failed to create a sampler, the device does not allow more than {} samplers.", samplers.size());
+		return nullptr;
+	}
+
+	auto [r, sampler] = device->logical_device.createSampler(sampler_ci);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to create a sampler.");
+		return nullptr;
+	}
+
+	samplers.insert({ sampler_ci, sampler });
+
+	return sampler;
+}
+
+uint32_t SamplerCache::get_sampler_count() const
+{
+	std::lock_guard lock(mutex);
+
+	return samplers.size();
+}
+
+// Static helper functions.
+template<typename T>
+static void hash_combine(size_t& seed, const T& value)
+{
+	seed ^= std::hash<T>()(value) + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2);
+}
+
+}
@@ -0,0 +1,168 @@
+#include "renderer/static_draw_cache.hpp"
+
+#include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+StaticDrawCache::~StaticDrawCache()
+{
+	for (StaticDrawCacheFrame& frame : frames)
+	{
+		// The command buffer has to be freed before its pool is destroyed.
+		frame.command_buffer.reset();
+
+		device->logical_device.destroy(frame.command_pool);
+	}
+}
+
+std::unique_ptr<StaticDrawCache> StaticDrawCache::create(const Device* device, uint32_t frame_count)
+{
+	auto out = std::make_unique<StaticDrawCache>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->revision = 1;
+	out->render_queue.is_static = true;
+
+	out->frames.resize(frame_count);
+
+	for (StaticDrawCacheFrame& frame : out->frames)
+	{
+		// The pool is reset as a whole before recording again.
+		vk::CommandPoolCreateInfo pool_ci({}, device->queue_indices.graphics_queue_index);
+
+		vk::Result r;
+
+		std::tie(r, frame.command_pool) = device->logical_device.createCommandPool(pool_ci);
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to create a static draw cache command pool.");
+			return nullptr;
+		}
+
+		frame.command_buffer = CommandBuffer::create(device, frame.command_pool, false);
+
+		if (!frame.command_buffer)
+		{
+			sl::log_error("Failed to create a static draw cache command buffer.");
+			return nullptr;
+		}
+
+		// Nothing has been recorded yet.
+		frame.revision = 0;
+		frame.stats = {};
+	}
+
+	return out;
+}
+
+void StaticDrawCache::invalidate()
+{
+	revision++;
+}
+
+bool StaticDrawCache::is_out_of_date(uint32_t frame) const
+{
+	const StaticDrawCacheFrame& cached = frames[frame];
+
+	if (cached.revision != revision)
+	{
+		return true;
+	}
+
+	// The ubos and samplers of the instances are baked into the recorded draws.
+	for (const auto& [instance, instance_revision] : cached.instance_revisions)
+	{
+		if (instance->revision != instance_revision)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void StaticDrawCache::mark_drawn(uint32_t frame, uint64_t frame_number)
+{
+	for (const auto& [instance, instance_revision] : frames[frame].instance_revisions)
+	{
+		instance->last_drawn_frame = frame_number;
+	}
+}
+
+bool StaticDrawCache::record(
+	FrameUniformAllocator* allocator,
+	vk::RenderPass render_pass,
+	const vk::Viewport& viewport,
+	const vk::Rect2D& scissor,
+	uint32_t frame
+)
+{
+	LPROFILE_FUNCTION();
+
+	StaticDrawCacheFrame& cached = frames[frame];
+
+	// Nothing gets executed for the frame until the recording has succeeded.
+	cached.stats = {};
+
+	vk::Result r = device->logical_device.resetCommandPool(cached.command_pool);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to reset a static draw cache command pool.");
+		return false;
+	}
+
+	// The previous recording of this frame is no longer in use, so its data can be overwritten.
+	allocator->reset_static(frame);
+
+	// Static queues never record culling commands, so no primary command buffer is needed.
+	render_queue.prepare(nullptr, allocator, nullptr, frame);
+
+	cached.instance_revisions.clear();
+
+	for (const RenderQueueBatch& batch : render_queue.batches)
+	{
+		// Bindless batches merge the items of different instances, whose materials are baked into the per instance
+		// data.
+		uint32_t instance_count = batch.mesh->shader->is_bindless ? batch.entry_count : 1;
+
+		for (uint32_t i = 0; i < instance_count; i++)
+		{
+			uint32_t index = render_queue.sort_entries[batch.first_entry + i].index;
+
+			Shader::Instance* instance = render_queue.items[index].mesh->shader_instance;
+
+			if (cached.instance_revisions.empty() || cached.instance_revisions.back().first != instance)
+			{
+				cached.instance_revisions.push_back({ instance, instance->revision });
+			}
+		}
+	}
+
+	// The framebuffer is left out, as the command buffer gets executed with the framebuffer of every swapchain image.
+	vk::CommandBufferInheritanceInfo inheritance_info(render_pass, 0, nullptr);
+
+	if (!cached.command_buffer->begin(false, true, false, &inheritance_info))
+	{
+		render_queue.clear();
+		return false;
+	}
+
+	cached.command_buffer->handle.setViewport(0, 1, &viewport);
+	cached.command_buffer->handle.setScissor(0, 1, &scissor);
+
+	cached.stats = render_queue.flush(cached.command_buffer.get(), frame);
+
+	cached.command_buffer->end();
+
+	cached.revision = revision;
+
+	return true;
+}
+
+}
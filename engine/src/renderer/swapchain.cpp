@@ -5,6 +5,8 @@
 namespace lise
 {
 
+static std::optional<vk::Format> find_depth_format(const Device* device);
+
 std::unique_ptr<Swapchain> Swapchain::create(
 	const Device* device,
 	const RenderPass* render_pass,
@@ -66,86 +68,58 @@ std::unique_ptr<Swapchain> Swapchain::create(
 	// Get swapchain images
 	std::tie(r, out->images) = device->logical_device.getSwapchainImagesKHR(out->handle);
 
-	out->max_frames_in_flight = out->images.size() - 1;
-	
-	// Views
-	out->image_views.resize(out->images.size());
-
-	for (size_t i = 0; i < out->images.size(); i++)
+	if (!out->create_attachments(render_pass))
 	{
-		vk::ImageViewCreateInfo view_ci(
-			{},
-			out->images[i],
-			vk::ImageViewType::e2D,
-			swapchain_info.image_format.format,
-			{},
-			vk::ImageSubresourceRange(
-				vk::ImageAspectFlagBits::eColor,
-				0,
-				1,
-				0,
-				1
-			)
-		);
+		return nullptr;
+	}
 
-		std::tie(r, out->image_views[i]) = device->logical_device.createImageView(view_ci);
+	return out;
+}
 
-		if (r != vk::Result::eSuccess)
-		{
-			sl::log_error("Failed to create swapchain image view.");
-			return nullptr;
-		}
-	}
+std::unique_ptr<Swapchain> Swapchain::create_headless(
+	const Device* device,
+	const RenderPass* render_pass,
+	SwapchainInfo swapchain_info
+)
+{
+	auto out = std::make_unique<Swapchain>();
 
-	// Create the depth attachments
-	out->depth_attachments.reserve(out->images.size());
+	// Copy trivial data.
+	out->device = device;
+	out->swapchain_info = swapchain_info;
+	out->is_headless = true;
 
-	for (size_t i = 0; i < out->images.size(); i++)
+	// Create the offscreen images that stand in for the swapchain images.
+	out->offscreen_images.reserve(swapchain_info.min_image_count);
+	out->images.reserve(swapchain_info.min_image_count);
+
+	for (uint32_t i = 0; i < swapchain_info.min_image_count; i++)
 	{
-		auto depth_attachment = Image::create(
+		auto image = Image::create(
 			device,
 			vk::ImageType::e2D,
 			vector2ui { swapchain_info.swapchain_extent.width, swapchain_info.swapchain_extent.height },
-			swapchain_info.depth_format,
+			swapchain_info.image_format.format,
 			vk::ImageTiling::eOptimal,
-			vk::ImageUsageFlagBits::eDepthStencilAttachment,
+			vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
 			vk::MemoryPropertyFlagBits::eDeviceLocal,
-			true,
-			vk::ImageAspectFlagBits::eDepth
+			false,
+			vk::ImageAspectFlagBits::eColor
 		);
 
-		if(!depth_attachment)
+		if (!image)
 		{
-			sl::log_fatal("Failed to create image swap chain depth attachments.");
+			sl::log_fatal("Failed to create headless swapchain image.");
 			return nullptr;
 		}
 
-		out->depth_attachments.push_back(std::move(depth_attachment));
+		out->images.push_back(image->handle);
+		out->offscreen_images.push_back(std::move(image));
 	}
 
-	// Create framebuffers
-	out->framebuffers.resize(out->images.size());
-
-	for (uint32_t i = 0; i < out->images.size(); i++)
+	if (!out->create_attachments(render_pass))
 	{
-		std::vector<vk::ImageView> attachments = { out->image_views[i] };
-
-		vk::FramebufferCreateInfo fb_ci(
-			{},
-			render_pass->handle,
-			attachments,
-			swapchain_info.swapchain_extent.width,
-			swapchain_info.swapchain_extent.height,
-			1
-		);
-
-		std::tie(r, out->framebuffers[i]) = device->logical_device.createFramebuffer(fb_ci);
-
-		if (r != vk::Result::eSuccess)
-		{
-			sl::log_fatal("Failed to create swap chain frame buffers");
-			return nullptr;
-		}
+		return nullptr;
 	}
 
 	return out;
@@ -163,7 +137,11 @@ Swapchain::~Swapchain()
 		device->logical_device.destroy(image_views[i]);
 	}
 
-	device->logical_device.destroy(handle);
+	// Headless devices do not enable VK_KHR_swapchain, so its functions must not be called at all.
+	if (!is_headless)
+	{
+		device->logical_device.destroy(handle);
+	}
 }
 
 std::optional<uint32_t> Swapchain::acquire_next_image_index(
@@ -172,6 +150,16 @@ std::optional<uint32_t> Swapchain::acquire_next_image_index(
 	vk::Fence fence
 )
 {
+	if (is_headless)
+	{
+		// Offscreen images are handed out in order. The in-flight fences already guarantee that the image is no
+		// longer in use, so there is nothing to signal.
+		uint32_t image_index = next_offscreen_image_index;
+		next_offscreen_image_index = (next_offscreen_image_index + 1) % images.size();
+
+		return image_index;
+	}
+
 	uint32_t out_image_index;
 
 	vk::Result r;
@@ -195,6 +183,14 @@ std::optional<uint32_t> Swapchain::acquire_next_image_index(
 
 bool Swapchain::present(vk::Semaphore render_complete_semaphore, uint32_t present_image_index)
 {
+	if (is_headless)
+	{
+		// Nothing to present to.
+		current_frame = (current_frame + 1) % max_frames_in_flight;
+
+		return true;
+	}
+
 	vk::PresentInfoKHR present_info(
 		1, &render_complete_semaphore,
 		1, &handle, &present_image_index
@@ -219,6 +215,95 @@ bool Swapchain::present(vk::Semaphore render_complete_semaphore, uint32_t presen
 	return true;
 }
 
+bool Swapchain::create_attachments(const RenderPass* render_pass)
+{
+	vk::Result r;
+
+	max_frames_in_flight = images.size() - 1;
+	
+	// Views
+	image_views.resize(images.size());
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		vk::ImageViewCreateInfo view_ci(
+			{},
+			images[i],
+			vk::ImageViewType::e2D,
+			swapchain_info.image_format.format,
+			{},
+			vk::ImageSubresourceRange(
+				vk::ImageAspectFlagBits::eColor,
+				0,
+				1,
+				0,
+				1
+			)
+		);
+
+		std::tie(r, image_views[i]) = device->logical_device.createImageView(view_ci);
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to create swapchain image view.");
+			return false;
+		}
+	}
+
+	// Create the depth attachments
+	depth_attachments.reserve(images.size());
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		auto depth_attachment = Image::create(
+			device,
+			vk::ImageType::e2D,
+			vector2ui { swapchain_info.swapchain_extent.width, swapchain_info.swapchain_extent.height },
+			swapchain_info.depth_format,
+			vk::ImageTiling::eOptimal,
+			vk::ImageUsageFlagBits::eDepthStencilAttachment,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			true,
+			vk::ImageAspectFlagBits::eDepth
+		);
+
+		if(!depth_attachment)
+		{
+			sl::log_fatal("Failed to create image swap chain depth attachments.");
+			return false;
+		}
+
+		depth_attachments.push_back(std::move(depth_attachment));
+	}
+
+	// Create framebuffers
+	framebuffers.resize(images.size());
+
+	for (uint32_t i = 0; i < images.size(); i++)
+	{
+		std::vector<vk::ImageView> attachments = { image_views[i] };
+
+		vk::FramebufferCreateInfo fb_ci(
+			{},
+			render_pass->handle,
+			attachments,
+			swapchain_info.swapchain_extent.width,
+			swapchain_info.swapchain_extent.height,
+			1
+		);
+
+		std::tie(r, framebuffers[i]) = device->logical_device.createFramebuffer(fb_ci);
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_fatal("Failed to create swap chain frame buffers");
+			return false;
+		}
+	}
+
+	return true;
+}
+
 SwapchainInfo Swapchain::query_info(const Device* device, vk::SurfaceKHR surface)
 {
 	SwapchainInfo info = {};
@@ -264,6 +349,71 @@ SwapchainInfo Swapchain::query_info(const Device* device, vk::SurfaceKHR surface
 
 	info.min_image_count = swap_chain_image_count;
 
+	auto depth_format = find_depth_format(device);
+
+	if (!depth_format)
+	{
+		sl::log_error("Failed to find supported depth format during swapchain creation.");
+		return SwapchainInfo {};
+	}
+
+	info.depth_format = *depth_format;
+
+	return info;
+}
+
+SwapchainInfo Swapchain::query_headless_info(const Device* device, vector2ui size)
+{
+	SwapchainInfo info = {};
+
+	// Pick the first eight bit color format that can be rendered to.
+	const vk::Format color_candidates[2] = {
+		vk::Format::eB8G8R8A8Unorm,
+		vk::Format::eR8G8B8A8Unorm
+	};
+
+	bool color_supported = false;
+	for (auto format : color_candidates)
+	{
+		vk::FormatProperties format_properties = device->physical_device.getFormatProperties(format);
+
+		if (format_properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eColorAttachment)
+		{
+			info.image_format = vk::SurfaceFormatKHR(format, vk::ColorSpaceKHR::eSrgbNonlinear);
+			color_supported = true;
+			break;
+		}
+	}
+
+	if (!color_supported)
+	{
+		sl::log_error("Failed to find supported color format during headless swapchain creation.");
+		return SwapchainInfo {};
+	}
+
+	// Nothing is presented, the present mode is only stored for completeness.
+	info.present_mode = vk::PresentModeKHR::eImmediate;
+	info.swapchain_extent = vk::Extent2D(size.w, size.h);
+
+	// Mirror a typical surface: two frames in flight.
+	info.min_image_count = 3;
+
+	auto depth_format = find_depth_format(device);
+
+	if (!depth_format)
+	{
+		sl::log_error("Failed to find supported depth format during headless swapchain creation.");
+		return SwapchainInfo {};
+	}
+
+	info.depth_format = *depth_format;
+
+	return info;
+}
+
+// Static helper functions.
+static std::optional<vk::Format> find_depth_format(const Device* device)
+{
 	// Check if device supports depth format
 	const uint32_t candidate_count = 3;
 	const vk::Format candidates[3] = {
@@ -272,8 +422,6 @@ SwapchainInfo Swapchain::query_info(const Device* device, vk::SurfaceKHR surface
 		vk::Format::eD24UnormS8Uint
 	};
 
-	float formats_supported = false;
-	vk::Format depth_format;
 	auto flags = vk::FormatFeatureFlagBits::eDepthStencilAttachment;
 	for (uint32_t i = 0; i < candidate_count; i++)
 	{
@@ -281,27 +429,15 @@ SwapchainInfo Swapchain::query_info(const Device* device, vk::SurfaceKHR surface
 
 		if ((format_properties.linearTilingFeatures & flags) == flags)
 		{
-			depth_format = candidates[i];
-			formats_supported = true;
-			break;
+			return candidates[i];
 		}
 		else if ((format_properties.optimalTilingFeatures & flags) == flags)
 		{
-			depth_format = candidates[i];
-			formats_supported = true;
-			break;
+			return candidates[i];
 		}
 	}
 
-	if (!formats_supported)
-	{
-		sl::log_error("Failed to find supported depth format during swapchain creation.");
-		return SwapchainInfo {};
-	}
-
-	info.depth_format = depth_format;
-
-	return info;
+	return {};
 }
 
 }
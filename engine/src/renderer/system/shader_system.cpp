@@ -1,9 +1,13 @@
 #include "renderer/system/shader_system.hpp"
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include <simple-logger.hpp>
 
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
+
 namespace lise
 {
 
@@ -12,12 +16,21 @@ static std::unordered_map<std::string, std::unique_ptr<Shader>> loaded_shaders;
 // Caches
 static const Device* p_device;
 static const Swapchain* p_swapchain;
+static FrameUniformAllocator* p_uniform_allocator;
+
+static std::unique_ptr<Shader> create_shader(const std::string& path, const RenderPass* render_pass);
+static Shader* register_shader(const std::string& path, std::unique_ptr<Shader> shader);
 
-bool shader_system_initialize(const Device* device, const Swapchain* swapchain)
+bool shader_system_initialize(
+	const Device* device,
+	const Swapchain* swapchain,
+	FrameUniformAllocator* uniform_allocator
+)
 {
 	// Set the caches.
 	p_device = device;
 	p_swapchain = swapchain;
+	p_uniform_allocator = uniform_allocator;
 
 	sl::log_info("Successfully initialized the renderer shader subsystem.");
 
@@ -32,6 +45,7 @@ void shader_system_shutdown()
 	// Clear caches.
 	p_device = NULL;
 	p_swapchain = NULL;
+	p_uniform_allocator = NULL;
 
 	sl::log_info("Successfully shut down the renderer shader subsystem.");
 }
@@ -50,6 +64,77 @@ Shader* shader_system_load(const std::string& path, const RenderPass* render_pas
 		return nullptr;
 	}
 
+	auto shader = create_shader(path, render_pass);
+
+	if (!shader)
+	{
+		return nullptr;
+	}
+
+	return register_shader(path, std::move(shader));
+}
+
+std::vector<Shader*> shader_system_load_batch(std::span<const ShaderLoadRequest> requests)
+{
+	LPROFILE_FUNCTION();
+
+	std::vector<Shader*> out(requests.size(), nullptr);
+	std::vector<std::unique_ptr<Shader>> shaders(requests.size());
+
+	// Skip shaders that are already loaded, or requested more than once.
+	std::vector<uint32_t> pending;
+	std::unordered_set<std::string> pending_paths;
+
+	for (uint32_t i = 0; i < requests.size(); i++)
+	{
+		if (loaded_shaders.contains(requests[i].path) || !pending_paths.insert(requests[i].path).second)
+		{
+			sl::log_warn("Attempting to load an already loaded shader `{}`.", requests[i].path);
+			continue;
+		}
+
+		pending.push_back(i);
+	}
+
+	// Shader creation only touches the device and the memory allocator, which are safe to use from many threads.
+	job_system_run(pending.size(), [&](uint32_t job_index)
+	{
+		const ShaderLoadRequest& request = requests[pending[job_index]];
+
+		shaders[pending[job_index]] = create_shader(request.path, request.render_pass);
+	});
+
+	for (uint32_t i : pending)
+	{
+		if (shaders[i])
+		{
+			out[i] = register_shader(requests[i].path, std::move(shaders[i]));
+		}
+	}
+
+	return out;
+}
+
+Shader* shader_system_get(const std::string& path)
+{
+	std::unordered_map<std::string, std::unique_ptr<Shader>>::iterator it = loaded_shaders.find(path);
+
+	if (it == loaded_shaders.end())
+	{
+		sl::log_error("Failed to find shader with path `{}`.", path);
+		return nullptr;
+	}
+
+	auto& p = *it;
+
+	return p.second.get();
+}
+
+// Static helper functions.
+static std::unique_ptr<Shader> create_shader(const std::string& path, const RenderPass* render_pass)
+{
+	LPROFILE_FUNCTION();
+
 	// Load config.
 	ShaderConfig shader_config;
 
@@ -66,34 +151,25 @@ Shader* shader_system_load(const std::string& path, const RenderPass* render_pas
 		render_pass,
 		p_swapchain->swapchain_info.swapchain_extent.width,
 		p_swapchain->swapchain_info.swapchain_extent.height,
-		p_swapchain->images.size()
+		p_swapchain->images.size(),
+		p_uniform_allocator
 	);
 	
 	if(!shader)
 	{
-		sl::log_error("Failed to load shader.");
+		sl::log_error("Failed to load shader `{}`.", path);
 
 		return nullptr;
 	}
 
-	auto& i_result = *loaded_shaders.insert({ path, std::move(shader) }).first;
-
-	return i_result.second.get();
+	return shader;
 }
 
-Shader* shader_system_get(const std::string& path)
+static Shader* register_shader(const std::string& path, std::unique_ptr<Shader> shader)
 {
-	std::unordered_map<std::string, std::unique_ptr<Shader>>::iterator it = loaded_shaders.find(path);
-
-	if (it == loaded_shaders.end())
-	{
-		sl::log_error("Failed to find shader with path `{}`.", path);
-		return nullptr;
-	}
-
-	auto& p = *it;
+	auto& i_result = *loaded_shaders.insert({ path, std::move(shader) }).first;
 
-	return p.second.get();
+	return i_result.second.get();
 }
 
 }
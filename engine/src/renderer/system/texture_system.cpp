@@ -1,5 +1,8 @@
 #include "renderer/system/texture_system.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <unordered_map>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -7,20 +10,186 @@
 
 #include <simple-logger.hpp>
 
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
+#include "loader/texture_container_loader.hpp"
+#include "renderer/mip_chain.hpp"
+#include "renderer/texture_format.hpp"
+
 namespace lise
 {
 
-static std::unordered_map<std::string, std::unique_ptr<Texture>> loaded_textures;
+/**
+ * @brief The pixel data of a texture, decoded and ready to be uploaded.
+ */
+struct TextureData
+{
+	vk::Format format;
+	vector2ui size;
+	uint32_t mip_levels;
+	uint32_t channel_count;
+
+	/**
+	 * @brief The tightly packed mip levels, starting with the largest.
+	 */
+	std::vector<uint8_t> data;
+};
+
+/**
+ * @brief A sampler of a shader instance that is set to a texture.
+ */
+struct TextureBinding
+{
+	Shader::Instance* instance;
+	uint32_t sampler_index;
+};
+
+/**
+ * @brief A texture that is being streamed in. Shared with the job that decodes it.
+ */
+struct TextureStreamRequest
+{
+	std::string path;
+
+	/**
+	 * @brief The amount of the largest mip levels that are left out. Non-zero when a texture is reduced.
+	 */
+	uint32_t first_level;
+
+	/**
+	 * @brief Written by the decoding job before it sets \ref is_decoded.
+	 */
+	TextureData data;
+	bool is_valid;
+
+	/**
+	 * @brief Set by the decoding job once it has finished, successfully or not.
+	 */
+	std::atomic<bool> is_decoded = false;
+
+	/**
+	 * @brief Set when the texture system shuts down, so jobs that have not started yet skip decoding.
+	 */
+	std::atomic<bool> is_cancelled = false;
+
+	/**
+	 * @brief The texture, once its upload has been recorded. Replaces the resident texture once the upload has
+	 * finished.
+	 */
+	std::unique_ptr<Texture> texture;
+};
+
+/**
+ * @brief A texture known to the texture system, resident or not.
+ */
+struct TextureEntry
+{
+	/**
+	 * @brief The resident texture, nullptr while the texture is streamed in for the first time.
+	 */
+	std::unique_ptr<Texture> texture;
+
+	/**
+	 * @brief The references handed out by \ref texture_system_load and \ref texture_system_get_or_load. The texture
+	 * can not be replaced while there are any, as their holders keep pointers to it.
+	 */
+	uint32_t reference_count = 0;
+
+	/**
+	 * @brief The samplers set to the texture by \ref texture_system_get_or_load_async. Each of them is a reference as
+	 * well, but the texture system can replace the texture they are set to.
+	 */
+	std::vector<TextureBinding> bindings;
+
+	/**
+	 * @brief The frame number at which the texture was last referenced or drawn.
+	 */
+	uint64_t last_used_frame = 0;
+
+	/**
+	 * @brief Whether the largest mip levels have been left out to save memory.
+	 */
+	bool is_reduced = false;
+
+	/**
+	 * @brief Set when reducing or restoring the texture failed, so it is not attempted every frame.
+	 */
+	bool is_pinned = false;
+
+	/**
+	 * @brief The load that is in progress, if any.
+	 */
+	std::shared_ptr<TextureStreamRequest> request;
+};
+
+/**
+ * @brief A texture that is no longer used, but might still be in use by a frame in flight.
+ */
+struct PendingTextureDestruction
+{
+	std::unique_ptr<Texture> texture;
+	uint64_t frame_number;
+};
+
+static std::unordered_map<std::string, TextureEntry> textures;
+
+/**
+ * @brief The textures that are being streamed in, in the order they were requested.
+ */
+static std::deque<std::shared_ptr<TextureStreamRequest>> stream_requests;
+
+static std::vector<PendingTextureDestruction> pending_destructions;
+
+/**
+ * @brief The amount of bytes of all resident textures, and the amount they are allowed to take up.
+ */
+static uint64_t resident_bytes;
+static uint64_t budget = LTEXTURE_SYSTEM_DEFAULT_BUDGET;
+
+/**
+ * @brief The frame number passed to the latest \ref texture_system_update.
+ */
+static uint64_t current_frame_number;
 
 static std::string default_texture_path = "__default_texture_path__";
 static Texture* default_texture;
 
+static std::unique_ptr<BindlessTextureTable> bindless_table;
+
 static bool create_default_texture(const Device* device);
+static void stream_texture(const Device* device, const std::string& path, TextureEntry& entry, uint32_t first_level);
+static void update_stream_requests(const Device* device);
+static void restore_textures(const Device* device);
+static void evict_textures(const Device* device);
+static void set_texture(TextureEntry& entry, std::unique_ptr<Texture> texture);
+static void destroy_texture(std::unique_ptr<Texture> texture);
+static bool decode_texture(const Device* device, const std::string& path, TextureData& out_data);
+static bool decode_container_texture(const Device* device, const std::string& path, TextureData& out_data);
+static bool decode_stb_texture(const std::string& path, TextureData& out_data);
+static void drop_mip_levels(TextureData& data, uint32_t first_level);
+static std::unique_ptr<Texture> create_texture(const Device* device, const std::string& path, const TextureData& data);
+static uint32_t get_reduced_first_level(const Texture* texture);
+static uint64_t get_byte_size(const Texture* texture, uint32_t first_level = 0);
+static void register_bindless_texture(Texture* texture);
 
 bool texture_system_initialize(const Device* device)
 {
 	stbi_set_flip_vertically_on_load(true);
 
+	resident_bytes = 0;
+	current_frame_number = 0;
+
+	// Create the bindless texture table before any texture, so the default texture gets index 0.
+	if (BindlessTextureTable::is_supported(device))
+	{
+		bindless_table = BindlessTextureTable::create(device);
+
+		if (!bindless_table)
+		{
+			sl::log_warn("Failed to create the bindless texture table. Falling back to per instance descriptors.");
+		}
+	}
+
 	// Create the default texture.
 	if (!create_default_texture(device))
 	{
@@ -35,12 +204,29 @@ bool texture_system_initialize(const Device* device)
 
 void texture_system_shutdown()
 {
-	// Free all textures.
-	loaded_textures.clear();
+	// Wait for the textures that are being decoded. Jobs that have not started yet return right away.
+	for (auto& request : stream_requests)
+	{
+		request->is_cancelled = true;
+	}
+
+	for (auto& request : stream_requests)
+	{
+		request->is_decoded.wait(false);
+	}
+
+	stream_requests.clear();
+
+	// Free all textures. Nothing is in flight anymore.
+	pending_destructions.clear();
+	textures.clear();
 
 	// Destroy the default texture.
 	delete default_texture;
 
+	// The table is destroyed last, as nothing can sample from it anymore.
+	bindless_table.reset();
+
 	sl::log_info("Successfully shut down the renderer texture subsystem.");
 }
 
@@ -49,85 +235,183 @@ const Texture* texture_system_get_default_texture()
 	return default_texture;
 }
 
+BindlessTextureTable* texture_system_get_bindless_table()
+{
+	return bindless_table.get();
+}
+
+void texture_system_set_budget(uint64_t budget_bytes)
+{
+	budget = budget_bytes;
+}
+
+uint64_t texture_system_get_resident_bytes()
+{
+	return resident_bytes;
+}
+
 const Texture* texture_system_load(const Device* device, const std::string& path)
 {
-	if (loaded_textures.contains(path))
+	LPROFILE_FUNCTION();
+
+	auto it = textures.find(path);
+
+	if (it != textures.end())
 	{
-		// Texture is already loaded.
-		sl::log_warn("Attempting to load an already loaded texture.");
+		if (!it->second.texture)
+		{
+			// Texture is being streamed in.
+			return default_texture;
+		}
+
+		// Texture has already been loaded.
+		it->second.reference_count++;
+		it->second.last_used_frame = current_frame_number;
+
+		return it->second.texture.get();
+	}
+
+	TextureData data;
+
+	std::unique_ptr<Texture> texture = decode_texture(device, path, data) ? create_texture(device, path, data) : nullptr;
+
+	if (!texture)
+	{
+		sl::log_error("Faild to load texture: `{}`. Providing default texture.", path);
+
 		return default_texture;
 	}
 
-	// Load the image using stb_image.
-	uint32_t width = 0;
-	uint32_t height = 0;
-	uint32_t channel_count = 0;
-	constexpr uint32_t required_channel_count = 4;
+	TextureEntry& entry = textures[path];
+	entry.reference_count = 1;
+	entry.last_used_frame = current_frame_number;
 
-	uint8_t* data = stbi_load(path.c_str(), (int*) &width, (int*) &height, (int*) &channel_count, STBI_rgb_alpha);
+	set_texture(entry, std::move(texture));
 
-	if (!data)
+	return entry.texture.get();
+}
+
+const Texture* texture_system_get(const std::string& path)
+{
+	auto it = textures.find(path);
+
+	if (it == textures.end() || !it->second.texture)
 	{
-		sl::log_error(
-			"STB_image failed to load an image during texture creation of texture `%s`. Error: %s.",
-			path,
-			stbi_failure_reason()
-		);
+		sl::log_warn("Texture with path `{}` has not been loaded yet. Providing default texture.", path);
 
 		return default_texture;
 	}
 
-	uint64_t size = width * height * required_channel_count;
+	return it->second.texture.get();
+}
 
-	// Check for transparency.
-	bool has_transparency = false;
+const Texture* texture_system_get_or_load(const Device* device, const std::string& path)
+{
+	// Loading a known texture adds a reference to it instead.
+	return texture_system_load(device, path);
+}
 
-	for (uint64_t i = 0 ; i < size; i += required_channel_count)
+void texture_system_release(const Texture* texture)
+{
+	if (!texture || texture == default_texture)
 	{
-		if (data[i + 4] < 255)
-		{
-			has_transparency = true;
-			break;
-		}
+		return;
 	}
 
-	// Create texture.
-	auto texture = Texture::create(device, path, vector2ui { width, height} , channel_count, data, has_transparency);
+	auto it = textures.find(texture->path);
 
-	if (!texture)
+	if (it == textures.end() || it->second.texture.get() != texture || it->second.reference_count == 0)
 	{
-		sl::log_error("Faild to load texture: `%s`. Providing default texture.", path);
+		sl::log_warn("Attempting to release a texture that is not referenced: `{}`.", texture->path);
+		return;
+	}
 
-		return default_texture;
+	// Unreferenced textures stay resident until the budget runs out.
+	it->second.reference_count--;
+	it->second.last_used_frame = current_frame_number;
+}
+
+const Texture* texture_system_get_or_load_async(
+	const Device* device,
+	const std::string& path,
+	Shader::Instance* instance,
+	uint32_t sampler_index
+)
+{
+	auto it = textures.find(path);
+
+	if (it == textures.end())
+	{
+		it = textures.insert({ path, TextureEntry() }).first;
+
+		stream_texture(device, path, it->second, 0);
 	}
 
-	auto& i_result = *loaded_textures.insert({ path, std::move(texture) }).first;
+	TextureEntry& entry = it->second;
+	entry.bindings.push_back({ instance, sampler_index });
+	entry.last_used_frame = current_frame_number;
+
+	const Texture* texture = entry.texture ? entry.texture.get() : default_texture;
 
-	return i_result.second.get();
+	instance->set_sampler(sampler_index, texture);
+
+	return texture;
 }
 
-const Texture* texture_system_get(const std::string& path)
+void texture_system_unbind_instance(const Shader::Instance* instance)
 {
-	if (!loaded_textures.contains(path))
+	for (auto& [path, entry] : textures)
 	{
-		sl::log_warn("Texture with path `%s` has not been loaded yet. Providing default texture.", path);
+		size_t erased = std::erase_if(entry.bindings, [instance](const TextureBinding& binding)
+		{
+			return binding.instance == instance;
+		});
 
-		return default_texture;
+		if (erased > 0)
+		{
+			entry.last_used_frame = current_frame_number;
+		}
 	}
-
-	return loaded_textures.at(path).get();
 }
 
-const Texture* texture_system_get_or_load(const Device* device, const std::string& path)
+void texture_system_update(const Device* device, uint64_t frame_number, uint32_t frames_in_flight)
 {
-	if (loaded_textures.contains(path))
+	LPROFILE_FUNCTION();
+
+	current_frame_number = frame_number;
+
+	// Destroy the replaced and evicted textures that are no longer used by any frame in flight.
+	std::erase_if(pending_destructions, [frames_in_flight](PendingTextureDestruction& pending)
 	{
-		// Texture has already been loaded.
-		return loaded_textures.at(path).get();
+		if (current_frame_number < pending.frame_number + frames_in_flight)
+		{
+			return false;
+		}
+
+		if (bindless_table && pending.texture->bindless_index != 0)
+		{
+			bindless_table->release(pending.texture->bindless_index);
+		}
+
+		return true;
+	});
+
+	// Textures are sampled whenever an instance they are set on gets drawn.
+	for (auto& [path, entry] : textures)
+	{
+		for (const TextureBinding& binding : entry.bindings)
+		{
+			entry.last_used_frame = std::max(entry.last_used_frame, binding.instance->last_drawn_frame);
+		}
 	}
-	else
+
+	update_stream_requests(device);
+
+	restore_textures(device);
+
+	if (resident_bytes > budget)
 	{
-		return texture_system_load(device, path);
+		evict_textures(device);
 	}
 }
 
@@ -189,7 +473,424 @@ static bool create_default_texture(const Device* device)
 
 	default_texture = texture.release();
 
+	register_bindless_texture(default_texture);
+
+	return true;
+}
+
+static void stream_texture(const Device* device, const std::string& path, TextureEntry& entry, uint32_t first_level)
+{
+	auto request = std::make_shared<TextureStreamRequest>();
+	request->path = path;
+	request->first_level = first_level;
+
+	entry.request = request;
+
+	stream_requests.push_back(request);
+
+	// The job keeps the request alive, in case the texture system shuts down while it runs.
+	job_system_submit([device, request]()
+	{
+		if (!request->is_cancelled)
+		{
+			request->is_valid = decode_texture(device, request->path, request->data);
+
+			if (request->is_valid)
+			{
+				drop_mip_levels(request->data, request->first_level);
+			}
+		}
+
+		request->is_decoded = true;
+		request->is_decoded.notify_all();
+	});
+}
+
+static void update_stream_requests(const Device* device)
+{
+	uint64_t uploaded_bytes = 0;
+
+	for (auto it = stream_requests.begin(); it != stream_requests.end();)
+	{
+		TextureStreamRequest* request = it->get();
+
+		// Entries are not removed while they have a request in progress.
+		TextureEntry& entry = textures.at(request->path);
+
+		if (request->texture)
+		{
+			// Swap the texture in once it is resident. Its upload was recorded before this frame acquired the uploads,
+			// so it has been handed over to the graphics queue already.
+			if (upload_system_is_complete(request->texture->upload_ticket))
+			{
+				entry.request.reset();
+
+				// References handed out while the request was in flight point to the current texture, so it can not
+				// be replaced anymore. The reduced or restored texture is dropped instead.
+				if (entry.texture && entry.reference_count > 0)
+				{
+					destroy_texture(std::move(request->texture));
+
+					it = stream_requests.erase(it);
+					continue;
+				}
+
+				entry.is_reduced = request->first_level > 0;
+
+				set_texture(entry, std::move(request->texture));
+
+				it = stream_requests.erase(it);
+				continue;
+			}
+		}
+		else if (request->is_decoded)
+		{
+			// Spread large uploads over multiple frames. A single texture larger than the budget still gets uploaded.
+			uint64_t size = request->data.data.size();
+
+			if (request->is_valid && uploaded_bytes > 0 && uploaded_bytes + size > LTEXTURE_SYSTEM_UPLOAD_BUDGET)
+			{
+				break;
+			}
+
+			if (request->is_valid)
+			{
+				request->texture = create_texture(device, request->path, request->data);
+			}
+
+			if (!request->texture)
+			{
+				sl::log_error("Failed to stream texture: `{}`. Keeping the current texture.", request->path);
+
+				entry.request.reset();
+
+				if (entry.texture)
+				{
+					// Do not try to reduce or restore the texture again.
+					entry.is_pinned = true;
+				}
+				else
+				{
+					// The samplers keep the default texture.
+					textures.erase(request->path);
+				}
+
+				it = stream_requests.erase(it);
+				continue;
+			}
+
+			uploaded_bytes += size;
+
+			// The pixel data has been copied into the staging ring.
+			request->data.data = std::vector<uint8_t>();
+		}
+
+		++it;
+	}
+}
+
+static void restore_textures(const Device* device)
+{
+	// Reduced textures that are drawn again get their largest mip levels back.
+	for (auto& [path, entry] : textures)
+	{
+		// Referenced textures can not be replaced, so they are only restored once their references are released.
+		if (entry.is_reduced && !entry.request && !entry.is_pinned && entry.reference_count == 0 &&
+			entry.last_used_frame + LTEXTURE_SYSTEM_EVICTION_AGE > current_frame_number)
+		{
+			stream_texture(device, path, entry, 0);
+		}
+	}
+}
+
+static void evict_textures(const Device* device)
+{
+	LPROFILE_FUNCTION();
+
+	struct EvictionCandidate
+	{
+		std::unordered_map<std::string, TextureEntry>::iterator it;
+		bool is_referenced;
+	};
+
+	std::vector<EvictionCandidate> candidates;
+
+	for (auto it = textures.begin(); it != textures.end(); ++it)
+	{
+		TextureEntry& entry = it->second;
+
+		if (!entry.texture || entry.request)
+		{
+			continue;
+		}
+
+		bool is_referenced = entry.reference_count > 0 || !entry.bindings.empty();
+
+		// Referenced textures are reduced instead of evicted, which is only possible if all of their references are
+		// bindings, and only if they have not been drawn for a while.
+		if (is_referenced && (
+			entry.reference_count > 0 || entry.is_reduced || entry.is_pinned ||
+			entry.last_used_frame + LTEXTURE_SYSTEM_EVICTION_AGE > current_frame_number ||
+			get_reduced_first_level(entry.texture.get()) == 0))
+		{
+			continue;
+		}
+
+		candidates.push_back({ it, is_referenced });
+	}
+
+	// Unreferenced textures go first, then the least recently used ones.
+	std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& a, const EvictionCandidate& b)
+	{
+		if (a.is_referenced != b.is_referenced)
+		{
+			return !a.is_referenced;
+		}
+
+		return a.it->second.last_used_frame < b.it->second.last_used_frame;
+	});
+
+	uint64_t excess = resident_bytes - budget;
+
+	for (const EvictionCandidate& candidate : candidates)
+	{
+		TextureEntry& entry = candidate.it->second;
+
+		uint64_t freed_bytes;
+
+		if (candidate.is_referenced)
+		{
+			// The texture is replaced once the reduced texture has been uploaded.
+			uint32_t first_level = get_reduced_first_level(entry.texture.get());
+
+			freed_bytes = get_byte_size(entry.texture.get()) - get_byte_size(entry.texture.get(), first_level);
+
+			stream_texture(device, candidate.it->first, entry, first_level);
+		}
+		else
+		{
+			freed_bytes = get_byte_size(entry.texture.get());
+
+			destroy_texture(std::move(entry.texture));
+
+			textures.erase(candidate.it);
+		}
+
+		if (freed_bytes >= excess)
+		{
+			break;
+		}
+
+		excess -= freed_bytes;
+	}
+}
+
+static void set_texture(TextureEntry& entry, std::unique_ptr<Texture> texture)
+{
+	if (entry.texture)
+	{
+		destroy_texture(std::move(entry.texture));
+	}
+
+	entry.texture = std::move(texture);
+
+	for (const TextureBinding& binding : entry.bindings)
+	{
+		binding.instance->set_sampler(binding.sampler_index, entry.texture.get());
+	}
+}
+
+static void destroy_texture(std::unique_ptr<Texture> texture)
+{
+	resident_bytes -= get_byte_size(texture.get());
+
+	// The texture can still be in use by the frames in flight.
+	pending_destructions.push_back({ std::move(texture), current_frame_number });
+}
+
+static bool decode_texture(const Device* device, const std::string& path, TextureData& out_data)
+{
+	LPROFILE_FUNCTION();
+
+	// Pre-compressed textures are loaded from containers, which also hold their mip levels. Other images are decoded
+	// using stb_image.
+	if (texture_container_is_container_path(path))
+	{
+		return decode_container_texture(device, path, out_data);
+	}
+
+	return decode_stb_texture(path, out_data);
+}
+
+static bool decode_container_texture(const Device* device, const std::string& path, TextureData& out_data)
+{
+	TextureContainer container;
+
+	if (!texture_container_load(path, container))
+	{
+		return false;
+	}
+
+	out_data.size = container.size;
+	out_data.mip_levels = container.mip_levels;
+	out_data.channel_count = 4;
+
+	if (texture_format_is_supported(device, container.format))
+	{
+		out_data.format = container.format;
+		out_data.data = std::move(container.data);
+
+		return true;
+	}
+
+	if (!texture_format_is_block_compressed(container.format))
+	{
+		sl::log_error("The device does not support the format of the following texture: `{}`.", path);
+		return false;
+	}
+
+	// The device can not sample the format. Decode every mip level on the CPU instead, which costs the memory savings
+	// of the format, but keeps the texture usable.
+	sl::log_debug("The device does not support the format of texture `{}`. Decoding it on the CPU.", path);
+
+	out_data.format = texture_format_get_decoded_format(container.format);
+	out_data.data.resize(mip_chain_get_byte_size(container.size, container.mip_levels));
+
+	const uint8_t* blocks = container.data.data();
+	uint8_t* pixels = out_data.data.data();
+
+	for (uint32_t level = 0; level < container.mip_levels; level++)
+	{
+		vector2ui level_size = mip_chain_get_level_size(container.size, level);
+
+		texture_format_decode(container.format, blocks, level_size, pixels);
+
+		blocks += texture_format_get_byte_size(container.format, level_size);
+		pixels += texture_format_get_byte_size(out_data.format, level_size);
+	}
+
+	return true;
+}
+
+static bool decode_stb_texture(const std::string& path, TextureData& out_data)
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t channel_count = 0;
+
+	uint8_t* data = stbi_load(path.c_str(), (int*) &width, (int*) &height, (int*) &channel_count, STBI_rgb_alpha);
+
+	if (!data)
+	{
+		sl::log_error(
+			"STB_image failed to load an image during texture creation of texture `{}`. Error: {}.",
+			path,
+			stbi_failure_reason()
+		);
+
+		return false;
+	}
+
+	// Minified textures sample from a complete mip chain, which is built on the CPU, as the upload can run on a transfer
+	// queue that does not support blits.
+	out_data.format = vk::Format::eR8G8B8A8Unorm;
+	out_data.size = { width, height };
+	out_data.mip_levels = mip_chain_get_level_count(out_data.size);
+	out_data.channel_count = channel_count;
+	out_data.data.resize(mip_chain_get_byte_size(out_data.size, out_data.mip_levels));
+
+	mip_chain_generate(data, out_data.size, out_data.mip_levels, out_data.data.data());
+
+	stbi_image_free(data);
+
 	return true;
 }
 
+static void drop_mip_levels(TextureData& data, uint32_t first_level)
+{
+	// Textures without smaller mip levels keep their smallest one.
+	first_level = std::min(first_level, data.mip_levels - 1);
+
+	uint64_t dropped_bytes = 0;
+
+	for (uint32_t level = 0; level < first_level; level++)
+	{
+		dropped_bytes += texture_format_get_byte_size(data.format, mip_chain_get_level_size(data.size, level));
+	}
+
+	data.data.erase(data.data.begin(), data.data.begin() + dropped_bytes);
+	data.size = mip_chain_get_level_size(data.size, first_level);
+	data.mip_levels -= first_level;
+}
+
+static std::unique_ptr<Texture> create_texture(const Device* device, const std::string& path, const TextureData& data)
+{
+	auto texture = Texture::create(
+		device,
+		path,
+		data.size,
+		data.format,
+		data.mip_levels,
+		data.data.data(),
+		data.data.size()
+	);
+
+	if (!texture)
+	{
+		return nullptr;
+	}
+
+	texture->channel_count = data.channel_count;
+
+	register_bindless_texture(texture.get());
+
+	resident_bytes += get_byte_size(texture.get());
+
+	return texture;
+}
+
+static uint32_t get_reduced_first_level(const Texture* texture)
+{
+	uint32_t first_level = 0;
+
+	while (first_level + 1 < texture->image->mip_levels)
+	{
+		vector2ui level_size = mip_chain_get_level_size(texture->size, first_level);
+
+		if (std::max(level_size.w, level_size.h) <= LTEXTURE_SYSTEM_REDUCED_SIZE)
+		{
+			break;
+		}
+
+		first_level++;
+	}
+
+	return first_level;
+}
+
+static uint64_t get_byte_size(const Texture* texture, uint32_t first_level)
+{
+	uint64_t size = 0;
+
+	for (uint32_t level = first_level; level < texture->image->mip_levels; level++)
+	{
+		size += texture->image->get_level_byte_size(level);
+	}
+
+	return size;
+}
+
+static void register_bindless_texture(Texture* texture)
+{
+	if (!bindless_table)
+	{
+		return;
+	}
+
+	uint32_t index = bindless_table->register_texture(texture->image->image_view, texture->sampler);
+
+	// Textures that do not fit in the table are drawn using the default texture.
+	texture->bindless_index = index != UINT32_MAX ? index : 0;
+}
+
 }
@@ -0,0 +1,603 @@
+#include "renderer/system/upload_system.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <simple-logger.hpp>
+
+#include "core/profiler.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/fence.hpp"
+
+#define align(x, n) (((x - 1) | (n - 1)) + 1)
+
+namespace lise
+{
+
+struct UploadBatch
+{
+	std::unique_ptr<CommandBuffer> command_buffer;
+	std::unique_ptr<Fence> fence;
+
+	UploadTicket ticket;
+
+	/**
+	 * @brief The staging ring head after the last allocation of the batch. The ring tail moves here once the batch
+	 * has finished.
+	 */
+	uint64_t staging_end;
+
+	/**
+	 * @brief Staging buffers for uploads that do not fit in the staging ring. Destroyed once the batch has finished.
+	 */
+	std::vector<std::unique_ptr<VulkanBuffer>> temporary_buffers;
+
+	/**
+	 * @brief The buffer ranges written by the batch, and the layout transitions of the images written by the batch to
+	 * the shader read only layout. Recorded at the end of the batch, as ownership releases if the batch runs on a
+	 * dedicated transfer queue.
+	 */
+	std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+	std::vector<vk::ImageMemoryBarrier> image_barriers;
+
+	bool is_recording;
+	bool is_submitted;
+};
+
+static const Device* p_device;
+
+/**
+ * @brief The stages and accesses that read uploaded buffers and images. Transfers read uploaded buffers when the
+ * geometry arena gets compacted.
+ */
+static const vk::PipelineStageFlags consumer_stages =
+	vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput |
+	vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+
+static const vk::AccessFlags consumer_access =
+	vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead |
+	vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead;
+
+static std::unique_ptr<VulkanBuffer> staging_buffer;
+static uint64_t staging_alignment;
+
+/**
+ * @brief The head and tail of the staging ring. Both only ever increase, the position within the ring is their value
+ * modulo the ring size.
+ */
+static uint64_t staging_head;
+static uint64_t staging_tail;
+
+static UploadBatch batches[LUPLOAD_SYSTEM_MAX_BATCHES];
+static uint32_t current_batch;
+
+/**
+ * @brief The ticket of the batch that is currently being recorded.
+ */
+static UploadTicket next_ticket;
+
+/**
+ * @brief Batches finish in submission order, so every ticket up to and including this one is complete.
+ */
+static UploadTicket completed_ticket;
+
+/**
+ * @brief The ownership acquisitions of the resources released by submitted batches, which still have to be recorded
+ * on the graphics queue.
+ */
+static std::vector<vk::BufferMemoryBarrier> pending_buffer_acquires;
+static std::vector<vk::ImageMemoryBarrier> pending_image_acquires;
+
+static UploadBatch& get_recording_batch();
+static bool allocate_staging(uint64_t size, vk::Buffer& out_buffer, uint64_t& out_offset, uint8_t*& out_data);
+static UploadBatch* get_oldest_submitted_batch();
+static void retire_batch(UploadBatch& batch);
+static uint32_t get_source_queue_family();
+static uint32_t get_destination_queue_family();
+
+bool upload_system_initialize(const Device* device)
+{
+	// Set the caches.
+	p_device = device;
+
+	// Create the staging ring.
+	staging_buffer = VulkanBuffer::create(
+		device,
+		LUPLOAD_SYSTEM_STAGING_SIZE,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+		true,
+		true
+	);
+
+	if (!staging_buffer)
+	{
+		sl::log_error("Failed to create the upload staging buffer.");
+		return false;
+	}
+
+	// Buffer to image copies have to start at a multiple of the texel size, which is at most 16 bytes.
+	staging_alignment = std::max<uint64_t>(
+		16,
+		device->physical_device_properties.limits.optimalBufferCopyOffsetAlignment
+	);
+	staging_head = 0;
+	staging_tail = 0;
+
+	for (auto& batch : batches)
+	{
+		batch.command_buffer = CommandBuffer::create(device, device->transfer_command_pool, true);
+		batch.fence = Fence::create(device, true);
+
+		if (!batch.command_buffer || !batch.fence)
+		{
+			sl::log_error("Failed to create an upload batch.");
+			return false;
+		}
+
+		batch.ticket = 0;
+		batch.staging_end = 0;
+		batch.is_recording = false;
+		batch.is_submitted = false;
+	}
+
+	current_batch = 0;
+	next_ticket = 1;
+	completed_ticket = 0;
+
+	sl::log_info("Successfully initialized the renderer upload subsystem.");
+
+	return true;
+}
+
+void upload_system_shutdown()
+{
+	// Make sure nothing is still reading from the staging memory.
+	upload_system_wait(upload_system_flush());
+
+	for (auto& batch : batches)
+	{
+		batch.command_buffer.reset();
+		batch.fence.reset();
+		batch.temporary_buffers.clear();
+		batch.buffer_barriers.clear();
+		batch.image_barriers.clear();
+	}
+
+	pending_buffer_acquires.clear();
+	pending_image_acquires.clear();
+
+	staging_buffer.reset();
+
+	// Clear caches.
+	p_device = NULL;
+
+	sl::log_info("Successfully shut down the renderer upload subsystem.");
+}
+
+UploadTicket upload_system_upload_buffer(VulkanBuffer* buffer, uint64_t offset, uint64_t size, const void* data)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	vk::Buffer source;
+	uint64_t source_offset;
+	uint8_t* staging_data;
+
+	if (!allocate_staging(size, source, source_offset, staging_data))
+	{
+		sl::log_error("Failed to allocate staging memory for a buffer upload of {} bytes.", size);
+		return 0;
+	}
+
+	memcpy(staging_data, data, size);
+
+	UploadBatch& batch = get_recording_batch();
+
+	vk::BufferCopy buffer_copy(
+		source_offset,
+		offset,
+		size
+	);
+
+	batch.command_buffer->handle.copyBuffer(source, buffer->handle, 1, &buffer_copy);
+
+	batch.buffer_barriers.push_back(vk::BufferMemoryBarrier(
+		vk::AccessFlagBits::eTransferWrite,
+		consumer_access,
+		get_source_queue_family(),
+		get_destination_queue_family(),
+		buffer->handle,
+		offset,
+		size
+	));
+
+	batch.staging_end = staging_head;
+
+	return batch.ticket;
+}
+
+UploadTicket upload_system_upload_image(Image* image, uint64_t size, const void* data)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	vk::Buffer source;
+	uint64_t source_offset;
+	uint8_t* staging_data;
+
+	if (!allocate_staging(size, source, source_offset, staging_data))
+	{
+		sl::log_error("Failed to allocate staging memory for an image upload of {} bytes.", size);
+		return 0;
+	}
+
+	memcpy(staging_data, data, size);
+
+	UploadBatch& batch = get_recording_batch();
+
+	// Transition the image layout from undefined to optimal for receiving data.
+	image->transition_layout(
+		batch.command_buffer.get(),
+		vk::ImageLayout::eUndefined,
+		vk::ImageLayout::eTransferDstOptimal
+	);
+
+	image->copy_from_buffer(batch.command_buffer.get(), source, source_offset);
+
+	// The transition to the shader read only layout is recorded together with all others at the end of the batch.
+	batch.image_barriers.push_back(vk::ImageMemoryBarrier(
+		vk::AccessFlagBits::eTransferWrite,
+		vk::AccessFlagBits::eShaderRead,
+		vk::ImageLayout::eTransferDstOptimal,
+		vk::ImageLayout::eShaderReadOnlyOptimal,
+		get_source_queue_family(),
+		get_destination_queue_family(),
+		image->handle,
+		vk::ImageSubresourceRange(
+			vk::ImageAspectFlagBits::eColor,
+			0,
+			image->mip_levels,
+			0,
+			1
+		)
+	));
+
+	batch.staging_end = staging_head;
+
+	return batch.ticket;
+}
+
+UploadTicket upload_system_flush()
+{
+	LPROFILE_FUNCTION();
+
+	UploadBatch& batch = batches[current_batch];
+
+	if (!batch.is_recording)
+	{
+		// Nothing has been recorded since the previous flush.
+		return next_ticket - 1;
+	}
+
+	if (p_device->has_dedicated_transfer_queue())
+	{
+		// Release the written resources to the graphics queue family. The destination stage and access are ignored.
+		batch.command_buffer->handle.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eBottomOfPipe,
+			{},
+			0, nullptr,
+			batch.buffer_barriers.size(), batch.buffer_barriers.data(),
+			batch.image_barriers.size(), batch.image_barriers.data()
+		);
+
+		// The graphics queue acquires the resources using the same barriers. The source access is ignored there.
+		for (auto& barrier : batch.buffer_barriers)
+		{
+			barrier.srcAccessMask = {};
+			pending_buffer_acquires.push_back(barrier);
+		}
+
+		for (auto& barrier : batch.image_barriers)
+		{
+			barrier.srcAccessMask = {};
+			pending_image_acquires.push_back(barrier);
+		}
+	}
+	else
+	{
+		// Make the copies visible to everything that reads from buffers or samples images afterwards.
+		vk::MemoryBarrier memory_barrier(vk::AccessFlagBits::eTransferWrite, consumer_access);
+
+		batch.command_buffer->handle.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			consumer_stages,
+			{},
+			batch.buffer_barriers.empty() ? 0 : 1, &memory_barrier,
+			0, nullptr,
+			batch.image_barriers.size(), batch.image_barriers.data()
+		);
+	}
+
+	batch.buffer_barriers.clear();
+	batch.image_barriers.clear();
+
+	batch.command_buffer->end();
+
+	batch.fence->reset();
+
+	vk::SubmitInfo submit_info(
+		0,
+		nullptr,
+		nullptr,
+		1,
+		&batch.command_buffer->handle
+	);
+
+	vk::Result r = p_device->transfer_queue.submit(1, &submit_info, batch.fence->handle);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to submit an upload batch.");
+	}
+
+	batch.command_buffer->set_state(CommandBufferState::SUBMITTED);
+
+	batch.is_recording = false;
+	batch.is_submitted = true;
+
+	next_ticket++;
+	current_batch = (current_batch + 1) % LUPLOAD_SYSTEM_MAX_BATCHES;
+
+	return batch.ticket;
+}
+
+bool upload_system_acquire(const CommandBuffer* command_buffer, vk::Semaphore semaphore)
+{
+	upload_system_flush();
+
+	if (pending_buffer_acquires.empty() && pending_image_acquires.empty())
+	{
+		return false;
+	}
+
+	// A semaphore signal covers everything submitted to the queue before it, so a single signal after all batches is
+	// enough to wait on all pending releases.
+	vk::SubmitInfo submit_info(
+		0,
+		nullptr,
+		nullptr,
+		0,
+		nullptr,
+		1,
+		&semaphore
+	);
+
+	vk::Result r = p_device->transfer_queue.submit(1, &submit_info, nullptr);
+
+	if (r != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to signal the upload semaphore.");
+		return false;
+	}
+
+	command_buffer->handle.pipelineBarrier(
+		LUPLOAD_SYSTEM_WAIT_STAGES,
+		consumer_stages,
+		{},
+		0, nullptr,
+		pending_buffer_acquires.size(), pending_buffer_acquires.data(),
+		pending_image_acquires.size(), pending_image_acquires.data()
+	);
+
+	pending_buffer_acquires.clear();
+	pending_image_acquires.clear();
+
+	return true;
+}
+
+void upload_system_update()
+{
+	// Retire finished batches in submission order.
+	while (UploadBatch* batch = get_oldest_submitted_batch())
+	{
+		if (p_device->logical_device.getFenceStatus(batch->fence->handle) != vk::Result::eSuccess)
+		{
+			break;
+		}
+
+		batch->fence->is_signaled = true;
+
+		retire_batch(*batch);
+	}
+}
+
+bool upload_system_is_complete(UploadTicket ticket)
+{
+	if (ticket > completed_ticket)
+	{
+		upload_system_update();
+	}
+
+	return ticket <= completed_ticket;
+}
+
+bool upload_system_wait(UploadTicket ticket)
+{
+	if (ticket <= completed_ticket)
+	{
+		return true;
+	}
+
+	if (ticket >= next_ticket)
+	{
+		upload_system_flush();
+	}
+
+	while (completed_ticket < ticket)
+	{
+		UploadBatch* batch = get_oldest_submitted_batch();
+
+		if (!batch)
+		{
+			// Only possible for tickets that were never handed out.
+			return false;
+		}
+
+		if (!batch->fence->wait())
+		{
+			sl::log_error("Failed to wait for an upload batch.");
+			return false;
+		}
+
+		retire_batch(*batch);
+	}
+
+	return true;
+}
+
+// Static helper functions.
+static UploadBatch& get_recording_batch()
+{
+	UploadBatch& batch = batches[current_batch];
+
+	if (batch.is_recording)
+	{
+		return batch;
+	}
+
+	// The batch slot is reused, so its previous submission has to be finished.
+	if (batch.is_submitted)
+	{
+		upload_system_wait(batch.ticket);
+	}
+
+	batch.command_buffer->reset();
+	batch.command_buffer->begin(true, false, false);
+
+	batch.ticket = next_ticket;
+	batch.staging_end = staging_head;
+	batch.is_recording = true;
+
+	return batch;
+}
+
+static bool allocate_staging(uint64_t size, vk::Buffer& out_buffer, uint64_t& out_offset, uint8_t*& out_data)
+{
+	if (size > LUPLOAD_SYSTEM_STAGING_SIZE)
+	{
+		// The upload does not fit in the ring, give it a staging buffer of its own.
+		auto temporary_buffer = VulkanBuffer::create(
+			p_device,
+			size,
+			vk::BufferUsageFlagBits::eTransferSrc,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+			true,
+			true
+		);
+
+		if (!temporary_buffer)
+		{
+			return false;
+		}
+
+		out_buffer = temporary_buffer->handle;
+		out_offset = 0;
+		out_data = static_cast<uint8_t*>(temporary_buffer->mapped_data);
+
+		get_recording_batch().temporary_buffers.push_back(std::move(temporary_buffer));
+
+		return true;
+	}
+
+	uint64_t offset = align(staging_head, staging_alignment);
+
+	// Allocations never wrap around the end of the ring, skip to the start of the ring instead.
+	if (offset % LUPLOAD_SYSTEM_STAGING_SIZE + size > LUPLOAD_SYSTEM_STAGING_SIZE)
+	{
+		offset = align(offset, LUPLOAD_SYSTEM_STAGING_SIZE);
+	}
+
+	// Wait for older batches until enough of the ring is free.
+	while (offset + size - staging_tail > LUPLOAD_SYSTEM_STAGING_SIZE)
+	{
+		UploadBatch* oldest = get_oldest_submitted_batch();
+
+		if (oldest)
+		{
+			upload_system_wait(oldest->ticket);
+		}
+		else if (batches[current_batch].is_recording)
+		{
+			// The batch that is being recorded fills the ring by itself.
+			upload_system_wait(upload_system_flush());
+		}
+		else
+		{
+			// Nothing is in flight anymore, so the skipped end of the ring is free as well.
+			staging_tail = offset;
+		}
+	}
+
+	staging_head = offset + size;
+
+	out_buffer = staging_buffer->handle;
+	out_offset = offset % LUPLOAD_SYSTEM_STAGING_SIZE;
+	out_data = static_cast<uint8_t*>(staging_buffer->mapped_data) + out_offset;
+
+	return true;
+}
+
+static UploadBatch* get_oldest_submitted_batch()
+{
+	UploadBatch* oldest = nullptr;
+
+	for (auto& batch : batches)
+	{
+		if (batch.is_submitted && (!oldest || batch.ticket < oldest->ticket))
+		{
+			oldest = &batch;
+		}
+	}
+
+	return oldest;
+}
+
+static void retire_batch(UploadBatch& batch)
+{
+	batch.temporary_buffers.clear();
+
+	staging_tail = std::max(staging_tail, batch.staging_end);
+	completed_ticket = std::max(completed_ticket, batch.ticket);
+
+	batch.is_submitted = false;
+}
+
+static uint32_t get_source_queue_family()
+{
+	// Ownership only has to be transferred between different queue families.
+	if (!p_device->has_dedicated_transfer_queue())
+	{
+		return VK_QUEUE_FAMILY_IGNORED;
+	}
+
+	return p_device->queue_indices.transfer_queue_index;
+}
+
+static uint32_t get_destination_queue_family()
+{
+	if (!p_device->has_dedicated_transfer_queue())
+	{
+		return VK_QUEUE_FAMILY_IGNORED;
+	}
+
+	return p_device->queue_indices.graphics_queue_index;
+}
+
+}
@@ -0,0 +1,825 @@
+#include "renderer/texture_format.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "core/profiler.hpp"
+
+namespace lise
+{
+
+/**
+ * @brief The pixels of a decoded 4x4 block, row by row, with four channels per pixel.
+ */
+typedef uint8_t DecodedBlock[16][4];
+
+static uint32_t get_block_byte_size(vk::Format format);
+
+static void decode_bc1(const uint8_t* block, DecodedBlock& out, bool has_alpha, bool is_four_color_only);
+static void decode_bc3_alpha(const uint8_t* block, DecodedBlock& out);
+static void decode_bc7(const uint8_t* block, DecodedBlock& out);
+static void decode_etc2_rgb(const uint8_t* block, DecodedBlock& out);
+static void decode_eac_alpha(const uint8_t* block, DecodedBlock& out);
+
+bool texture_format_is_known(vk::Format format)
+{
+	return format == vk::Format::eR8G8B8A8Unorm || format == vk::Format::eR8G8B8A8Srgb ||
+		texture_format_is_block_compressed(format);
+}
+
+bool texture_format_is_block_compressed(vk::Format format)
+{
+	return get_block_byte_size(format) != 0;
+}
+
+uint64_t texture_format_get_byte_size(vk::Format format, vector2ui size)
+{
+	uint32_t block_byte_size = get_block_byte_size(format);
+
+	if (block_byte_size == 0)
+	{
+		// Four channel, eight bit pixels.
+		return (uint64_t) size.w * size.h * 4;
+	}
+
+	return (uint64_t) ((size.w + 3) / 4) * ((size.h + 3) / 4) * block_byte_size;
+}
+
+bool texture_format_is_supported(const Device* device, vk::Format format)
+{
+	switch (format)
+	{
+	case vk::Format::eBc1RgbUnormBlock:
+	case vk::Format::eBc1RgbSrgbBlock:
+	case vk::Format::eBc1RgbaUnormBlock:
+	case vk::Format::eBc1RgbaSrgbBlock:
+	case vk::Format::eBc3UnormBlock:
+	case vk::Format::eBc3SrgbBlock:
+	case vk::Format::eBc7UnormBlock:
+	case vk::Format::eBc7SrgbBlock:
+		if (!device->enabled_features.textureCompressionBC)
+		{
+			return false;
+		}
+		break;
+	case vk::Format::eEtc2R8G8B8UnormBlock:
+	case vk::Format::eEtc2R8G8B8SrgbBlock:
+	case vk::Format::eEtc2R8G8B8A8UnormBlock:
+	case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+		if (!device->enabled_features.textureCompressionETC2)
+		{
+			return false;
+		}
+		break;
+	default:
+		break;
+	}
+
+	vk::FormatProperties properties = device->physical_device.getFormatProperties(format);
+
+	vk::FormatFeatureFlags required_features =
+		vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eTransferDst;
+
+	return (properties.optimalTilingFeatures & required_features) == required_features;
+}
+
+vk::Format texture_format_get_decoded_format(vk::Format format)
+{
+	switch (format)
+	{
+	case vk::Format::eR8G8B8A8Srgb:
+	case vk::Format::eBc1RgbSrgbBlock:
+	case vk::Format::eBc1RgbaSrgbBlock:
+	case vk::Format::eBc3SrgbBlock:
+	case vk::Format::eBc7SrgbBlock:
+	case vk::Format::eEtc2R8G8B8SrgbBlock:
+	case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+		return vk::Format::eR8G8B8A8Srgb;
+	default:
+		return vk::Format::eR8G8B8A8Unorm;
+	}
+}
+
+bool texture_format_decode(vk::Format format, const uint8_t* blocks, vector2ui size, uint8_t* out_pixels)
+{
+	LPROFILE_FUNCTION();
+
+	uint32_t block_byte_size = get_block_byte_size(format);
+
+	if (block_byte_size == 0)
+	{
+		return false;
+	}
+
+	uint32_t block_columns = (size.w + 3) / 4;
+	uint32_t block_rows = (size.h + 3) / 4;
+
+	for (uint32_t by = 0; by < block_rows; by++)
+	{
+		for (uint32_t bx = 0; bx < block_columns; bx++)
+		{
+			const uint8_t* block = blocks + ((uint64_t) by * block_columns + bx) * block_byte_size;
+
+			DecodedBlock decoded;
+
+			switch (format)
+			{
+			case vk::Format::eBc1RgbUnormBlock:
+			case vk::Format::eBc1RgbSrgbBlock:
+				decode_bc1(block, decoded, false, false);
+				break;
+			case vk::Format::eBc1RgbaUnormBlock:
+			case vk::Format::eBc1RgbaSrgbBlock:
+				decode_bc1(block, decoded, true, false);
+				break;
+			case vk::Format::eBc3UnormBlock:
+			case vk::Format::eBc3SrgbBlock:
+				// The color block of BC3 always uses four colors.
+				decode_bc1(block + 8, decoded, false, true);
+				decode_bc3_alpha(block, decoded);
+				break;
+			case vk::Format::eBc7UnormBlock:
+			case vk::Format::eBc7SrgbBlock:
+				decode_bc7(block, decoded);
+				break;
+			case vk::Format::eEtc2R8G8B8UnormBlock:
+			case vk::Format::eEtc2R8G8B8SrgbBlock:
+				decode_etc2_rgb(block, decoded);
+				break;
+			default:
+				decode_etc2_rgb(block + 8, decoded);
+				decode_eac_alpha(block, decoded);
+				break;
+			}
+
+			// Blocks at the right and bottom edges can hang over the edge of the image.
+			uint32_t width = std::min(4u, size.w - bx * 4);
+			uint32_t height = std::min(4u, size.h - by * 4);
+
+			for (uint32_t y = 0; y < height; y++)
+			{
+				uint8_t* row = out_pixels + (((uint64_t) by * 4 + y) * size.w + bx * 4) * 4;
+
+				memcpy(row, decoded[y * 4], width * 4);
+			}
+		}
+	}
+
+	return true;
+}
+
+// Static helper functions.
+static uint32_t get_block_byte_size(vk::Format format)
+{
+	switch (format)
+	{
+	case vk::Format::eBc1RgbUnormBlock:
+	case vk::Format::eBc1RgbSrgbBlock:
+	case vk::Format::eBc1RgbaUnormBlock:
+	case vk::Format::eBc1RgbaSrgbBlock:
+	case vk::Format::eEtc2R8G8B8UnormBlock:
+	case vk::Format::eEtc2R8G8B8SrgbBlock:
+		return 8;
+	case vk::Format::eBc3UnormBlock:
+	case vk::Format::eBc3SrgbBlock:
+	case vk::Format::eBc7UnormBlock:
+	case vk::Format::eBc7SrgbBlock:
+	case vk::Format::eEtc2R8G8B8A8UnormBlock:
+	case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+static uint8_t clamp_to_byte(int32_t value)
+{
+	return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+static void decode_bc1(const uint8_t* block, DecodedBlock& out, bool has_alpha, bool is_four_color_only)
+{
+	uint16_t c0 = block[0] | block[1] << 8;
+	uint16_t c1 = block[2] | block[3] << 8;
+	uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | (uint32_t) block[7] << 24;
+
+	// Expand the 5:6:5 endpoints to eight bits per channel.
+	uint8_t colors[4][4];
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		uint16_t c = i == 0 ? c0 : c1;
+
+		uint8_t r = (c >> 11) & 0x1F;
+		uint8_t g = (c >> 5) & 0x3F;
+		uint8_t b = c & 0x1F;
+
+		colors[i][0] = r << 3 | r >> 2;
+		colors[i][1] = g << 2 | g >> 4;
+		colors[i][2] = b << 3 | b >> 2;
+		colors[i][3] = 255;
+	}
+
+	// BC1 blocks with c0 <= c1 use three colors and a black fourth color, which is transparent if the format has
+	// alpha. The color blocks of BC3 always use four colors.
+	bool is_four_color = c0 > c1 || is_four_color_only;
+
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		if (is_four_color)
+		{
+			colors[2][c] = (2 * colors[0][c] + colors[1][c] + 1) / 3;
+			colors[3][c] = (colors[0][c] + 2 * colors[1][c] + 1) / 3;
+		}
+		else
+		{
+			colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+			colors[3][c] = 0;
+		}
+	}
+
+	colors[2][3] = 255;
+	colors[3][3] = (is_four_color || !has_alpha) ? 255 : 0;
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		memcpy(out[i], colors[(indices >> (i * 2)) & 3], 4);
+	}
+}
+
+static void decode_bc3_alpha(const uint8_t* block, DecodedBlock& out)
+{
+	uint8_t alphas[8];
+	alphas[0] = block[0];
+	alphas[1] = block[1];
+
+	if (alphas[0] > alphas[1])
+	{
+		for (uint32_t i = 1; i < 7; i++)
+		{
+			alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1] + 3) / 7;
+		}
+	}
+	else
+	{
+		for (uint32_t i = 1; i < 5; i++)
+		{
+			alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1] + 2) / 5;
+		}
+
+		alphas[6] = 0;
+		alphas[7] = 255;
+	}
+
+	uint64_t indices = 0;
+
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		indices |= (uint64_t) block[2 + i] << (i * 8);
+	}
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		out[i][3] = alphas[(indices >> (i * 3)) & 7];
+	}
+}
+
+/**
+ * @brief Reads the bits of a 128 bit block, starting at the least significant bit of the first byte.
+ */
+struct BlockBitReader
+{
+	const uint8_t* block;
+	uint32_t position;
+
+	uint32_t read(uint32_t bit_count)
+	{
+		uint32_t value = 0;
+
+		for (uint32_t i = 0; i < bit_count; i++, position++)
+		{
+			value |= ((block[position >> 3] >> (position & 7)) & 1) << i;
+		}
+
+		return value;
+	}
+};
+
+/**
+ * @brief The subsets of the pixels of the BC7 partitions with two subsets. Bit i is set if pixel i is in the second
+ * subset.
+ */
+static const uint16_t bc7_partitions_2[64] = {
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+	0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+	0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+	0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+	0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+
+/**
+ * @brief The subsets of the pixels of the BC7 partitions with three subsets, two bits per pixel.
+ */
+static const uint32_t bc7_partitions_3[64] = {
+	0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+	0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+	0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+	0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+	0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+	0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+	0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+	0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+};
+
+/**
+ * @brief The anchor pixels of the second subset of the partitions with two subsets, and of the second and third
+ * subsets of the partitions with three subsets. The anchor pixel of the first subset is always pixel 0.
+ */
+static const uint8_t bc7_anchors_2[64] = {
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+	15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+	 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+};
+
+static const uint8_t bc7_anchors_3_second[64] = {
+	 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+	 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+	 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+	 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+};
+
+static const uint8_t bc7_anchors_3_third[64] = {
+	15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+	15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+	15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+	15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+};
+
+static const uint8_t bc7_weights_2[4] = { 0, 21, 43, 64 };
+static const uint8_t bc7_weights_3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t bc7_weights_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/**
+ * @brief The layout of a BC7 mode.
+ */
+struct Bc7Mode
+{
+	uint8_t subset_count;
+	uint8_t partition_bits;
+	uint8_t rotation_bits;
+	uint8_t index_selection_bits;
+	uint8_t color_bits;
+	uint8_t alpha_bits;
+	uint8_t endpoint_p_bits;
+	uint8_t shared_p_bits;
+	uint8_t index_bits;
+	uint8_t secondary_index_bits;
+};
+
+static const Bc7Mode bc7_modes[8] = {
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+
+static uint8_t bc7_interpolate(uint8_t e0, uint8_t e1, uint32_t index, uint32_t index_bits)
+{
+	const uint8_t* weights = index_bits == 2 ? bc7_weights_2 : index_bits == 3 ? bc7_weights_3 : bc7_weights_4;
+
+	return static_cast<uint8_t>(((64 - weights[index]) * e0 + weights[index] * e1 + 32) >> 6);
+}
+
+static void decode_bc7(const uint8_t* block, DecodedBlock& out)
+{
+	if (block[0] == 0)
+	{
+		// Reserved mode, which decodes to transparent black.
+		memset(out, 0, sizeof(DecodedBlock));
+		return;
+	}
+
+	uint32_t mode_index = std::countr_zero(block[0]);
+	const Bc7Mode& mode = bc7_modes[mode_index];
+
+	BlockBitReader reader = { block, mode_index + 1 };
+
+	uint32_t partition = reader.read(mode.partition_bits);
+	uint32_t rotation = reader.read(mode.rotation_bits);
+	uint32_t index_selection = reader.read(mode.index_selection_bits);
+
+	// Two endpoints per subset, with four channels each.
+	uint32_t endpoint_count = mode.subset_count * 2;
+	uint8_t endpoints[6][4];
+
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		for (uint32_t e = 0; e < endpoint_count; e++)
+		{
+			endpoints[e][c] = reader.read(mode.color_bits);
+		}
+	}
+
+	for (uint32_t e = 0; e < endpoint_count; e++)
+	{
+		endpoints[e][3] = mode.alpha_bits > 0 ? reader.read(mode.alpha_bits) : 255;
+	}
+
+	// Append the p-bits, and expand the endpoints to eight bits.
+	uint32_t p_bits[6] = {};
+
+	if (mode.endpoint_p_bits)
+	{
+		for (uint32_t e = 0; e < endpoint_count; e++)
+		{
+			p_bits[e] = reader.read(1);
+		}
+	}
+	else if (mode.shared_p_bits)
+	{
+		for (uint32_t s = 0; s < mode.subset_count; s++)
+		{
+			p_bits[s * 2] = p_bits[s * 2 + 1] = reader.read(1);
+		}
+	}
+
+	bool has_p_bits = mode.endpoint_p_bits || mode.shared_p_bits;
+
+	for (uint32_t e = 0; e < endpoint_count; e++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			uint32_t bits = c < 3 ? mode.color_bits : mode.alpha_bits;
+
+			if (bits == 0)
+			{
+				continue;
+			}
+
+			uint32_t value = endpoints[e][c];
+
+			if (has_p_bits)
+			{
+				value = value << 1 | p_bits[e];
+				bits++;
+			}
+
+			endpoints[e][c] = static_cast<uint8_t>(value << (8 - bits) | value >> (2 * bits - 8));
+		}
+	}
+
+	// Find the subset and anchor pixels.
+	uint8_t subsets[16];
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		if (mode.subset_count == 2)
+		{
+			subsets[i] = (bc7_partitions_2[partition] >> i) & 1;
+		}
+		else if (mode.subset_count == 3)
+		{
+			subsets[i] = (bc7_partitions_3[partition] >> (i * 2)) & 3;
+		}
+		else
+		{
+			subsets[i] = 0;
+		}
+	}
+
+	auto is_anchor = [&](uint32_t pixel)
+	{
+		if (pixel == 0)
+		{
+			return true;
+		}
+
+		if (mode.subset_count == 2)
+		{
+			return pixel == bc7_anchors_2[partition];
+		}
+
+		if (mode.subset_count == 3)
+		{
+			return pixel == bc7_anchors_3_second[partition] || pixel == bc7_anchors_3_third[partition];
+		}
+
+		return false;
+	};
+
+	// Anchor pixels have one index bit less, as their most significant bit is always zero.
+	uint8_t indices[16];
+	uint8_t secondary_indices[16] = {};
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		indices[i] = reader.read(mode.index_bits - is_anchor(i));
+	}
+
+	if (mode.secondary_index_bits)
+	{
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			secondary_indices[i] = reader.read(mode.secondary_index_bits - (i == 0));
+		}
+	}
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		const uint8_t* e0 = endpoints[subsets[i] * 2];
+		const uint8_t* e1 = endpoints[subsets[i] * 2 + 1];
+
+		uint32_t color_index = indices[i];
+		uint32_t color_index_bits = mode.index_bits;
+		uint32_t alpha_index = indices[i];
+		uint32_t alpha_index_bits = mode.index_bits;
+
+		// Modes 4 and 5 have separate alpha indices. Mode 4 can swap the two sets of indices.
+		if (mode.secondary_index_bits)
+		{
+			alpha_index = secondary_indices[i];
+			alpha_index_bits = mode.secondary_index_bits;
+
+			if (index_selection)
+			{
+				std::swap(color_index, alpha_index);
+				std::swap(color_index_bits, alpha_index_bits);
+			}
+		}
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			out[i][c] = bc7_interpolate(e0[c], e1[c], color_index, color_index_bits);
+		}
+
+		out[i][3] = bc7_interpolate(e0[3], e1[3], alpha_index, alpha_index_bits);
+
+		// Modes 4 and 5 can store one of the color channels in the alpha channel.
+		if (rotation)
+		{
+			std::swap(out[i][3], out[i][rotation - 1]);
+		}
+	}
+}
+
+static const int32_t etc1_modifiers[8][4] = {
+	{ 2, 8, -2, -8 },
+	{ 5, 17, -5, -17 },
+	{ 9, 29, -9, -29 },
+	{ 13, 42, -13, -42 },
+	{ 18, 60, -18, -60 },
+	{ 24, 80, -24, -80 },
+	{ 33, 106, -33, -106 },
+	{ 47, 183, -47, -183 }
+};
+
+static const int32_t etc2_distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static void decode_etc2_rgb(const uint8_t* block, DecodedBlock& out)
+{
+	// Pixel indices are stored column by column, with the most significant bits in the upper half.
+	uint32_t pixel_bits = block[4] << 24 | block[5] << 16 | block[6] << 8 | block[7];
+
+	auto get_pixel_index = [&](uint32_t x, uint32_t y)
+	{
+		uint32_t i = x * 4 + y;
+
+		return ((pixel_bits >> (i + 16)) & 1) << 1 | ((pixel_bits >> i) & 1);
+	};
+
+	auto extend_4 = [](int32_t value) { return value << 4 | value; };
+	auto extend_5 = [](int32_t value) { return value << 3 | value >> 2; };
+
+	bool is_differential = block[3] & 2;
+
+	int32_t r = block[0] >> 3;
+	int32_t g = block[1] >> 3;
+	int32_t b = block[2] >> 3;
+
+	// Differential blocks whose second color overflows select one of the modes added by ETC2.
+	int32_t r2 = r + ((block[0] & 7) ^ 4) - 4;
+	int32_t g2 = g + ((block[1] & 7) ^ 4) - 4;
+	int32_t b2 = b + ((block[2] & 7) ^ 4) - 4;
+
+	if (is_differential && (r2 < 0 || r2 > 31))
+	{
+		// T mode.
+		int32_t colors[2][3] = {
+			{
+				extend_4(((block[0] >> 3) & 3) << 2 | (block[0] & 3)),
+				extend_4(block[1] >> 4),
+				extend_4(block[1] & 0xF)
+			},
+			{
+				extend_4(block[2] >> 4),
+				extend_4(block[2] & 0xF),
+				extend_4(block[3] >> 4)
+			}
+		};
+
+		int32_t distance = etc2_distances[((block[3] >> 2) & 3) << 1 | (block[3] & 1)];
+
+		int32_t paint[4][3];
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			paint[0][c] = colors[0][c];
+			paint[1][c] = colors[1][c] + distance;
+			paint[2][c] = colors[1][c];
+			paint[3][c] = colors[1][c] - distance;
+		}
+
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				const int32_t* color = paint[get_pixel_index(x, y)];
+
+				out[y * 4 + x][0] = clamp_to_byte(color[0]);
+				out[y * 4 + x][1] = clamp_to_byte(color[1]);
+				out[y * 4 + x][2] = clamp_to_byte(color[2]);
+				out[y * 4 + x][3] = 255;
+			}
+		}
+
+		return;
+	}
+
+	if (is_differential && (g2 < 0 || g2 > 31))
+	{
+		// H mode.
+		int32_t packed[2] = {
+			((block[0] >> 3) & 0xF) << 8 |
+				((block[0] & 7) << 1 | ((block[1] >> 4) & 1)) << 4 |
+				((block[1] & 8) | (block[1] & 3) << 1 | block[2] >> 7),
+			((block[2] >> 3) & 0xF) << 8 |
+				((block[2] & 7) << 1 | block[3] >> 7) << 4 |
+				((block[3] >> 3) & 0xF)
+		};
+
+		int32_t distance = etc2_distances[(block[3] & 4) | (block[3] & 1) << 1 | (packed[0] >= packed[1])];
+
+		int32_t paint[4][3];
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			int32_t c0 = extend_4((packed[0] >> ((2 - c) * 4)) & 0xF);
+			int32_t c1 = extend_4((packed[1] >> ((2 - c) * 4)) & 0xF);
+
+			paint[0][c] = c0 + distance;
+			paint[1][c] = c0 - distance;
+			paint[2][c] = c1 + distance;
+			paint[3][c] = c1 - distance;
+		}
+
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				const int32_t* color = paint[get_pixel_index(x, y)];
+
+				out[y * 4 + x][0] = clamp_to_byte(color[0]);
+				out[y * 4 + x][1] = clamp_to_byte(color[1]);
+				out[y * 4 + x][2] = clamp_to_byte(color[2]);
+				out[y * 4 + x][3] = 255;
+			}
+		}
+
+		return;
+	}
+
+	if (is_differential && (b2 < 0 || b2 > 31))
+	{
+		// Planar mode. The colors at the origin, and one block to the right and down, are interpolated.
+		int32_t ro = (block[0] >> 1) & 0x3F;
+		int32_t go = (block[0] & 1) << 6 | ((block[1] >> 1) & 0x3F);
+		int32_t bo = (block[1] & 1) << 5 | (block[2] & 0x18) | (block[2] & 3) << 1 | block[3] >> 7;
+		int32_t rh = ((block[3] >> 2) & 0x1F) << 1 | (block[3] & 1);
+		int32_t gh = block[4] >> 1;
+		int32_t bh = (block[4] & 1) << 5 | block[5] >> 3;
+		int32_t rv = (block[5] & 7) << 3 | block[6] >> 5;
+		int32_t gv = (block[6] & 0x1F) << 2 | block[7] >> 6;
+		int32_t bv = block[7] & 0x3F;
+
+		auto extend_6 = [](int32_t value) { return value << 2 | value >> 4; };
+		auto extend_7 = [](int32_t value) { return value << 1 | value >> 6; };
+
+		int32_t origin[3] = { extend_6(ro), extend_7(go), extend_6(bo) };
+		int32_t horizontal[3] = { extend_6(rh), extend_7(gh), extend_6(bh) };
+		int32_t vertical[3] = { extend_6(rv), extend_7(gv), extend_6(bv) };
+
+		for (int32_t y = 0; y < 4; y++)
+		{
+			for (int32_t x = 0; x < 4; x++)
+			{
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					int32_t value =
+						(x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+
+					out[y * 4 + x][c] = clamp_to_byte(value);
+				}
+
+				out[y * 4 + x][3] = 255;
+			}
+		}
+
+		return;
+	}
+
+	// The individual and differential modes of ETC1. The block is split into two halves with a base color each.
+	int32_t base[2][3];
+
+	if (is_differential)
+	{
+		base[0][0] = extend_5(r);
+		base[0][1] = extend_5(g);
+		base[0][2] = extend_5(b);
+		base[1][0] = extend_5(r2);
+		base[1][1] = extend_5(g2);
+		base[1][2] = extend_5(b2);
+	}
+	else
+	{
+		base[0][0] = extend_4(block[0] >> 4);
+		base[0][1] = extend_4(block[1] >> 4);
+		base[0][2] = extend_4(block[2] >> 4);
+		base[1][0] = extend_4(block[0] & 0xF);
+		base[1][1] = extend_4(block[1] & 0xF);
+		base[1][2] = extend_4(block[2] & 0xF);
+	}
+
+	const int32_t* modifiers[2] = { etc1_modifiers[block[3] >> 5], etc1_modifiers[(block[3] >> 2) & 7] };
+
+	bool is_flipped = block[3] & 1;
+
+	for (uint32_t y = 0; y < 4; y++)
+	{
+		for (uint32_t x = 0; x < 4; x++)
+		{
+			uint32_t half = is_flipped ? y >= 2 : x >= 2;
+
+			int32_t modifier = modifiers[half][get_pixel_index(x, y)];
+
+			out[y * 4 + x][0] = clamp_to_byte(base[half][0] + modifier);
+			out[y * 4 + x][1] = clamp_to_byte(base[half][1] + modifier);
+			out[y * 4 + x][2] = clamp_to_byte(base[half][2] + modifier);
+			out[y * 4 + x][3] = 255;
+		}
+	}
+}
+
+static const int32_t eac_modifiers[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static void decode_eac_alpha(const uint8_t* block, DecodedBlock& out)
+{
+	int32_t base = block[0];
+	int32_t multiplier = block[1] >> 4;
+	const int32_t* modifiers = eac_modifiers[block[1] & 0xF];
+
+	// Three bit indices, column by column, starting at the most significant bit.
+	uint64_t indices = 0;
+
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		indices = indices << 8 | block[2 + i];
+	}
+
+	for (uint32_t x = 0; x < 4; x++)
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			uint32_t index = (indices >> (45 - (x * 4 + y) * 3)) & 7;
+
+			out[y * 4 + x][3] = clamp_to_byte(base + modifiers[index] * multiplier);
+		}
+	}
+}
+
+}
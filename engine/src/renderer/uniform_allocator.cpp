@@ -0,0 +1,135 @@
+#include "renderer/uniform_allocator.hpp"
+
+#include <algorithm>
+
+#include <simple-logger.hpp>
+
+#define align(x, n) (((x - 1) | (n - 1)) + 1)
+
+namespace lise
+{
+
+static bool has_memory_type(const Device* device, vk::MemoryPropertyFlags flags);
+
+std::unique_ptr<FrameUniformAllocator> FrameUniformAllocator::create(
+	const Device* device,
+	uint64_t region_size,
+	uint32_t frame_count,
+	uint64_t static_size
+)
+{
+	auto out = std::make_unique<FrameUniformAllocator>();
+
+	// Copy trivial data.
+	out->device = device;
+	out->alignment = device->physical_device_properties.limits.minUniformBufferOffsetAlignment;
+	out->region_size = align(region_size, out->alignment);
+	out->static_size = align(std::min(static_size, region_size), out->alignment);
+	out->static_heads.resize(frame_count, 0);
+	out->frame_count = frame_count;
+	out->current_frame = 0;
+	out->region_head = out->static_size;
+	out->frame_number = 0;
+	out->has_overflowed = false;
+
+	// Prefer memory the GPU can read quickly, but fall back to plain host visible memory.
+	vk::MemoryPropertyFlags memory_flags =
+		vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible |
+		vk::MemoryPropertyFlagBits::eHostCoherent;
+
+	if (!has_memory_type(device, memory_flags))
+	{
+		memory_flags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	}
+
+	out->buffer = VulkanBuffer::create(
+		device,
+		out->region_size * frame_count,
+		vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+		memory_flags,
+		true,
+		true
+	);
+
+	if (!out->buffer)
+	{
+		sl::log_error("Failed to create the uniform allocator buffer.");
+		return nullptr;
+	}
+
+	out->mapped_data = static_cast<uint8_t*>(out->buffer->mapped_data);
+
+	return out;
+}
+
+void FrameUniformAllocator::begin_frame(uint32_t frame)
+{
+	current_frame = frame;
+	region_head = static_size;
+	has_overflowed = false;
+
+	frame_number++;
+}
+
+UniformAllocation FrameUniformAllocator::allocate(uint64_t size)
+{
+	uint64_t offset = align(region_head, alignment);
+
+	if (offset + size > region_size)
+	{
+		if (!has_overflowed)
+		{
+			sl::log_error("The uniform allocator ran out of memory ({} bytes per frame).", region_size);
+			has_overflowed = true;
+		}
+
+		return UniformAllocation { nullptr, 0 };
+	}
+
+	region_head = offset + size;
+
+	uint64_t buffer_offset = current_frame * region_size + offset;
+
+	return UniformAllocation { mapped_data + buffer_offset, static_cast<uint32_t>(buffer_offset) };
+}
+
+void FrameUniformAllocator::reset_static(uint32_t frame)
+{
+	static_heads[frame] = 0;
+}
+
+UniformAllocation FrameUniformAllocator::allocate_static(uint32_t frame, uint64_t size)
+{
+	uint64_t offset = align(static_heads[frame], alignment);
+
+	if (offset + size > static_size)
+	{
+		sl::log_error("The static part of the uniform allocator ran out of memory ({} bytes per frame).", static_size);
+
+		return UniformAllocation { nullptr, 0 };
+	}
+
+	static_heads[frame] = offset + size;
+
+	uint64_t buffer_offset = frame * region_size + offset;
+
+	return UniformAllocation { mapped_data + buffer_offset, static_cast<uint32_t>(buffer_offset) };
+}
+
+// Static helper functions.
+static bool has_memory_type(const Device* device, vk::MemoryPropertyFlags flags)
+{
+	auto& memory_properties = device->physical_device_memory_properties;
+
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((memory_properties.memoryTypes[i].propertyFlags & flags) == flags)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+}
@@ -2,15 +2,19 @@
 
 #include <memory>
 #include <cstring>
+#include <unordered_map>
 
 #include <simple-logger.hpp>
 
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
 #include "platform/platform.hpp"
 #include "renderer/vulkan_platform.hpp"
 #include "renderer/resource/model.hpp"
 
 #include "renderer/system/texture_system.hpp"
 #include "renderer/system/shader_system.hpp"
+#include "renderer/system/upload_system.hpp"
 
 #include "node/node_tree.hpp"
 
@@ -22,6 +26,8 @@ static vk::Instance instance;
 
 static vk::SurfaceKHR surface;
 
+static bool is_headless;
+
 static Device* device;
 
 static Swapchain* swapchain;
@@ -30,10 +36,35 @@ static RenderPass* ui_render_pass;
 
 static std::vector<std::unique_ptr<CommandBuffer>> graphics_command_buffers;
 
+/**
+ * @brief A secondary command buffer that records part of the world pass, and the command pool it is allocated from.
+ * Every job of every frame has a pool of its own, as a command pool may only be used by one thread at a time.
+ */
+struct RecordingJob
+{
+	vk::CommandPool command_pool;
+	std::unique_ptr<CommandBuffer> command_buffer;
+};
+
+/**
+ * @brief The recording jobs of every frame in flight, one per job system thread.
+ */
+static std::vector<std::vector<RecordingJob>> recording_jobs;
+
 static std::vector<vk::Semaphore> image_available_semaphores;
 
 static std::vector<vk::Semaphore> queue_complete_semaphores;
 
+/**
+ * @brief Signaled by the transfer queue once the uploads handed over to a frame have been written.
+ */
+static std::vector<vk::Semaphore> upload_complete_semaphores;
+
+/**
+ * @brief Whether the current frame acquired uploaded resources, and has to wait on its upload complete semaphore.
+ */
+static bool is_waiting_on_uploads;
+
 static std::vector<std::unique_ptr<Fence>> in_flight_fences;
 
 static std::vector<Fence*> images_in_flight;
@@ -46,6 +77,53 @@ static Shader* ui_shader;
 
 static std::vector<vk::Framebuffer> world_framebuffers;
 
+static std::unique_ptr<GpuTimer> gpu_timer;
+
+static std::unique_ptr<FrameUniformAllocator> uniform_allocator;
+
+/**
+ * @brief Holds the vertices and indices of all meshes.
+ */
+static std::unique_ptr<GeometryArena> geometry_arena;
+
+/**
+ * @brief Culls the render queue on the GPU. nullptr if the device does not support indirect draws, in which case the
+ * render queue is culled on the CPU.
+ */
+static std::unique_ptr<GpuCuller> gpu_culler;
+
+/**
+ * @brief Collects the meshes of all visible models, so copies of the same mesh get drawn using one draw call.
+ */
+static RenderQueue render_queue;
+
+/**
+ * @brief Holds the recorded draws of the static models.
+ */
+static std::unique_ptr<StaticDrawCache> static_draw_cache;
+
+/**
+ * @brief The amount of frames that have been submitted so far.
+ */
+static uint64_t frame_number;
+
+static FrameStats frame_stats;
+
+// Models drawn every frame, and the index of every model in the array.
+static std::vector<std::unique_ptr<Model>> models;
+static std::unordered_map<const Model*, size_t> model_indices;
+
+/**
+ * @brief A model that has been removed from the scene, but might still be in use by a frame in flight.
+ */
+struct PendingModelDestruction
+{
+	std::unique_ptr<Model> model;
+	uint64_t frame_number;
+};
+
+static std::vector<PendingModelDestruction> pending_model_destructions;
+
 #ifdef NDEBUG
 	static constexpr bool enable_validation_layers = false;
 #else
@@ -65,16 +143,18 @@ static std::vector<const char*> device_extensions = {
 // Static helper functions.
 static bool check_validation_layer_support();
 static bool create_command_buffers();
+static bool create_recording_jobs();
+static void destroy_recording_jobs();
+static vk::Viewport get_viewport();
+static vk::Rect2D get_scissor();
+static void set_dynamic_state(CommandBuffer* command_buffer);
+static RenderQueueStats record_render_queue_jobs(CommandBuffer* command_buffer, uint32_t current_frame);
 static bool recreate_swapchain();
 
 // TODO: temp statics
 static mat4x4 view_matrix = LMAT4X4_IDENTITY;
 static Texture* temp_texture;
 
-//static Model test_model;
-static Model* car_model;
-static Model* car2;
-
 struct GlobalUBO
 {
 	mat4x4 projection;
@@ -86,8 +166,10 @@ struct InstanceUBO
 	vector4f diffuse_color;
 };
 
-bool vulkan_initialize(const char* application_name)
+bool vulkan_initialize(const RendererConfig& config)
 {
+	is_headless = config.headless;
+
 	if (enable_validation_layers && !check_validation_layer_support())
 	{
 		sl::log_fatal("One or more requested validation layers do not exist.");
@@ -96,15 +178,20 @@ bool vulkan_initialize(const char* application_name)
 
 	// Vulkan Instance 
 	vk::ApplicationInfo app_info(
-		application_name,
+		config.application_name,
 		VK_MAKE_VERSION(0, 1, 0),
 		"Lipin Sock Engine",
 		VK_MAKE_VERSION(0, 1, 0),
 		VK_API_VERSION_1_3
 	);
 
-	// Instance Extensions
-	auto platform_extensions = platform_get_required_instance_extensions();
+	// Instance Extensions. Headless runs do not need any surface extensions.
+	std::vector<const char*> platform_extensions;
+
+	if (!is_headless)
+	{
+		platform_extensions = platform_get_required_instance_extensions();
+	}
 
 	// Instance validation layers.
 	auto enabled_validation_layers = validation_layers;
@@ -134,17 +221,25 @@ bool vulkan_initialize(const char* application_name)
 	}
 
 	// Create vulkan surface
-	auto _surface = vulkan_platform_create_vulkan_surface(instance);
-
-	if (!_surface)
+	if (!is_headless)
 	{
-		sl::log_fatal("Failed to create vulkan surface.");
-		return false;
+		auto _surface = vulkan_platform_create_vulkan_surface(instance);
+
+		if (!_surface)
+		{
+			sl::log_fatal("Failed to create vulkan surface.");
+			return false;
+		}
+
+		surface = *_surface;
 	}
 
-	surface = *_surface;
+	// Create the device. Headless devices never present, so they do not need the swapchain extension.
+	if (is_headless)
+	{
+		device_extensions.clear();
+	}
 
-	// Create the device
 	std::vector<std::string> device_extensions_str(device_extensions.size());
 	for (size_t i = 0; i < device_extensions.size(); i++)
 	{
@@ -171,7 +266,9 @@ bool vulkan_initialize(const char* application_name)
 	}
 
 	// Get swapchain info
-	SwapchainInfo swapchain_info = Swapchain::query_info(device, surface);
+	SwapchainInfo swapchain_info = is_headless ?
+		Swapchain::query_headless_info(device, vector2ui { config.width, config.height }) :
+		Swapchain::query_info(device, surface);
 
 	// Create the render passs
 	world_render_pass = RenderPass::create(
@@ -200,7 +297,7 @@ bool vulkan_initialize(const char* application_name)
 		0,
 		RenderPassClearFlagBits::NONE_FLAG,
 		true,
-		false
+		is_headless // Offscreen images are never presented, so keep them in the color attachment layout.
 	).release();
 	
 	if (!world_render_pass)
@@ -216,12 +313,14 @@ bool vulkan_initialize(const char* application_name)
 	}
 
 	// Create the swapchain
-	swapchain = Swapchain::create(
-		device,
-		ui_render_pass,
-		surface,
-		swapchain_info
-	).release();
+	if (is_headless)
+	{
+		swapchain = Swapchain::create_headless(device, ui_render_pass, swapchain_info).release();
+	}
+	else
+	{
+		swapchain = Swapchain::create(device, ui_render_pass, surface, swapchain_info).release();
+	}
 
 	if (!swapchain)
 	{
@@ -254,11 +353,19 @@ bool vulkan_initialize(const char* application_name)
 	// Create command buffers.
 	create_command_buffers();
 
+	if (!create_recording_jobs())
+	{
+		sl::log_fatal("Failed to create the render queue recording jobs.");
+		return false;
+	}
+
 	// Create sync objects
 	image_available_semaphores.resize(swapchain->max_frames_in_flight);
 
 	queue_complete_semaphores.resize(swapchain->max_frames_in_flight);
 
+	upload_complete_semaphores.resize(swapchain->max_frames_in_flight);
+
 	in_flight_fences.reserve(swapchain->max_frames_in_flight);
 
 	for (uint32_t i = 0; i < swapchain->max_frames_in_flight; i++)
@@ -281,6 +388,14 @@ bool vulkan_initialize(const char* application_name)
 			return false;
 		}
 
+		std::tie(r, upload_complete_semaphores[i]) = device->logical_device.createSemaphore(semaphore_ci);
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_error("Failed to create upload complete semaphore.");
+			return false;
+		}
+
 		auto fence = Fence::create(device, true);
 
 		if (!fence)
@@ -295,21 +410,90 @@ bool vulkan_initialize(const char* application_name)
 	// Preallocate the in flight images and set them to nullptr;
 	images_in_flight.resize(swapchain->images.size(), nullptr);
 
+	gpu_timer = GpuTimer::create(device, swapchain->max_frames_in_flight);
+
+	if (!gpu_timer)
+	{
+		sl::log_fatal("Failed to create the GPU timer.");
+		return false;
+	}
+
+	if (!upload_system_initialize(device))
+	{
+		sl::log_fatal("Failed to initialize the vulkan renderer upload subsystem.");
+		return false;
+	}
+
+	geometry_arena = GeometryArena::create(
+		device,
+		LGEOMETRY_ARENA_DEFAULT_VERTEX_CAPACITY,
+		LGEOMETRY_ARENA_DEFAULT_INDEX_CAPACITY
+	);
+
+	if (!geometry_arena)
+	{
+		sl::log_fatal("Failed to create the geometry arena.");
+		return false;
+	}
+
 	if (!texture_system_initialize(device))
 	{
 		sl::log_fatal("Failed to initialize the vulkan renderer texture subsystem.");
 		return false;
 	}
 
-	if (!shader_system_initialize(device, swapchain))
+	// One region per swapchain image, as the shaders index their uniform data by swapchain image count as well.
+	uniform_allocator = FrameUniformAllocator::create(
+		device,
+		LUNIFORM_ALLOCATOR_DEFAULT_REGION_SIZE + LUNIFORM_ALLOCATOR_DEFAULT_STATIC_SIZE,
+		swapchain->images.size(),
+		LUNIFORM_ALLOCATOR_DEFAULT_STATIC_SIZE
+	);
+
+	if (!uniform_allocator)
+	{
+		sl::log_fatal("Failed to create the uniform allocator.");
+		return false;
+	}
+
+	static_draw_cache = StaticDrawCache::create(device, swapchain->max_frames_in_flight);
+
+	if (!static_draw_cache)
+	{
+		sl::log_fatal("Failed to create the static draw cache.");
+		return false;
+	}
+
+	if (GpuCuller::is_supported(device))
+	{
+		gpu_culler = GpuCuller::create(device, uniform_allocator.get(), swapchain->max_frames_in_flight);
+
+		if (!gpu_culler)
+		{
+			sl::log_warn("Failed to create the GPU culler, culling on the CPU instead.");
+		}
+	}
+
+	if (!shader_system_initialize(device, swapchain, uniform_allocator.get()))
 	{
 		sl::log_fatal("Failed to initialize the vulkan renderer shader subsystem.");
 		return false;
 	}
 
-	// Load default shaders.
-	object_shader = shader_system_load("assets/shaders/builtin.object_shader.scfg", world_render_pass);
-	ui_shader = shader_system_load("assets/shaders/builtin.ui_shader.scfg", ui_render_pass);
+	// Load default shaders. Objects sample the bindless texture table if the device supports it.
+	const char* object_shader_path = texture_system_get_bindless_table() ?
+		"assets/shaders/builtin.object_shader_bindless.scfg" :
+		"assets/shaders/builtin.object_shader.scfg";
+
+	ShaderLoadRequest default_shaders[] = {
+		{ object_shader_path, world_render_pass },
+		{ "assets/shaders/builtin.ui_shader.scfg", ui_render_pass }
+	};
+
+	std::vector<Shader*> loaded_default_shaders = shader_system_load_batch(default_shaders);
+
+	object_shader = loaded_default_shaders[0];
+	ui_shader = loaded_default_shaders[1];
 
 	if (object_shader == nullptr)
 	{
@@ -361,19 +545,6 @@ bool vulkan_initialize(const char* application_name)
 
 	root_vp.propagate_notification_down(Node::NOTIFICATION_INIT, true);
 
-	// Car model.
-	std::optional<Obj> car_obj = Obj::load("assets/models/obj/car.obj");
-
-	if (!car_obj)
-	{
-		sl::log_fatal("Failed to load car obj file.");
-
-		return false;
-	}
-
-	car_model = Model::create(device, object_shader, *car_obj).release();
-	car_model->transform.set_position(0, 0, -10);
-
 	return true;
 }
 
@@ -381,20 +552,40 @@ void vulkan_shutdown()
 {
 	vk::Result r = device->logical_device.waitIdle();
 
-	delete car_model;
+	// Keep the compiled pipelines for the next run.
+	device->save_pipeline_cache();
+
+	pending_model_destructions.clear();
+	model_indices.clear();
+	models.clear();
 
 	shader_system_shutdown();
 
+	gpu_culler.reset();
+
+	static_draw_cache.reset();
+
+	uniform_allocator.reset();
+
 	texture_system_shutdown();
 
+	upload_system_shutdown();
+
+	geometry_arena.reset();
+
 	for (size_t i = 0; i < image_available_semaphores.size(); i++)
 	{
 		device->logical_device.destroy(image_available_semaphores[i]);
 		device->logical_device.destroy(queue_complete_semaphores[i]);
+		device->logical_device.destroy(upload_complete_semaphores[i]);
 	}
 
 	in_flight_fences.clear();
 
+	gpu_timer.reset();
+
+	destroy_recording_jobs();
+
 	graphics_command_buffers.clear();
 
 	for (size_t i = 0; i < world_framebuffers.size(); i++)
@@ -419,6 +610,8 @@ void vulkan_shutdown()
 
 bool vulkan_begin_frame(float delta_time)
 {
+	LPROFILE_FUNCTION();
+
 	if (swapchain->swapchain_out_of_date)
 	{
 		recreate_swapchain();
@@ -434,6 +627,26 @@ bool vulkan_begin_frame(float delta_time)
 		return false;
 	}
 
+	// Release the staging memory of finished uploads.
+	upload_system_update();
+
+	// The secondary command buffers of this frame are no longer in use either.
+	for (RecordingJob& job : recording_jobs[current_frame])
+	{
+		vk::Result r = device->logical_device.resetCommandPool(job.command_pool);
+
+		if (r != vk::Result::eSuccess)
+		{
+			sl::log_warn("Failed to reset a recording job command pool.");
+		}
+	}
+
+	// Destroy removed models that are no longer used by any frame in flight.
+	std::erase_if(pending_model_destructions, [](const PendingModelDestruction& pending)
+	{
+		return frame_number >= pending.frame_number + swapchain->max_frames_in_flight;
+	});
+
 	// Acquire next image in swapchain
 	auto next_image_index = swapchain->acquire_next_image_index(
 		UINT64_MAX, 
@@ -454,25 +667,27 @@ bool vulkan_begin_frame(float delta_time)
 	command_buffer->reset();
 	command_buffer->begin(false, false, false);
 
-	// Dynamic state
-	vk::Viewport viewport;
-	viewport.x = 0.0f;
-	viewport.y = (float) swapchain->swapchain_info.swapchain_extent.height;
-	viewport.width = (float) swapchain->swapchain_info.swapchain_extent.width;
-	viewport.height = -(float) swapchain->swapchain_info.swapchain_extent.height;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
+	set_dynamic_state(command_buffer);
 
-	// Scissor
-	vk::Rect2D scissor;
-	scissor.offset.x = scissor.offset.y = 0;
-	scissor.extent.width = swapchain->swapchain_info.swapchain_extent.width;
-	scissor.extent.height = swapchain->swapchain_info.swapchain_extent.height;
+	// Submit all pending uploads, and take ownership of the resources they wrote before anything uses them.
+	is_waiting_on_uploads = upload_system_acquire(command_buffer, upload_complete_semaphores[current_frame]);
 
-	command_buffer->handle.setViewport(0, 1, &viewport);
-	command_buffer->handle.setScissor(0, 1, &scissor);
+	// Compacting the geometry arena copies uploaded geometry, so it has to be acquired first. The recorded static draws
+	// point to the old locations.
+	if (geometry_arena->update(command_buffer, frame_number, swapchain->max_frames_in_flight))
+	{
+		static_draw_cache->invalidate();
+	}
+
+	// The fence of this frame has been waited on, so its uniform region can be reused.
+	uniform_allocator->begin_frame(current_frame);
+
+	// Swap in the streamed textures whose uploads have been acquired, record the uploads of newly decoded ones, and
+	// evict textures while over the budget.
+	texture_system_update(device, uniform_allocator->frame_number, swapchain->max_frames_in_flight);
 
-	world_render_pass->begin(command_buffer, world_framebuffers[current_image_index]);
+	// Read back the GPU timings of the previous use of this frame, now that its fence has been waited on.
+	gpu_timer->begin_frame(command_buffer, current_frame);
 
 	// -------- TEMP
 	vector2ui framebuffer_size = vulkan_get_framebuffer_size();
@@ -486,32 +701,116 @@ bool vulkan_begin_frame(float delta_time)
 	object_shader->set_global_ubo(&gubo);
 	object_shader->update_global_uniforms(current_frame);
 
-	//test_model.transform.rotation.y += LQUARTER_PI * delta_time;
-	//lise_transform_update(&test_model.transform);
-	car_model->transform.set_rotation(car_model->transform.get_rotation() + vector3f {0, LQUARTER_PI * delta_time});
-	
-	car_model->draw(command_buffer, current_frame);
+	// -------- ENDTEMP
 
-	//lise_model_draw(&test_model, vulkan_context.device.logical_device, command_buffer->handle, vulkan_context.current_image_index);
-	//
-	//lise_model_draw(&car_model, vulkan_context.device.logical_device, command_buffer->handle, vulkan_context.current_image_index);
+	frame_stats = {};
 
-	// -------- ENDTEMP
+	render_queue.set_camera(gubo.projection, gubo.view, 1000.0f);
+
+	bool is_static_out_of_date = static_draw_cache->is_out_of_date(current_frame);
+
+	for (auto& model : models)
+	{
+		if (!model->is_visible)
+		{
+			continue;
+		}
+
+		if (!model->is_static)
+		{
+			model->submit(render_queue);
+		}
+		else if (is_static_out_of_date)
+		{
+			model->submit(static_draw_cache->render_queue);
+		}
+
+		frame_stats.model_count++;
+	}
+
+	if (is_static_out_of_date)
+	{
+		static_draw_cache->record(
+			uniform_allocator.get(),
+			world_render_pass->handle,
+			get_viewport(),
+			get_scissor(),
+			current_frame
+		);
+	}
+
+	const StaticDrawCacheFrame& static_draws = static_draw_cache->frames[current_frame];
+
+	static_draw_cache->mark_drawn(current_frame, uniform_allocator->frame_number);
+
+	// Culling on the GPU records a dispatch, which has to happen before the render pass begins.
+	render_queue.prepare(command_buffer, uniform_allocator.get(), gpu_culler.get(), current_frame);
+
+	gpu_timer->begin_scope(command_buffer, "world_pass");
+
+	RenderQueueStats queue_stats;
+
+	// Preparing the dynamic queue can rewrite the descriptor sets of instances shared with static models, which
+	// invalidates the recorded draws. They are skipped for this frame and recorded again next time.
+	bool has_static_draws = static_draws.stats.draw_calls > 0 && !static_draw_cache->is_out_of_date(current_frame);
+
+	// Record large queues into secondary command buffers on the job system, small ones directly. Static draws are
+	// executed from a secondary command buffer, so the rest has to be recorded into secondary command buffers as well.
+	if (has_static_draws || render_queue.get_job_count(recording_jobs[current_frame].size()) > 1)
+	{
+		world_render_pass->begin(
+			command_buffer,
+			world_framebuffers[current_image_index],
+			vk::SubpassContents::eSecondaryCommandBuffers
+		);
+
+		if (has_static_draws)
+		{
+			command_buffer->handle.executeCommands(1, &static_draws.command_buffer->handle);
+		}
+
+		queue_stats = record_render_queue_jobs(command_buffer, current_frame);
+	}
+	else
+	{
+		world_render_pass->begin(command_buffer, world_framebuffers[current_image_index]);
+
+		queue_stats = render_queue.flush(command_buffer, current_frame);
+	}
+
+	if (has_static_draws)
+	{
+		queue_stats.add(static_draws.stats);
+	}
+
+	frame_stats.draw_calls = queue_stats.draw_calls;
+	frame_stats.static_draw_calls = static_draws.stats.draw_calls;
+	frame_stats.pipeline_binds = queue_stats.pipeline_binds;
+	frame_stats.descriptor_set_binds = queue_stats.descriptor_set_binds;
+	frame_stats.buffer_binds = queue_stats.buffer_binds;
+	frame_stats.culled_meshes = queue_stats.culled_items;
 
 	return true;
 }
 
 bool vulkan_end_frame(float delta_time)
 {
+	LPROFILE_FUNCTION();
+
 	uint8_t current_frame = swapchain->current_frame;
 	CommandBuffer* command_buffer = graphics_command_buffers[current_frame].get();
 
 	// End render pass.
 	world_render_pass->end(command_buffer);
+	gpu_timer->end_scope(command_buffer);
 
+	gpu_timer->begin_scope(command_buffer, "ui_pass");
 	ui_render_pass->begin(command_buffer, swapchain->framebuffers[current_image_index]);
 
 	ui_render_pass->end(command_buffer);
+	gpu_timer->end_scope(command_buffer);
+
+	gpu_timer->end_frame(command_buffer);
 
 	command_buffer->end();
 
@@ -528,17 +827,30 @@ bool vulkan_end_frame(float delta_time)
 	images_in_flight[current_frame]->reset();
 
 	// Submit queue
-	vk::PipelineStageFlags stage_flags[1] = {
-		vk::PipelineStageFlagBits::eColorAttachmentOutput
-	};
+	vk::Semaphore wait_semaphores[2];
+	vk::PipelineStageFlags stage_flags[2];
+	uint32_t wait_semaphore_count = 0;
+
+	// Nothing gets acquired or presented when headless, so there are no swapchain semaphores to wait on or signal.
+	if (!is_headless)
+	{
+		wait_semaphores[wait_semaphore_count] = image_available_semaphores[current_frame];
+		stage_flags[wait_semaphore_count++] = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+	}
+
+	if (is_waiting_on_uploads)
+	{
+		wait_semaphores[wait_semaphore_count] = upload_complete_semaphores[current_frame];
+		stage_flags[wait_semaphore_count++] = LUPLOAD_SYSTEM_WAIT_STAGES;
+	}
 
 	vk::SubmitInfo submit_info(
-		1,
-		&image_available_semaphores[current_frame],
+		wait_semaphore_count,
+		wait_semaphores,
 		stage_flags,
 		1,
 		&command_buffer->handle,
-		1,
+		is_headless ? 0 : 1,
 		&queue_complete_semaphores[current_frame]
 	);
 
@@ -552,6 +864,8 @@ bool vulkan_end_frame(float delta_time)
 
 	command_buffer->set_state(CommandBufferState::SUBMITTED);
 
+	frame_number++;
+
 	// Give images back to the swapchain
 	if (!swapchain->present(queue_complete_semaphores[swapchain->current_frame], current_image_index) &&
 		!swapchain->swapchain_out_of_date
@@ -573,6 +887,117 @@ vector2ui vulkan_get_framebuffer_size()
 	};
 }
 
+Model* vulkan_create_model(const Obj& obj)
+{
+	auto model = Model::create(device, geometry_arena.get(), object_shader, obj);
+
+	if (!model)
+	{
+		sl::log_error("Failed to create model.");
+		return nullptr;
+	}
+
+	model_indices[model.get()] = models.size();
+	models.push_back(std::move(model));
+
+	return models.back().get();
+}
+
+Model* vulkan_clone_model(const Model* model)
+{
+	auto clone = model->clone();
+
+	if (clone->is_static)
+	{
+		static_draw_cache->invalidate();
+	}
+
+	model_indices[clone.get()] = models.size();
+	models.push_back(std::move(clone));
+
+	return models.back().get();
+}
+
+void vulkan_destroy_model(Model* model)
+{
+	auto it = model_indices.find(model);
+
+	if (it == model_indices.end())
+	{
+		sl::log_warn("Attempting to destroy a model that is not owned by the renderer.");
+		return;
+	}
+
+	size_t index = it->second;
+	model_indices.erase(it);
+
+	if (model->is_static)
+	{
+		static_draw_cache->invalidate();
+	}
+
+	// Keep the model alive until the frames in flight are done with it.
+	pending_model_destructions.push_back({ std::move(models[index]), frame_number });
+
+	// Swap-remove the model from the scene.
+	if (index != models.size() - 1)
+	{
+		models[index] = std::move(models.back());
+		model_indices[models[index].get()] = index;
+	}
+
+	models.pop_back();
+}
+
+void vulkan_set_model_static(Model* model, bool is_static)
+{
+	if (model->is_static == is_static)
+	{
+		return;
+	}
+
+	model->is_static = is_static;
+
+	static_draw_cache->invalidate();
+}
+
+void vulkan_invalidate_static_models()
+{
+	static_draw_cache->invalidate();
+}
+
+FrameStats vulkan_get_frame_stats()
+{
+	FrameStats stats = frame_stats;
+
+	// GPU timings lag a few frames behind, so they are gathered from the most recent results.
+	stats.gpu_frame_ms = gpu_timer->get_frame_ms();
+	stats.gpu_world_pass_ms = gpu_timer->get_scope_ms("world_pass");
+	stats.gpu_ui_pass_ms = gpu_timer->get_scope_ms("ui_pass");
+
+	return stats;
+}
+
+const std::vector<GpuTimerScope>& vulkan_get_gpu_timings()
+{
+	return gpu_timer->results;
+}
+
+void vulkan_begin_gpu_scope(const char* name)
+{
+	gpu_timer->begin_scope(graphics_command_buffers[swapchain->current_frame].get(), name);
+}
+
+void vulkan_end_gpu_scope()
+{
+	gpu_timer->end_scope(graphics_command_buffers[swapchain->current_frame].get());
+}
+
+MemoryAllocatorStats vulkan_get_memory_stats()
+{
+	return device->allocator->get_stats();
+}
+
 // TODO: temp hack
 LAPI void vulkan_set_view_matrix_temp(const mat4x4& view)
 {
@@ -639,6 +1064,146 @@ bool create_command_buffers()
 	return true;
 }
 
+static bool create_recording_jobs()
+{
+	recording_jobs.resize(swapchain->max_frames_in_flight);
+
+	for (auto& frame_jobs : recording_jobs)
+	{
+		frame_jobs.resize(job_system_get_thread_count());
+
+		for (RecordingJob& job : frame_jobs)
+		{
+			// The pools are reset as a whole every frame.
+			vk::CommandPoolCreateInfo pool_ci(
+				vk::CommandPoolCreateFlagBits::eTransient,
+				device->queue_indices.graphics_queue_index
+			);
+
+			vk::Result r;
+
+			std::tie(r, job.command_pool) = device->logical_device.createCommandPool(pool_ci);
+
+			if (r != vk::Result::eSuccess)
+			{
+				sl::log_error("Failed to create a recording job command pool.");
+				return false;
+			}
+
+			job.command_buffer = CommandBuffer::create(device, job.command_pool, false);
+
+			if (!job.command_buffer)
+			{
+				sl::log_error("Failed to create a recording job command buffer.");
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void destroy_recording_jobs()
+{
+	for (auto& frame_jobs : recording_jobs)
+	{
+		for (RecordingJob& job : frame_jobs)
+		{
+			// The command buffer has to be freed before its pool is destroyed.
+			job.command_buffer.reset();
+
+			device->logical_device.destroy(job.command_pool);
+		}
+	}
+
+	recording_jobs.clear();
+}
+
+static vk::Viewport get_viewport()
+{
+	vk::Viewport viewport;
+	viewport.x = 0.0f;
+	viewport.y = (float) swapchain->swapchain_info.swapchain_extent.height;
+	viewport.width = (float) swapchain->swapchain_info.swapchain_extent.width;
+	viewport.height = -(float) swapchain->swapchain_info.swapchain_extent.height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	return viewport;
+}
+
+static vk::Rect2D get_scissor()
+{
+	vk::Rect2D scissor;
+	scissor.offset.x = scissor.offset.y = 0;
+	scissor.extent.width = swapchain->swapchain_info.swapchain_extent.width;
+	scissor.extent.height = swapchain->swapchain_info.swapchain_extent.height;
+
+	return scissor;
+}
+
+static void set_dynamic_state(CommandBuffer* command_buffer)
+{
+	vk::Viewport viewport = get_viewport();
+	vk::Rect2D scissor = get_scissor();
+
+	command_buffer->handle.setViewport(0, 1, &viewport);
+	command_buffer->handle.setScissor(0, 1, &scissor);
+}
+
+static RenderQueueStats record_render_queue_jobs(CommandBuffer* command_buffer, uint32_t current_frame)
+{
+	LPROFILE_FUNCTION();
+
+	std::vector<RecordingJob>& jobs = recording_jobs[current_frame];
+
+	uint32_t job_count = render_queue.get_job_count(jobs.size());
+	uint32_t batch_count = render_queue.batches.size();
+
+	vk::CommandBufferInheritanceInfo inheritance_info(
+		world_render_pass->handle,
+		0,
+		world_framebuffers[current_image_index]
+	);
+
+	RenderQueueStats job_stats[LJOB_SYSTEM_MAX_THREADS] = {};
+
+	// Every job records a contiguous range of the sorted batches, so executing the jobs in order keeps the draw order.
+	job_system_run(job_count, [&](uint32_t job_index)
+	{
+		CommandBuffer* secondary = jobs[job_index].command_buffer.get();
+
+		secondary->begin(true, true, false, &inheritance_info);
+
+		// Secondary command buffers do not inherit the dynamic state of the primary command buffer.
+		set_dynamic_state(secondary);
+
+		uint32_t first_batch = batch_count * job_index / job_count;
+		uint32_t end_batch = batch_count * (job_index + 1) / job_count;
+
+		job_stats[job_index] = render_queue.record(secondary, first_batch, end_batch - first_batch, current_frame);
+
+		secondary->end();
+	});
+
+	vk::CommandBuffer secondary_handles[LJOB_SYSTEM_MAX_THREADS];
+
+	RenderQueueStats stats = render_queue.stats;
+
+	for (uint32_t i = 0; i < job_count; i++)
+	{
+		secondary_handles[i] = jobs[i].command_buffer->handle;
+
+		stats.add(job_stats[i]);
+	}
+
+	command_buffer->handle.executeCommands(job_count, secondary_handles);
+
+	render_queue.clear();
+
+	return stats;
+}
+
 static bool recreate_swapchain()
 {
 	sl::log_debug("Recreating swapchain.");
@@ -724,6 +1289,18 @@ static bool recreate_swapchain()
 		return false;
 	}
 
+	// The recorded static draws use the old render pass and extent.
+	static_draw_cache->invalidate();
+
+	// The amount of frames in flight might have changed.
+	gpu_timer = GpuTimer::create(device, swapchain->max_frames_in_flight);
+
+	if (!gpu_timer)
+	{
+		sl::log_fatal("Failed to recreate the GPU timer.");
+		return false;
+	}
+
 	// World framebuffers.
 	size_t swapchain_image_count = swapchain->images.size();
 
@@ -14,16 +14,19 @@ std::unique_ptr<VulkanBuffer> VulkanBuffer::create(
 	uint64_t size,
 	vk::BufferUsageFlags usage,
 	vk::MemoryPropertyFlags memory_property_flags,
-	bool bind_on_create
+	bool bind_on_create,
+	bool persistently_mapped
 )
 {
 	auto out = std::make_unique<VulkanBuffer>();
-	
+
 	// Copy trivial data.
 	out->size = size;
 	out->usage = usage;
 	out->device = device;
-	
+	out->is_locked = false;
+	out->mapped_data = nullptr;
+
 	vk::BufferCreateInfo buffer_ci(
 		{},
 		size,
@@ -43,48 +46,37 @@ std::unique_ptr<VulkanBuffer> VulkanBuffer::create(
 	}
 
 	// Gather memory requirements
-	auto memory_properties = out->device->physical_device_memory_properties;
 	auto mem_reqs = out->device->logical_device.getBufferMemoryRequirements(out->handle);
 
-	int32_t memory_type = -1;
-	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
-	{
-		if (mem_reqs.memoryTypeBits & (1 << i) &&
-			(memory_properties.memoryTypes[i].propertyFlags & memory_property_flags) == memory_property_flags &&
-			(static_cast<uint32_t>(
-				memory_properties.memoryTypes[i].propertyFlags &
-				vk::MemoryPropertyFlagBits::eDeviceCoherentAMD
-			) == 0))
-		{
-			memory_type = i;
-		}
-	}
+	// Allocate memory
+	auto allocation = device->allocator->allocate(mem_reqs, memory_property_flags, true);
 
-	if (memory_type == -1)
+	if (!allocation)
 	{
-		sl::log_error("Required memory type was not found.");
+		sl::log_error("Failed to allocate memory for buffer");
+
+		device->logical_device.destroyBuffer(out->handle);
+		out->handle = nullptr;
 		return nullptr;
 	}
 
-	out->memory_index = memory_type;
-
-	// Allocate memory
-	vk::MemoryAllocateInfo allocate_info(
-		mem_reqs.size,
-		memory_type
-	);
+	out->allocation = *allocation;
+	out->memory_property_flags = allocation->property_flags;
 
-	std::tie(r, out->memory) = out->device->logical_device.allocateMemory(allocate_info);
-
-	if (r != vk::Result::eSuccess)
+	if (bind_on_create || persistently_mapped)
 	{
-		sl::log_error("Failed to allocate memory for buffer");
-		return nullptr;
+		out->bind(0);
 	}
 
-	if (bind_on_create)
+	if (persistently_mapped)
 	{
-		out->bind(0);
+		if (!out->allocation.mapped_data)
+		{
+			sl::log_error("Persistently mapped buffers require host visible memory.");
+			return nullptr;
+		}
+
+		out->mapped_data = out->allocation.mapped_data;
 	}
 
 	return out;
@@ -92,9 +84,12 @@ std::unique_ptr<VulkanBuffer> VulkanBuffer::create(
 
 VulkanBuffer::~VulkanBuffer()
 {
-	device->logical_device.freeMemory(memory);
+	if (handle)
+	{
+		device->logical_device.destroyBuffer(handle);
 
-	device->logical_device.destroyBuffer(handle);
+		device->allocator->free(allocation);
+	}
 }
 
 bool VulkanBuffer::resize(uint64_t new_size, vk::Queue& queue, vk::CommandPool& pool)
@@ -119,25 +114,26 @@ bool VulkanBuffer::resize(uint64_t new_size, vk::Queue& queue, vk::CommandPool&
 	// Gather memory requirements
 	auto mem_reqs = device->logical_device.getBufferMemoryRequirements(new_buffer);
 
-	// Allocate memory
-	vk::MemoryAllocateInfo allocate_info(
-		mem_reqs.size,
-		memory_index
-	);
-
-	vk::DeviceMemory new_memory;
-	std::tie(r, new_memory) = device->logical_device.allocateMemory(allocate_info);
+	// Allocate memory of the same type.
+	auto new_allocation = device->allocator->allocate(mem_reqs, memory_property_flags, true);
 
-	if (r != vk::Result::eSuccess)
+	if (!new_allocation)
 	{
 		sl::log_error("Failed to allocate memory for buffer.");
+
+		device->logical_device.destroyBuffer(new_buffer);
 		return false;
 	}
 
 	// Bind new memory
-	if (device->logical_device.bindBufferMemory(new_buffer, new_memory, 0) != vk::Result::eSuccess)
+	r = device->logical_device.bindBufferMemory(new_buffer, new_allocation->memory, new_allocation->offset);
+
+	if (r != vk::Result::eSuccess)
 	{
 		sl::log_error("Failed to bind memory to buffer.");
+
+		device->logical_device.destroyBuffer(new_buffer);
+		device->allocator->free(*new_allocation);
 		return false;
 	}
 
@@ -148,27 +144,29 @@ bool VulkanBuffer::resize(uint64_t new_size, vk::Queue& queue, vk::CommandPool&
 	r = device->logical_device.waitIdle();
 
 	// Destroy old buffer and memory
-	if (memory)
-	{
-		device->logical_device.freeMemory(memory);
-	}
-
 	if (handle)
 	{
 		device->logical_device.destroyBuffer(handle);
+
+		device->allocator->free(allocation);
 	}
 
 	// Set new data
 	handle = new_buffer;
-	memory = new_memory;
+	allocation = *new_allocation;
 	size = new_size;
 
+	if (mapped_data)
+	{
+		mapped_data = allocation.mapped_data;
+	}
+
 	return true;
 }
 
 bool VulkanBuffer::bind(uint64_t offset)
 {
-	if (device->logical_device.bindBufferMemory(handle, memory, offset) != vk::Result::eSuccess)
+	if (device->logical_device.bindBufferMemory(handle, allocation.memory, allocation.offset + offset) != vk::Result::eSuccess)
 	{
 		sl::log_error("Failed to bind buffer memory.");
 		return false;
@@ -179,31 +177,84 @@ bool VulkanBuffer::bind(uint64_t offset)
 
 void* VulkanBuffer::lock_memory(uint64_t offset, uint64_t size, vk::MemoryMapFlags flags)
 {
-	auto [r, v] = device->logical_device.mapMemory(memory, offset, size, flags);
-	
-	if (r != vk::Result::eSuccess)
+	if (!allocation.mapped_data)
 	{
-		sl::log_error("Failed to map memory.");
+		sl::log_error("Attempting to lock the memory of a buffer that is not host visible.");
 		return nullptr;
 	}
 
-	return v;
+	// Make sure device writes are visible before handing out the pointer.
+	invalidate(offset, size);
+
+	is_locked = true;
+	locked_offset = offset;
+	locked_size = size;
+
+	return static_cast<uint8_t*>(allocation.mapped_data) + offset;
 }
 
 void VulkanBuffer::unlock_memory()
 {
-	device->logical_device.unmapMemory(memory);
+	if (!is_locked)
+	{
+		return;
+	}
+
+	flush(locked_offset, locked_size);
+
+	is_locked = false;
 }
 
 void VulkanBuffer::load_data(uint64_t offset, uint64_t size, vk::MemoryMapFlags flags, const void* data)
 {
 	void* buffer_data = lock_memory(offset, size, flags);
 
+	if (!buffer_data)
+	{
+		return;
+	}
+
 	memcpy(buffer_data, data, size);
 
 	unlock_memory();
 }
 
+bool VulkanBuffer::flush(uint64_t offset, uint64_t size)
+{
+	if (is_host_coherent())
+	{
+		return true;
+	}
+
+	vk::MappedMemoryRange range = get_aligned_range(offset, size);
+
+	if (device->logical_device.flushMappedMemoryRanges(1, &range) != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to flush mapped memory.");
+		return false;
+	}
+
+	return true;
+}
+
+bool VulkanBuffer::invalidate(uint64_t offset, uint64_t size)
+{
+	if (is_host_coherent())
+	{
+		return true;
+	}
+
+	vk::MappedMemoryRange range = get_aligned_range(offset, size);
+
+	if (device->logical_device.invalidateMappedMemoryRanges(1, &range) != vk::Result::eSuccess)
+	{
+		sl::log_error("Failed to invalidate mapped memory.");
+		return false;
+	}
+
+	return true;
+}
+
 void VulkanBuffer::copy_to(
 	vk::CommandPool pool,
 	vk::Fence fence,
@@ -214,13 +265,6 @@ void VulkanBuffer::copy_to(
 	uint64_t size
 )
 {
-	vk::Result r = queue.waitIdle();
-
-	if (r != vk::Result::eSuccess)
-	{
-		sl::log_warn("Failed to wait on queue during buffer copy.");
-	}
-
 	// Create one time use command buffer
 	auto cb = CommandBuffer::create(device, pool, true);
 
@@ -237,4 +281,29 @@ void VulkanBuffer::copy_to(
 	cb->end_and_submit_single_use(queue);
 }
 
+bool VulkanBuffer::is_host_coherent() const
+{
+	return static_cast<bool>(memory_property_flags & vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+vk::MappedMemoryRange VulkanBuffer::get_aligned_range(uint64_t offset, uint64_t size) const
+{
+	uint64_t atom_size = device->physical_device_properties.limits.nonCoherentAtomSize;
+
+	// Ranges are relative to the start of the device memory, which the buffer shares with other resources.
+	uint64_t memory_offset = allocation.offset + offset;
+	uint64_t memory_end = size == VK_WHOLE_SIZE ? allocation.offset + allocation.size : memory_offset + size;
+
+	uint64_t begin = memory_offset / atom_size * atom_size;
+	uint64_t end = (memory_end + atom_size - 1) / atom_size * atom_size;
+
+	// The end of the device memory does not have to be a multiple of the atom size.
+	if (end >= allocation.memory_size)
+	{
+		return vk::MappedMemoryRange(allocation.memory, begin, VK_WHOLE_SIZE);
+	}
+
+	return vk::MappedMemoryRange(allocation.memory, begin, end - begin);
+}
+
 }
@@ -1,9 +1,13 @@
 #include "renderer/vulkan_image.hpp"
 
 #include <stdexcept>
+#include <vector>
 
 #include <simple-logger.hpp>
 
+#include "renderer/mip_chain.hpp"
+#include "renderer/texture_format.hpp"
+
 namespace lise
 {
 
@@ -16,7 +20,8 @@ std::unique_ptr<Image> Image::create(
 	vk::ImageUsageFlags use_flags,
 	vk::MemoryPropertyFlags memory_flags,
 	bool create_view,
-	vk::ImageAspectFlags view_aspect_flags
+	vk::ImageAspectFlags view_aspect_flags,
+	uint32_t mip_levels
 )
 {
 	auto out = std::make_unique<Image>();
@@ -25,13 +30,14 @@ std::unique_ptr<Image> Image::create(
 	out->device = device;
 	out->size = size;
 	out->image_format = image_format;
+	out->mip_levels = mip_levels;
 
 	vk::ImageCreateInfo image_create_info(
 		{},
 		image_type,
 		image_format,
 		{ size.w, size.h, 1 },
-		4,
+		mip_levels,
 		1,
 		vk::SampleCountFlagBits::e1,
 		image_tiling,
@@ -55,44 +61,25 @@ std::unique_ptr<Image> Image::create(
 	// Query memory requirements
 	vk::MemoryRequirements memory_reqs = device->logical_device.getImageMemoryRequirements(out->handle);
 
-	// Get memory type index
-	vk::PhysicalDeviceMemoryProperties memory_properties = device->physical_device_memory_properties;
-
-	int32_t memory_type = -1;
-	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
-	{
-		if (memory_reqs.memoryTypeBits & (1 << i) &&
-			(memory_properties.memoryTypes[i].propertyFlags & memory_flags) == memory_flags &&
-			static_cast<uint32_t>(
-				memory_properties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eDeviceCoherentAMD
-			) == 0
-		)
-		{
-			memory_type = i;
-		}
-	}
-
-	if (memory_type == -1)
-	{
-		sl::log_error("Required memory type was not found.");
-		return nullptr;
-	}
-
 	// Allocate memory
-	vk::MemoryAllocateInfo memory_allocate_info(
-		memory_reqs.size,
-		memory_type
+	auto allocation = device->allocator->allocate(
+		memory_reqs,
+		memory_flags,
+		image_tiling == vk::ImageTiling::eLinear
 	);
 
-	std::tie(r, out->memory) = device->logical_device.allocateMemory(memory_allocate_info);
-
-	if (r != vk::Result::eSuccess)
+	if (!allocation)
 	{
 		sl::log_error("Failed to allocate memory for image.");
+
+		device->logical_device.destroy(out->handle);
+		out->handle = nullptr;
 		return nullptr;
 	}
 
-	r = device->logical_device.bindImageMemory(out->handle, out->memory, 0);
+	out->allocation = *allocation;
+
+	r = device->logical_device.bindImageMemory(out->handle, out->allocation.memory, out->allocation.offset);
 
 	// Bind memory
 	if (r != vk::Result::eSuccess)
@@ -113,7 +100,7 @@ std::unique_ptr<Image> Image::create(
 			vk::ImageSubresourceRange(
 				view_aspect_flags,
 				0,
-				1,
+				mip_levels,
 				0,
 				1
 			)
@@ -138,14 +125,11 @@ Image::~Image()
 		device->logical_device.destroy(image_view);
 	}
 
-	if (memory)
-	{
-		device->logical_device.freeMemory(memory);
-	}
-
 	if (handle)
 	{
 		device->logical_device.destroy(handle);
+
+		device->allocator->free(allocation);
 	}
 }
 
@@ -162,7 +146,7 @@ bool Image::transition_layout(const CommandBuffer* cb, vk::ImageLayout old_layou
 		vk::ImageSubresourceRange(
 			vk::ImageAspectFlagBits::eColor,
 			0,
-			1,
+			mip_levels,
 			0,
 			1
 		)
@@ -208,21 +192,35 @@ bool Image::transition_layout(const CommandBuffer* cb, vk::ImageLayout old_layou
 	return true;
 }
 
-void Image::copy_from_buffer(const CommandBuffer* cb, vk::Buffer buffer)
+void Image::copy_from_buffer(const CommandBuffer* cb, vk::Buffer buffer, uint64_t buffer_offset)
 {
-	vk::BufferImageCopy buff_copy(
-		0, 0, 0,
-		vk::ImageSubresourceLayers(
-			vk::ImageAspectFlagBits::eColor,
-			0,
-			0,
-			1
-		),
-		{},
-		{ size.w, size.h, 1 }
-	);
+	std::vector<vk::BufferImageCopy> buff_copies(mip_levels);
 
-	cb->handle.copyBufferToImage(buffer, handle, vk::ImageLayout::eTransferDstOptimal, 1, &buff_copy);
+	for (uint32_t level = 0; level < mip_levels; level++)
+	{
+		vector2ui level_size = mip_chain_get_level_size(size, level);
+
+		buff_copies[level] = vk::BufferImageCopy(
+			buffer_offset, 0, 0,
+			vk::ImageSubresourceLayers(
+				vk::ImageAspectFlagBits::eColor,
+				level,
+				0,
+				1
+			),
+			{},
+			{ level_size.w, level_size.h, 1 }
+		);
+
+		buffer_offset += get_level_byte_size(level);
+	}
+
+	cb->handle.copyBufferToImage(buffer, handle, vk::ImageLayout::eTransferDstOptimal, buff_copies);
+}
+
+uint64_t Image::get_level_byte_size(uint32_t level) const
+{
+	return texture_format_get_byte_size(image_format, mip_chain_get_level_size(size, level));
 }
 
 }
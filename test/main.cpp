@@ -14,6 +14,8 @@ static lise::vector3f cam_pos;
 static lise::vector3f cam_rot;
 static bool view_is_dirty = false;
 
+static lise::Model* car_model;
+
 void on_event(uint16_t event_code, lise::event_context ctx)
 {
 	switch (event_code)
@@ -80,6 +82,25 @@ bool game_initialize()
 	view = view.inversed();
 
 	lise::vulkan_set_view_matrix_temp(view);
+
+	// Car model.
+	std::optional<lise::Obj> car_obj = lise::Obj::load("assets/models/obj/car.obj");
+
+	if (!car_obj)
+	{
+		sl::log_fatal("Failed to load car obj file.");
+		return false;
+	}
+
+	car_model = lise::vulkan_create_model(*car_obj);
+
+	if (!car_model)
+	{
+		sl::log_fatal("Failed to create the car model.");
+		return false;
+	}
+
+	car_model->transform.set_position(0, 0, -10);
 	
     return true;
 }
@@ -166,6 +187,10 @@ bool game_update(float delta_time)
 
 bool game_render(float delta_time) 
 {
+	car_model->transform.set_rotation(
+		car_model->transform.get_rotation() + lise::vector3f { 0, LQUARTER_PI * delta_time }
+	);
+
     return true;
 }
 